@@ -41,6 +41,8 @@ extern CAN_HandleTypeDef hcan;
 void MX_CAN_Init(void);
 
 /* USER CODE BEGIN Prototypes */
+void CAN_Receive_IRQHandler(CAN_HandleTypeDef *hcan, uint32_t fifo);
+void CAN_Transmit_IRQHandler(CAN_HandleTypeDef *hcan);
 
 /* USER CODE END Prototypes */
 
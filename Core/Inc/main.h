@@ -70,6 +70,9 @@ void Error_Handler(void);
 #define button_up_Pin GPIO_PIN_15
 #define button_up_GPIO_Port GPIOC
 #define button_up_EXTI_IRQn EXTI15_10_IRQn
+#define INT_Pin GPIO_PIN_1
+#define INT_GPIO_Port GPIOA
+#define INT_EXTI_IRQn EXTI1_IRQn
 #define CS_Pin GPIO_PIN_4
 #define CS_GPIO_Port GPIOA
 #define RESET_Pin GPIO_PIN_0
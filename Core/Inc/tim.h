@@ -34,6 +34,8 @@ extern "C" {
 
 extern TIM_HandleTypeDef htim1;
 
+extern TIM_HandleTypeDef htim2;
+
 extern TIM_HandleTypeDef htim3;
 
 /* USER CODE BEGIN Private defines */
@@ -41,11 +43,13 @@ extern TIM_HandleTypeDef htim3;
 /* USER CODE END Private defines */
 
 void MX_TIM1_Init(void);
+void MX_TIM2_Init(void);
 void MX_TIM3_Init(void);
 
 void HAL_TIM_MspPostInit(TIM_HandleTypeDef *htim);
 
 /* USER CODE BEGIN Prototypes */
+void TIM_Scheduler_IRQHandler(TIM_HandleTypeDef *htim);
 
 /* USER CODE END Prototypes */
 
@@ -44,6 +44,7 @@ void MX_USART1_UART_Init(void);
 void MX_USART2_UART_Init(void);
 
 /* USER CODE BEGIN Prototypes */
+void UART_Stream_IRQHandler(UART_HandleTypeDef *huart);
 
 /* USER CODE END Prototypes */
 
@@ -46,7 +46,7 @@ void MX_CAN_Init(void)
   hcan.Init.TimeTriggeredMode = DISABLE;
   hcan.Init.AutoBusOff = DISABLE;
   hcan.Init.AutoWakeUp = DISABLE;
-  hcan.Init.AutoRetransmission = DISABLE;
+  hcan.Init.AutoRetransmission = ENABLE;
   hcan.Init.ReceiveFifoLocked = DISABLE;
   hcan.Init.TransmitFifoPriority = DISABLE;
   if (HAL_CAN_Init(&hcan) != HAL_OK)
@@ -89,6 +89,8 @@ void HAL_CAN_MspInit(CAN_HandleTypeDef* canHandle)
     __HAL_AFIO_REMAP_CAN1_2();
 
     /* CAN1 interrupt Init */
+    HAL_NVIC_SetPriority(USB_HP_CAN1_TX_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(USB_HP_CAN1_TX_IRQn);
     HAL_NVIC_SetPriority(USB_LP_CAN1_RX0_IRQn, 5, 0);
     HAL_NVIC_EnableIRQ(USB_LP_CAN1_RX0_IRQn);
     HAL_NVIC_SetPriority(CAN1_RX1_IRQn, 5, 0);
@@ -124,6 +126,13 @@ void HAL_CAN_MspDeInit(CAN_HandleTypeDef* canHandle)
     */
     /* HAL_NVIC_DisableIRQ(USB_LP_CAN1_RX0_IRQn); */
   /* USER CODE END CAN1:USB_LP_CAN1_RX0_IRQn disable */
+  /* USER CODE BEGIN CAN1:USB_HP_CAN1_TX_IRQn disable */
+    /**
+    * Uncomment the line below to disable the "USB_HP_CAN1_TX_IRQn" interrupt
+    * Be aware, disabling shared interrupt may affect other IPs
+    */
+    /* HAL_NVIC_DisableIRQ(USB_HP_CAN1_TX_IRQn); */
+  /* USER CODE END CAN1:USB_HP_CAN1_TX_IRQn disable */
 
     HAL_NVIC_DisableIRQ(CAN1_RX1_IRQn);
   /* USER CODE BEGIN CAN1_MspDeInit 1 */
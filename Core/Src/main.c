@@ -108,6 +108,7 @@ int main(void)
   MX_TIM3_Init();
   MX_SPI1_Init();
   MX_IWDG_Init();
+  MX_TIM2_Init();
   /* USER CODE BEGIN 2 */
   project_init();
   /* USER CODE END 2 */
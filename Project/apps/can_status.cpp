@@ -0,0 +1,50 @@
+#include "main.hpp"
+#include "etl/heap.h"
+
+using namespace Project;
+using Bus = drivers::PeriodicScheduler::Bus;
+
+// status frames of the board on CAN, all sent by the periodic scheduler task:
+//   0x101 every 10 ms    uptime in ms (u32), queued CAN frames (u8)
+//   0x102 every 100 ms   free heap, total heap, minimum ever free heap (u16 each)
+//   0x103 every 1000 ms  release jitter of 0x101, max and average in us (u16 each),
+//                        CAN frames dropped and failed (u16 each)
+// multi-byte values are little endian
+
+#ifdef F103_USE_CAN
+static int heartbeat_index = -1;
+
+static size_t put(uint8_t* buf, size_t at, uint32_t value, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        buf[at + i] = uint8_t(value >> (8 * i));
+    }
+    return at + n;
+}
+
+static size_t heartbeat(uint8_t* buf, size_t, void*) {
+    size_t len = put(buf, 0, xTaskGetTickCount() * portTICK_PERIOD_MS, 4);
+    return put(buf, len, drivers::can_tx.pending(), 1);
+}
+
+static size_t heap(uint8_t* buf, size_t, void*) {
+    size_t len = put(buf, 0, etl::heap::freeSize.get(), 2);
+    len = put(buf, len, etl::heap::totalSize.get(), 2);
+    return put(buf, len, etl::heap::minimumEverFreeSize.get(), 2);
+}
+
+static size_t diagnostics(uint8_t* buf, size_t, void*) {
+    auto stats = drivers::periodic.stats(heartbeat_index);
+    size_t len = put(buf, 0, stats.jitter_max, 2);
+    len = put(buf, len, stats.jitter_avg, 2);
+    len = put(buf, len, drivers::can_tx.dropped(), 2);
+    return put(buf, len, drivers::can_tx.errors(), 2);
+}
+
+APP(can_status) {
+    heartbeat_index = drivers::periodic.add({.bus=Bus::CAN, .id=0x101, .period=10, .producer=heartbeat});
+    drivers::periodic.add({.bus=Bus::CAN, .id=0x102, .period=100, .producer=heap});
+    if (heartbeat_index >= 0) {
+        drivers::periodic.add({.bus=Bus::CAN, .id=0x103, .period=1000, .producer=diagnostics});
+    }
+}
+#endif
@@ -0,0 +1,102 @@
+#include "main.hpp"
+#include "utils/json.hpp"
+#include "utils/cbor.hpp"
+#include "timers.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace Project;
+
+// cycles to encode and decode the same struct as json and as cbor, counted by the DWT cycle
+// counter and printed on the USB CDC port once a second as the average of a batch:
+//   json enc <cycles> dec <cycles> len <bytes> | cbor enc <cycles> dec <cycles> len <bytes>
+// only built with F103_BENCH
+
+#if defined(F103_BENCH) and defined(F103_USE_USB)
+namespace {
+    struct Telemetry {
+        std::string_view device;
+        uint32_t uptime;
+        float temperature;
+        int channels[4];
+        bool valid;
+    };
+
+    // fixed buffer sink, the size of a UART frame
+    struct Buffer {
+        char data[160];
+        size_t len = 0;
+
+        void write(std::string_view str) {
+            size_t n = str.size() < sizeof(data) - len ? str.size() : sizeof(data) - len;
+            ::memcpy(data + len, str.data(), n);
+            len += n;
+        }
+    };
+}
+
+JSON_SCHEMA(Telemetry,
+    JSON_MEMBER("device", device),
+    JSON_MEMBER("uptime", uptime),
+    JSON_MEMBER("temperature", temperature),
+    JSON_MEMBER("channels", channels),
+    JSON_MEMBER("valid", valid)
+);
+
+static constexpr int rounds = 64;
+
+static void cycle_counter_init() {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+// the buffers are static, the timer task stack is small
+static Buffer json_out;
+static Buffer cbor_out;
+static char json_in[sizeof(Buffer::data)];
+
+// runs in the timer service task, a batch holds up the other timers for its few milliseconds
+static void codec_bench(TimerHandle_t) {
+    static Telemetry telemetry = {"bluepill-01", 0, 23.5f, {1200, -35, 0, 65535}, true};
+    telemetry.uptime = xTaskGetTickCount();
+
+    uint32_t json_enc = 0, json_dec = 0, cbor_enc = 0, cbor_dec = 0;
+    bool ok = true;
+    for (int i = 0; i < rounds; ++i) {
+        uint32_t start = DWT->CYCCNT;
+        json_out.len = 0;
+        utils::json::Writer(json_out).value(telemetry);
+        json_enc += DWT->CYCCNT - start;
+
+        start = DWT->CYCCNT;
+        cbor_out.len = 0;
+        utils::cbor::Writer(cbor_out).value(telemetry);
+        cbor_enc += DWT->CYCCNT - start;
+
+        // the json parser unescapes in place, it gets a fresh copy outside the measurement
+        ::memcpy(json_in, json_out.data, json_out.len);
+        Telemetry res = {};
+        start = DWT->CYCCNT;
+        utils::json::Parser parser(res);
+        ok = ok and parser.feed(json_in, json_out.len, true) == utils::json::Parser::Status::Complete;
+        json_dec += DWT->CYCCNT - start;
+
+        res = {};
+        start = DWT->CYCCNT;
+        ok = ok and utils::cbor::Reader(cbor_out.data, cbor_out.len).read(res);
+        cbor_dec += DWT->CYCCNT - start;
+    }
+
+    char line[96];
+    int len = ::snprintf(line, sizeof(line), "json enc %lu dec %lu len %u | cbor enc %lu dec %lu len %u%s\r\n",
+        json_enc / rounds, json_dec / rounds, json_out.len, cbor_enc / rounds, cbor_dec / rounds, cbor_out.len, ok ? "" : " FAILED");
+    drivers::cdc.write(line, len < int(sizeof(line)) ? len : sizeof(line) - 1);
+}
+
+APP(codec_bench) {
+    static StaticTimer_t timer;
+    cycle_counter_init();
+    xTimerStart(xTimerCreateStatic("codec_bench", pdMS_TO_TICKS(1000), pdTRUE, nullptr, codec_bench, &timer), 0);
+}
+#endif
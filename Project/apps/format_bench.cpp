@@ -0,0 +1,73 @@
+#include "main.hpp"
+#include "utils/format.hpp"
+#include "etl/heap.h"
+#include "timers.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace Project;
+
+// cycles to format the same lines with snprintf and with fmt::format, counted by the DWT
+// cycle counter and printed on the USB CDC port once a second as the average of a batch:
+//   heap printf <cycles> fmt <cycles> | hex printf <cycles> fmt <cycles> | fixed fmt <cycles>
+// the fixed point line has no printf counterpart, the nano libc printf has no floats;
+// only built with F103_BENCH
+//
+// code size at -Os of a 32-bit x86 build; Thumb-2 differs in the bytes, not in what is paid
+// once and what per line:
+//   snprintf   49 and 46 bytes for the heap and hex lines, plus the nano libc printf
+//   fmt        186 and 148 bytes for the lines and 42 and 34 of parsed format in flash,
+//              once: 307 for put<unsigned long> and pad, 66 for its tables, 457 for to_chars and
+//              Buffer::write, 437 for to_chars_fixed if a %f is used
+// fmt pays for itself only once the libc printf drops out of the link, see the map file:
+//   grep -E "_svfprintf_r|_printf_i|_vfiprintf_r" build/bluepill.map
+
+#if defined(F103_BENCH) and defined(F103_USE_USB)
+static constexpr int rounds = 64;
+
+// runs in the timer service task, a batch holds up the other timers for its few milliseconds
+static void format_bench(TimerHandle_t) {
+    char a[48], b[48];
+    unsigned long free = etl::heap::freeSize.get(), total = etl::heap::totalSize.get(), ticks = xTaskGetTickCount();
+    float temperature = 23.5f + float(ticks % 100) / 100;
+
+    uint32_t heap_printf = 0, heap_fmt = 0, hex_printf = 0, hex_fmt = 0, fixed_fmt = 0;
+    bool same = true;
+    for (int i = 0; i < rounds; ++i) {
+        uint32_t start = DWT->CYCCNT;
+        ::snprintf(a, sizeof(a), "h: %lu/%lu t: %lu\n", free, total, ticks);
+        heap_printf += DWT->CYCCNT - start;
+
+        start = DWT->CYCCNT;
+        utils::fmt::format(b, FMT("h: %lu/%lu t: %lu\n"), free, total, ticks);
+        heap_fmt += DWT->CYCCNT - start;
+        same = same and ::strcmp(a, b) == 0;
+
+        start = DWT->CYCCNT;
+        ::snprintf(a, sizeof(a), "id %08lx len %-5lu|", ticks, free);
+        hex_printf += DWT->CYCCNT - start;
+
+        start = DWT->CYCCNT;
+        utils::fmt::format(b, FMT("id %08lx len %-5lu|"), ticks, free);
+        hex_fmt += DWT->CYCCNT - start;
+        same = same and ::strcmp(a, b) == 0;
+
+        start = DWT->CYCCNT;
+        utils::fmt::format(b, FMT("t: %6.2f C"), temperature);
+        fixed_fmt += DWT->CYCCNT - start;
+    }
+
+    char line[112];
+    size_t len = utils::fmt::format(line, FMT("heap printf %lu fmt %lu | hex printf %lu fmt %lu | fixed fmt %lu%s\r\n"),
+        heap_printf / rounds, heap_fmt / rounds, hex_printf / rounds, hex_fmt / rounds, fixed_fmt / rounds,
+        same ? "" : " MISMATCH");
+    drivers::cdc.write(line, len);
+}
+
+APP(format_bench) {
+    static StaticTimer_t timer;
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    xTimerStart(xTimerCreateStatic("format_bench", pdMS_TO_TICKS(1000), pdTRUE, nullptr, format_bench, &timer), 0);
+}
+#endif
@@ -1,19 +1,21 @@
 #include "main.hpp"
+#include "utils/format.hpp"
 #include "etl/heap.h"
-#include "etl/keywords.h"
+#include "timers.h"
 
-[[async]]
-static void heap_info() {
-    for (;;) {
-        etl::this_thread::sleep(100ms);
-        auto lock = await | mutex.lock();
-        
-        oled.setCursor({0, 0});
-        oled << f("h: %lu/%lu t: %lu\n", etl::heap::freeSize.get(), etl::heap::totalSize.get(), tasks.resources());
-    }
+using namespace Project;
+
+static drivers::Compositor::Region line({ .row=0 });
+
+// runs in the timer service task, a loop of its own would hold an etl::async channel forever
+static void heap_info(TimerHandle_t) {
+    char text[drivers::Compositor::max_chars + 1];
+    utils::fmt::format(text, FMT("h: %d/%d t: %d"), etl::heap::freeSize.get(), etl::heap::totalSize.get(), tasks.resources());
+    line.write(text);
 }
 
 APP(heap_info) {
-    etl::async(&heap_info);
+    static StaticTimer_t timer;
+    compositor.add(line);
+    xTimerStart(xTimerCreateStatic("heap_info", pdMS_TO_TICKS(100), pdTRUE, nullptr, heap_info, &timer), 0);
 }
-
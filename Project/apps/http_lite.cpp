@@ -0,0 +1,191 @@
+#include "main.hpp"
+#include "apps/http_lite_handlers.hpp"
+#include "net/http/server.hpp"
+#include "net/http/client.hpp"
+#include "net/http/encoding.hpp"
+#include "utils/json.hpp"
+#include "etl/heap.h"
+
+using namespace Project;
+using namespace Project::net::http;
+using namespace Project::apps;
+using http_lite::error;
+
+// the same routes as the http_server app, served without touching the heap:
+// strings are slices of the receive buffer and the json goes straight into the response;
+// the handlers that need nothing of the board are in http_lite_handlers.cpp, which the host
+// benchmark in sim/ serves as well
+
+static void list_routes(const Request&, Response& res, Arena&);
+
+namespace {
+    struct Heap {
+        size_t free;
+        size_t total;
+        size_t minimum_ever_free;
+    };
+}
+
+// same keys as the /heap map of the http_server app
+JSON_SCHEMA(Heap, JSON_MEMBER("freeSize", free), JSON_MEMBER("totalSize", total), JSON_MEMBER("minimumEverFreeSize", minimum_ever_free));
+
+#ifdef F103_HTTP_CLIENT
+// upstream requests go out on sockets 2 and 3, a connection to a host is kept for the next one
+static Client::Slot client_slots[2];
+
+static Client client({
+    .socket=2,
+    .slots=client_slots,
+    .n_slots=2,
+});
+
+// POST /test forwards its body upstream and answers 202 with a token at once, GET /test?token=
+// collects the response; the server task never waits on the upstream, so other clients are
+// served while it runs, and several requests may be out at the same time
+namespace {
+    struct Upstream {
+        Future future;
+        uint16_t token;
+        volatile bool done;  ///< set by the completion callback, in the client task
+    };
+}
+
+static Upstream upstreams[2];  // one per client slot
+static uint16_t last_token = 0;
+
+static void upstream_done(const Client::Response*, Client::Error, void* arg) {
+    static_cast<Upstream*>(arg)->done = true;
+}
+
+static void start_test(const Request& req, Response& res, Arena&) {
+    // a free entry, or else the oldest response nobody collected
+    Upstream* entry = nullptr;
+    for (auto& upstream : upstreams) {
+        if (not upstream.future.valid()) {
+            entry = &upstream;
+            break;
+        }
+        if (upstream.done and (entry == nullptr or uint16_t(last_token - upstream.token) > uint16_t(last_token - entry->token))) {
+            entry = &upstream;
+        }
+    }
+    if (entry == nullptr) {
+        return error(res, 503, "Busy");
+    }
+
+    entry->future = client.request("GET", "10.20.30.1:5000/test", {.body=req.body, .timeout=pdMS_TO_TICKS(5000)});
+    if (not entry->future.valid()) {
+        auto err = entry->future.error();
+        return error(res, err == Client::Error::TooLarge ? 413 : 503, err == Client::Error::TooLarge ? "Body too large" : "Busy");
+    }
+    entry->token = ++last_token;
+    entry->done = false;
+    entry->future.then(upstream_done, entry);
+
+    res.status = 202;
+    res.header("Content-Type", "application/json");
+    utils::json::Writer(res).begin_object().member("token", entry->token).end_object();
+}
+
+static void collect_test(const Request& req, Response& res, Arena&) {
+    int token = 0;
+    if (not utils::json::to_int(req.queries["token"], token)) {
+        return error(res, 400, "Invalid token");
+    }
+    Upstream* entry = nullptr;
+    for (auto& upstream : upstreams) {
+        if (upstream.future.valid() and upstream.token == token) {
+            entry = &upstream;
+        }
+    }
+    if (entry == nullptr) {
+        return error(res, 404, "No request");
+    }
+    if (not entry->done) {
+        res.status = 202;
+        return;
+    }
+
+    // done already, so this does not wait; the body lives in the client slot until the
+    // future is released
+    auto response = entry->future.wait(0);
+    if (response == nullptr) {
+        auto err = entry->future.error();
+        error(res, err == Client::Error::Timeout ? 408 : 502, err == Client::Error::Timeout ? "Timeout" : "Bad gateway");
+    } else {
+        res.write(response->body);
+    }
+    entry->future.release();
+}
+#endif
+
+// matched through a perfect hash built at compile time, the table lives in flash
+static constexpr RouteTable routes({
+    {"POST", "/foo", http_lite::foo},
+    {"GET", "/heap", [](const Request& req, Response& res, Arena&) {
+        write(res, response_encoding(req), Heap{etl::heap::freeSize.get(), etl::heap::totalSize.get(), etl::heap::minimumEverFreeSize.get()});
+    }},
+    {"GET", "/headers", http_lite::headers},
+    {"GET", "/queries", http_lite::queries},
+    {"GET", "/routes", list_routes},
+#ifdef F103_HTTP_CLIENT
+    {"POST", "/test", start_test},
+    {"GET", "/test", collect_test},
+#endif
+});
+
+static_assert(routes.valid(), "Duplicate route");
+
+// one piece per table entry and the closing bracket last
+static bool route_entry(Response& res, size_t index, const void*) {
+    auto table = routes.view();
+    if (index == table.len()) {
+        res.write("]");
+        return false;
+    }
+    // paths registered for several methods are listed at their first entry, which the
+    // first entry of the table always is
+    auto& route = table.begin()[index];
+    for (auto other = table.begin(); other != &route; ++other) {
+        if (other->path == route.path) {
+            return true;
+        }
+    }
+    res.write(index == 0 ? "[" : ",");
+    utils::json::Writer json(res);
+    json.begin_object().key("methods").begin_array();
+    for (auto& other : table) {
+        if (other.path == route.path) {
+            json.value(other.method);
+        }
+    }
+    json.end_array().member("path", route.path).end_object();
+    return true;
+}
+
+// same layout as the Server::Router json of the http_server app, one entry per path;
+// the list grows with the table, so it is streamed a route at a time rather than bounded
+// by the tx buffer
+static void list_routes(const Request&, Response& res, Arena&) {
+    res.header("Content-Type", "application/json");
+    res.chunked(route_entry);
+}
+
+// sockets 4 and 5 listen together, so one slow client does not hold up the other;
+// 6 and 7 serve modbus
+static Server::Connection connections[2];
+
+static Server server({
+    .port=5001,
+    .socket=4,
+    .connections=connections,
+    .n_connections=2,
+    .routes=routes,
+});
+
+APP(http_lite) {
+    #ifdef F103_HTTP_CLIENT
+    client.init();
+    #endif
+    server.init();
+}
@@ -0,0 +1,84 @@
+#include "apps/http_lite_handlers.hpp"
+#include "net/http/encoding.hpp"
+#include "utils/json.hpp"
+#include <cstring>
+
+using namespace Project::net::http;
+
+namespace Project::apps::http_lite {
+    static const std::string_view access_token = "1234";
+
+    template <size_t N, bool fold_case>
+    static void fields(Response& res, const Fields<N, fold_case>& fields) {
+        res.header("Content-Type", "application/json");
+        utils::json::Writer json(res);
+        json.begin_object();
+        for (auto& field : fields) {
+            json.member(field.name, field.value);
+        }
+        json.end_object();
+    }
+
+    // http_server has a Foo of its own, this one stays in the translation unit
+    namespace {
+        struct Foo {
+            int num;
+            std::string_view text;
+        };
+    }
+}
+
+JSON_SCHEMA(Project::apps::http_lite::Foo, JSON_MEMBER("num", num), JSON_MEMBER("text", text));
+
+void Project::apps::http_lite::error(Response& res, int status, std::string_view what) {
+    res.status = status;
+    res.header("Content-Type", "application/json");
+    utils::json::Writer(res).begin_object().member("err", what).end_object();
+}
+
+void Project::apps::http_lite::foo(const Request& req, Response& res, Arena& arena) {
+    auto token = req.headers["Authentication"];
+    if (token.empty()) {
+        return error(res, 401, "No auth provided");
+    }
+    if (token.substr(0, 7) != "Bearer " or token.substr(7) != access_token) {
+        return error(res, 401, "Token doesn't match");
+    }
+
+    int add = 20;
+    if (auto value = req.headers.has("add") ? req.headers["add"] : req.queries["add"]; not value.empty()) {
+        if (not utils::json::to_int(value, add)) {
+            return error(res, 400, "Invalid add");
+        }
+    }
+
+    // json or cbor both ways, text is a slice of the receive buffer either way
+    Encoding encoding;
+    if (not request_encoding(req, encoding)) {
+        return error(res, 415, "Unsupported content type");
+    }
+    Foo foo = {};
+    if (not read(req, encoding, foo)) {
+        return error(res, 400, encoding == Encoding::Cbor ? "Invalid cbor" : "Invalid json");
+    }
+
+    // the joined text only lives until the response is sent, so it goes in the arena
+    size_t len = foo.text.size() + 2 + token.size();
+    auto joined = arena.allocate_array<char>(len);
+    if (joined == nullptr) {
+        return error(res, 413, "Text too long");
+    }
+    ::memcpy(joined, foo.text.data(), foo.text.size());
+    ::memcpy(joined + foo.text.size(), ": ", 2);
+    ::memcpy(joined + foo.text.size() + 2, token.data(), token.size());
+
+    write(res, response_encoding(req), Foo{foo.num + add, {joined, len}});
+}
+
+void Project::apps::http_lite::headers(const Request& req, Response& res, Arena&) {
+    fields(res, req.headers);
+}
+
+void Project::apps::http_lite::queries(const Request& req, Response& res, Arena&) {
+    fields(res, req.queries);
+}
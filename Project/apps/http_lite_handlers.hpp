@@ -0,0 +1,22 @@
+#ifndef PROJECT_APPS_HTTP_LITE_HANDLERS_HPP
+#define PROJECT_APPS_HTTP_LITE_HANDLERS_HPP
+
+#include "net/http/routes.hpp"
+#include <string_view>
+
+/// Handlers of the http_lite app that need nothing of the board, kept apart so the host
+/// benchmark in sim/http_lite.cpp serves the same code as the firmware.
+namespace Project::apps::http_lite {
+    /// json error body {"err": what} with the given status
+    void error(net::http::Response& res, int status, std::string_view what);
+
+    /// POST /foo: the num and text of a json or cbor Foo, num plus "add" and text joined with
+    /// the bearer token, which must match
+    void foo(const net::http::Request& req, net::http::Response& res, net::http::Arena& arena);
+
+    /// GET /headers and GET /queries: the fields of the request as a json object
+    void headers(const net::http::Request& req, net::http::Response& res, net::http::Arena& arena);
+    void queries(const net::http::Request& req, net::http::Response& res, net::http::Arena& arena);
+}
+
+#endif // PROJECT_APPS_HTTP_LITE_HANDLERS_HPP
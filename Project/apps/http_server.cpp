@@ -1,6 +1,5 @@
 #include "main.hpp"
 #include "wizchip/http/server.h"
-#include "wizchip/http/client.h"
 #include "etl/heap.h"
 
 using namespace Project;
@@ -92,15 +91,8 @@ APP(http_server) {
         }
     };
 
-    app.Post("/test", std::tuple{arg::body}, 
-    [](std::string_view body) -> etl::Result<std::string, Server::Error> {
-        auto res = request("GET", "10.20.30.1:5000/test", {.headers={{"Host", "10.20.30.1:5000"}}, .body=std::string(body)}).wait(5s);
-        if (res.is_ok()) {
-            return etl::Ok(etl::move(res.unwrap().body));
-        } else {
-            return etl::Err(Server::Error{StatusRequestTimeout, "Timeout"});
-        }
-    });
+    // POST /test is served by the http_lite app, whose client does not hold up this task while
+    // the upstream answers
 
     // example: 
     // - adding dependency (in this case is authentication token), 
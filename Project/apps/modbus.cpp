@@ -0,0 +1,64 @@
+#include "main.hpp"
+#include "net/modbus/rtu_slave.hpp"
+#include "net/modbus/tcp_server.hpp"
+#include "etl/heap.h"
+#include "timers.h"
+
+using namespace Project;
+using namespace Project::net::modbus;
+
+#ifdef F103_MODBUS
+
+// live values of the application, the register map points straight at them
+static volatile uint16_t setpoints[8];  ///< holding registers 0..7, written by the master
+static volatile bool outputs[8];        ///< coils 0..7, written by the master
+static volatile uint16_t status[4];     ///< input registers 0..3: uptime in s, free heap, RTU frames, TCP transactions
+
+// one map in flash, served over uart1 and TCP alike
+static constexpr RegisterMap registers({
+    holding_registers(0, setpoints),
+    coils(0, outputs),
+    input_registers(0, status),
+});
+
+static_assert(registers.valid(), "Overlapping registers");
+
+// uart1 receives through its circular RX DMA channel, replies go out from the TXE interrupt
+static drivers::UARTStream stream({
+    .huart=huart1,
+    .baudrate=115200,
+});
+
+static RTUSlave slave({
+    .stream=stream,
+    .address=1,
+    .registers=registers,
+});
+
+// sockets 6 and 7 listen on port 502
+static TCPServer::Connection connections[2];
+
+static TCPServer server({
+    .port=502,
+    .socket=6,
+    .connections=connections,
+    .n_connections=2,
+    .registers=registers,
+});
+
+// refreshed from the timer service task
+static void modbus_status(TimerHandle_t) {
+    status[0] = uint16_t(xTaskGetTickCount() / configTICK_RATE_HZ);
+    status[1] = uint16_t(etl::heap::freeSize.get());
+    status[2] = uint16_t(slave.frames());
+    status[3] = uint16_t(server.stats().transactions);
+}
+
+APP(modbus) {
+    static StaticTimer_t timer;
+    xTimerStart(xTimerCreateStatic("modbus", pdMS_TO_TICKS(100), pdTRUE, nullptr, modbus_status, &timer), 0);
+    stream.init();
+    slave.init();
+    server.init();
+}
+#endif
@@ -0,0 +1,43 @@
+#include "main.hpp"
+#include "net/modbus/rtu_master.hpp"
+
+using namespace Project;
+using namespace Project::net::modbus;
+
+#ifdef F103_MODBUS
+
+// what is read from the bus, adjacent ranges of a slave go out as one request
+static constexpr PollTable polls({
+    // power meter: voltage, current and power, then the energy counters right after them
+    {.slave=10, .table=Table::InputRegisters, .address=0, .count=10, .period=pdMS_TO_TICKS(500)},
+    {.slave=10, .table=Table::InputRegisters, .address=10, .count=6, .period=pdMS_TO_TICKS(5000)},
+    {.slave=10, .table=Table::HoldingRegisters, .address=100, .count=2, .period=pdMS_TO_TICKS(10000)},
+    // IO expander: outputs and inputs
+    {.slave=20, .table=Table::Coils, .address=0, .count=8, .period=pdMS_TO_TICKS(200)},
+    {.slave=20, .table=Table::DiscreteInputs, .address=0, .count=8, .period=pdMS_TO_TICKS(100)},
+});
+
+static_assert(polls.valid(), "Invalid poll");
+static_assert(polls.n_requests() <= RTUMaster::max_reads, "Too many reads");
+
+static uint16_t cache[polls.words()];
+
+// uart2 receives through its circular RX DMA channel, requests go out on its TX DMA channel;
+// the port is the RS-485 bus and nothing else writes to uart2_tx
+static drivers::UARTStream stream({
+    .huart=huart2,
+});
+
+static RTUMaster master({
+    .stream=stream,
+    .tx=drivers::uart2_tx,
+    .polls=polls,
+    .cache=cache,
+    .gap=pdMS_TO_TICKS(4) + 1,  // 3.5 characters at 9600 baud
+});
+
+APP(modbus_master) {
+    stream.init();
+    master.init();
+}
+#endif
@@ -0,0 +1,47 @@
+#include "main.hpp"
+#include "timers.h"
+#include <cstdio>
+
+using namespace Project;
+
+// I2C bus time the display takes with and without skipping unchanged columns, with whatever
+// the other apps draw. Every 10 s the mode flips and the last window is printed on the USB CDC
+// port, which only exists in F103_USE_USB builds:
+//   oled <diff|all> frames <n> bytes/frame <bytes> us/frame <time> bus <percent>%
+// turning the skipping off costs the display what it saves, so this is only built with F103_BENCH;
+// sim/oled_bus.cpp measures the same on the host for a few fixed screens
+
+#if defined(F103_BENCH) and defined(F103_USE_USB)
+static bool compare = true;
+static drivers::Oled::Stats before;
+static TickType_t start;
+
+// runs in the timer service task, like heap_info
+static void oled_bench(TimerHandle_t) {
+    auto after = oled.stats();
+    auto elapsed = xTaskGetTickCount() - start;
+
+    uint32_t frames = after.frames - before.frames;
+    uint32_t bytes = after.bytes - before.bytes;
+    uint32_t us = (after.cycles - before.cycles) / (SystemCoreClock / 1000000);
+    uint32_t window_us = elapsed * (1000000 / configTICK_RATE_HZ);
+
+    char line[96];
+    int len = ::snprintf(line, sizeof(line), "oled %s frames %lu bytes/frame %lu us/frame %lu bus %lu%%\r\n",
+        compare ? "diff" : "all", frames, frames ? bytes / frames : 0, frames ? us / frames : 0,
+        window_us ? us / (window_us / 100) : 0);
+    drivers::cdc.write(line, len < int(sizeof(line)) ? len : sizeof(line) - 1);
+
+    compare = not compare;
+    oled.compare(compare);
+    before = oled.stats();
+    start = xTaskGetTickCount();
+}
+
+APP(oled_bench) {
+    static StaticTimer_t timer;
+    before = oled.stats();
+    start = xTaskGetTickCount();
+    xTimerStart(xTimerCreateStatic("oled_bench", pdMS_TO_TICKS(10000), pdTRUE, nullptr, oled_bench, &timer), 0);
+}
+#endif
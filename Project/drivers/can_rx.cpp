@@ -0,0 +1,124 @@
+#include "drivers/can_rx.hpp"
+#include "timers.h"
+#include <cstring>
+
+using namespace Project::drivers;
+
+static CANReceiver* instance = nullptr;
+
+CANReceiver* CANReceiver::get(const CAN_HandleTypeDef* hcan) {
+    return instance and &instance->hcan == hcan ? instance : nullptr;
+}
+
+bool CANReceiver::init(const Filter* filters, size_t n) {
+    if (n == 0 or n > max_filters) {
+        return false;
+    }
+    for (size_t i = 0; i < max_filters; ++i) {
+        CAN_FilterTypeDef config = {};
+        config.FilterBank = i;
+        config.FilterMode = CAN_FILTERMODE_IDMASK;
+        config.FilterScale = CAN_FILTERSCALE_32BIT;
+        config.SlaveStartFilterBank = max_filters;
+        config.FilterActivation = i < n ? CAN_FILTER_ENABLE : CAN_FILTER_DISABLE;
+
+        if (i < n) {
+            // 32-bit bank layout: STID[10:0] EXID[17:0] IDE RTR 0, IDE is always compared
+            auto& filter = filters[i];
+            uint32_t id = filter.extended ? (filter.id << 3) | CAN_ID_EXT : filter.id << 21;
+            uint32_t mask = (filter.extended ? filter.mask << 3 : filter.mask << 21) | CAN_ID_EXT;
+            config.FilterIdHigh = id >> 16;
+            config.FilterIdLow = id & 0xFFFF;
+            config.FilterMaskIdHigh = mask >> 16;
+            config.FilterMaskIdLow = mask & 0xFFFF;
+            config.FilterFIFOAssignment = filter.fifo;
+        }
+
+        if (HAL_CAN_ConfigFilter(&hcan, &config) != HAL_OK) {
+            return false;
+        }
+    }
+
+    instance = this;
+
+    if (hcan.State == HAL_CAN_STATE_READY and HAL_CAN_Start(&hcan) != HAL_OK) {
+        return false;
+    }
+    return HAL_CAN_ActivateNotification(&hcan, CAN_IT_RX_FIFO0_MSG_PENDING | CAN_IT_RX_FIFO1_MSG_PENDING) == HAL_OK;
+}
+
+bool CANReceiver::subscribe(uint32_t id, uint32_t mask, Callback callback, void* arg) {
+    if (callback == nullptr or n_subscribers == max_subscribers) {
+        return false;
+    }
+    subscribers[n_subscribers++] = {id & mask, mask, callback, arg};
+    return true;
+}
+
+void CANReceiver::dispatch() {
+    // cleared before draining, a frame arriving meanwhile pends another call
+    dispatch_pending = false;
+
+    Frame frame;
+    while (ring.pop(frame)) {
+        for (size_t i = 0; i < n_subscribers; ++i) {
+            auto& sub = subscribers[i];
+            if ((frame.id & sub.mask) == sub.id) {
+                sub.callback(frame, sub.arg);
+            }
+        }
+    }
+}
+
+void CANReceiver::fifo_isr(uint32_t fifo) {
+    // both FIFO interrupts share the same priority, so they never preempt each other
+    // and the ring keeps a single producer
+    auto can = hcan.Instance;
+    volatile uint32_t& rfr = fifo == CAN_RX_FIFO0 ? can->RF0R : can->RF1R;
+    auto& mailbox = can->sFIFOMailBox[fifo];
+    bool received = false;
+
+    while (rfr & CAN_RF0R_FMP0) {
+        Frame frame;
+        uint32_t rir = mailbox.RIR;
+        uint32_t rdtr = mailbox.RDTR;
+        uint32_t data[2] = {mailbox.RDLR, mailbox.RDHR};
+
+        frame.extended = rir & CAN_RI0R_IDE;
+        frame.id = frame.extended ? rir >> CAN_RI0R_EXID_Pos : rir >> CAN_RI0R_STID_Pos;
+        frame.rtr = rir & CAN_RI0R_RTR;
+        frame.len = rdtr & CAN_RDT0R_DLC;
+        frame.filter = (rdtr & CAN_RDT0R_FMI) >> CAN_RDT0R_FMI_Pos;
+        ::memcpy(frame.data, data, sizeof(frame.data));
+
+        // RFOM is bit 5 in both FIFO registers; writing only it leaves the rc_w1 flags alone
+        rfr = CAN_RF0R_RFOM0;
+
+        if (ring.push(frame)) {
+            received = true;
+        } else {
+            dropped_count = dropped_count + 1;
+        }
+    }
+
+    if (rfr & CAN_RF0R_FOVR0) {
+        rfr = CAN_RF0R_FOVR0;
+        overrun_count = overrun_count + 1;
+    }
+
+    if (received and not dispatch_pending) {
+        dispatch_pending = true;
+        BaseType_t woken = pdFALSE;
+        auto fn = [](void* self, uint32_t) { static_cast<CANReceiver*>(self)->dispatch(); };
+        if (xTimerPendFunctionCallFromISR(fn, this, 0, &woken) != pdPASS) {
+            dispatch_pending = false;
+        }
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+extern "C" void CAN_Receive_IRQHandler(CAN_HandleTypeDef* hcan, uint32_t fifo) {
+    if (auto receiver = CANReceiver::get(hcan)) {
+        receiver->fifo_isr(fifo);
+    }
+}
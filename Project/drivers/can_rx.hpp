@@ -0,0 +1,99 @@
+#ifndef PROJECT_DRIVERS_CAN_RX_HPP
+#define PROJECT_DRIVERS_CAN_RX_HPP
+
+#include "can.h"
+#include "FreeRTOS.h"
+#include "utils/ring_buffer.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace Project::drivers {
+    class CANReceiver;
+}
+
+/// CAN receive engine.
+/// Filter banks are programmed from a declarative ID/mask table, with high priority IDs
+/// routed to FIFO1. Both 3-deep hardware FIFOs are drained in a single ISR pass into a
+/// lock-free frame ring. Frames are dispatched to per-ID subscribers from the timer service
+/// task, so the engine doesn't need a task stack of its own.
+class Project::drivers::CANReceiver {
+public:
+    static constexpr size_t ring_size = 32;
+    static constexpr size_t max_subscribers = 8;
+    static constexpr size_t max_filters = 14;
+
+    struct Frame {
+        uint32_t id;
+        bool extended;
+        bool rtr;
+        uint8_t len;
+        uint8_t filter; ///< index of the matching filter bank
+        uint8_t data[8];
+    };
+
+    /// one 32-bit ID/mask filter bank, a set mask bit means the ID bit must match
+    struct Filter {
+        uint32_t id;
+        uint32_t mask;
+        bool extended = false;
+        uint32_t fifo = CAN_FILTER_FIFO0;
+    };
+
+    using Callback = void(*)(const Frame& frame, void* arg);
+
+    struct Config {
+        CAN_HandleTypeDef& hcan;
+    };
+
+    explicit CANReceiver(Config config) : hcan(config.hcan) {}
+
+    /// program the filter banks in table order; a frame matching several banks is
+    /// assigned to the first one, so list high priority IDs first
+    /// @return false if the table doesn't fit in the filter banks or the HAL rejects it
+    bool init(const Filter* filters, size_t n);
+
+    template <size_t N>
+    bool init(const Filter (&filters)[N]) {
+        static_assert(N <= max_filters, "STM32F103 has 14 filter banks");
+        return init(filters, N);
+    }
+
+    /// call callback for every frame where (frame.id & mask) == (id & mask)
+    /// @note subscribe before the scheduler starts; callbacks run in the timer service task
+    /// and must not block
+    bool subscribe(uint32_t id, uint32_t mask, Callback callback, void* arg = nullptr);
+
+    /// hand every queued frame to its subscribers
+    void dispatch();
+
+    /// frames dropped because the ring was full
+    uint32_t dropped() const { return dropped_count; }
+
+    /// hardware FIFO overruns
+    uint32_t overrun() const { return overrun_count; }
+
+    /// called from CAN_Receive_IRQHandler before HAL_CAN_IRQHandler
+    void fifo_isr(uint32_t fifo);
+
+    /// find the receiver of a CAN handle
+    static CANReceiver* get(const CAN_HandleTypeDef* hcan);
+
+private:
+    struct Subscriber {
+        uint32_t id;
+        uint32_t mask;
+        Callback callback;
+        void* arg;
+    };
+
+    CAN_HandleTypeDef& hcan;
+
+    utils::RingBuffer<Frame, ring_size> ring;
+    Subscriber subscribers[max_subscribers] = {};
+    size_t n_subscribers = 0;
+    volatile uint32_t dropped_count = 0;
+    volatile uint32_t overrun_count = 0;
+    volatile bool dispatch_pending = false;
+};
+
+#endif // PROJECT_DRIVERS_CAN_RX_HPP
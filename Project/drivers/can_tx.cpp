@@ -0,0 +1,245 @@
+#include "drivers/can_tx.hpp"
+
+using namespace Project::drivers;
+
+static CANTransmitter* instance = nullptr;
+
+CANTransmitter* CANTransmitter::get(const CAN_HandleTypeDef* hcan) {
+    return instance and &instance->hcan == hcan ? instance : nullptr;
+}
+
+bool CANTransmitter::init() {
+    if (auto_retransmission) {
+        CLEAR_BIT(hcan.Instance->MCR, CAN_MCR_NART);
+    } else {
+        SET_BIT(hcan.Instance->MCR, CAN_MCR_NART);
+    }
+    // mailboxes compete by identifier, not by request order
+    CLEAR_BIT(hcan.Instance->MCR, CAN_MCR_TXFP);
+
+    instance = this;
+
+    if (hcan.State == HAL_CAN_STATE_READY and HAL_CAN_Start(&hcan) != HAL_OK) {
+        return false;
+    }
+    if (HAL_CAN_ActivateNotification(&hcan, CAN_IT_TX_MAILBOX_EMPTY) != HAL_OK) {
+        return false;
+    }
+    if (expire_period == 0) {
+        return true;
+    }
+    auto timer = xTimerCreateStatic("can_tx", expire_period, pdTRUE, this, expire_timer, &timer_buffer);
+    return timer != nullptr and xTimerStart(timer, 0) == pdPASS;
+}
+
+void CANTransmitter::expire_timer(TimerHandle_t timer) {
+    static_cast<CANTransmitter*>(pvTimerGetTimerID(timer))->expire();
+}
+
+uint32_t CANTransmitter::arbitration_key(const Message& msg) {
+    // base ID first, then IDE (a standard frame beats an extended one with the same
+    // base ID), then the extension bits
+    if (msg.extended) {
+        return ((msg.id >> 18) << 19) | (1u << 18) | (msg.id & 0x3FFFF);
+    }
+    return msg.id << 19;
+}
+
+bool CANTransmitter::before(const Entry& a, const Entry& b) {
+    if (a.key != b.key) {
+        return a.key < b.key;
+    }
+    return static_cast<int32_t>(a.sequence - b.sequence) < 0;
+}
+
+bool CANTransmitter::expired(const Message& msg, TickType_t now) {
+    return msg.deadline != 0 and static_cast<int32_t>(now - msg.deadline) >= 0;
+}
+
+bool CANTransmitter::send(const Message& msg) {
+    taskENTER_CRITICAL();
+    bool ok = push({msg, arbitration_key(msg), sequence++});
+    if (ok) {
+        refill(xTaskGetTickCount());
+        preempt();
+    } else {
+        dropped_count = dropped_count + 1;
+    }
+    taskEXIT_CRITICAL();
+    return ok;
+}
+
+void CANTransmitter::expire() {
+    taskENTER_CRITICAL();
+    auto now = xTaskGetTickCount();
+
+    for (size_t i = 0; i < 3; ++i) {
+        auto& mb = mailboxes[i];
+        if (mb.used and not mb.aborting and expired(mb.entry.msg, now)) {
+            mb.aborting = true;
+            HAL_CAN_AbortTxRequest(&hcan, CAN_TX_MAILBOX0 << i);
+        }
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < queue_len; ++i) {
+        if (expired(queue[i].msg, now)) {
+            dropped_count = dropped_count + 1;
+        } else {
+            queue[n++] = queue[i];
+        }
+    }
+
+    // rebuild the heap after a removal, the common case of nothing expired costs one pass
+    if (n < queue_len) {
+        size_t len = n;
+        queue_len = 0;
+        for (size_t i = 0; i < len; ++i) {
+            Entry entry = queue[i];
+            push(entry);
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+bool CANTransmitter::push(const Entry& entry) {
+    if (queue_len == queue_size) {
+        return false;
+    }
+    size_t i = queue_len;
+    queue_len = queue_len + 1;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (not before(entry, queue[parent])) {
+            break;
+        }
+        queue[i] = queue[parent];
+        i = parent;
+    }
+    queue[i] = entry;
+    return true;
+}
+
+CANTransmitter::Entry CANTransmitter::pop() {
+    Entry top = queue[0];
+    Entry last = queue[queue_len - 1];
+    size_t len = queue_len - 1;
+    queue_len = len;
+
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= len) {
+            break;
+        }
+        if (child + 1 < len and before(queue[child + 1], queue[child])) {
+            child++;
+        }
+        if (not before(queue[child], last)) {
+            break;
+        }
+        queue[i] = queue[child];
+        i = child;
+    }
+    if (len > 0) {
+        queue[i] = last;
+    }
+    return top;
+}
+
+void CANTransmitter::refill(TickType_t now) {
+    while (queue_len > 0 and HAL_CAN_GetTxMailboxesFreeLevel(&hcan) > 0) {
+        auto entry = pop();
+        if (expired(entry.msg, now)) {
+            dropped_count = dropped_count + 1;
+            continue;
+        }
+
+        auto& msg = entry.msg;
+        CAN_TxHeaderTypeDef header = {};
+        header.StdId = msg.extended ? 0 : msg.id;
+        header.ExtId = msg.extended ? msg.id : 0;
+        header.IDE = msg.extended ? CAN_ID_EXT : CAN_ID_STD;
+        header.RTR = msg.rtr ? CAN_RTR_REMOTE : CAN_RTR_DATA;
+        header.DLC = msg.len;
+
+        uint32_t mailbox;
+        if (HAL_CAN_AddTxMessage(&hcan, &header, msg.data, &mailbox) != HAL_OK) {
+            push(entry);
+            break;
+        }
+
+        size_t index = mailbox == CAN_TX_MAILBOX0 ? 0 : mailbox == CAN_TX_MAILBOX1 ? 1 : 2;
+        mailboxes[index] = {entry, true, false};
+    }
+}
+
+void CANTransmitter::preempt() {
+    if (queue_len == 0 or HAL_CAN_GetTxMailboxesFreeLevel(&hcan) > 0) {
+        return;
+    }
+
+    // every mailbox is busy: if the best queued frame outranks the worst mailbox,
+    // abort that mailbox, its frame is queued again when the abort completes
+    Mailbox* worst = nullptr;
+    size_t worst_index = 0;
+    for (size_t i = 0; i < 3; ++i) {
+        auto& mb = mailboxes[i];
+        if (mb.aborting) {
+            return; // a slot is already being freed
+        }
+        if (mb.used and (worst == nullptr or before(worst->entry, mb.entry))) {
+            worst = &mb;
+            worst_index = i;
+        }
+    }
+
+    if (worst and before(queue[0], worst->entry)) {
+        worst->aborting = true;
+        HAL_CAN_AbortTxRequest(&hcan, CAN_TX_MAILBOX0 << worst_index);
+    }
+}
+
+void CANTransmitter::tx_isr() {
+    auto can = hcan.Instance;
+    uint32_t tsr = can->TSR;
+
+    for (size_t i = 0; i < 3; ++i) {
+        uint32_t shift = 8 * i;
+        if ((tsr & (CAN_TSR_RQCP0 << shift)) == 0) {
+            continue;
+        }
+
+        // writing RQCP clears TXOK, ALST and TERR of this mailbox as well
+        can->TSR = CAN_TSR_RQCP0 << shift;
+
+        auto& mb = mailboxes[i];
+        if (not mb.used) {
+            continue;
+        }
+        mb.used = false;
+
+        if (tsr & (CAN_TSR_TXOK0 << shift)) {
+            sent_count = sent_count + 1;
+        } else if (mb.aborting and not expired(mb.entry.msg, xTaskGetTickCountFromISR())) {
+            // preempted, compete again; the queue may have filled up meanwhile
+            if (not push(mb.entry)) {
+                dropped_count = dropped_count + 1;
+            }
+        } else if (mb.aborting) {
+            dropped_count = dropped_count + 1;
+        } else {
+            error_count = error_count + 1; // lost arbitration or bus error without retransmission
+        }
+        mb.aborting = false;
+    }
+
+    refill(xTaskGetTickCountFromISR());
+    preempt();
+}
+
+extern "C" void CAN_Transmit_IRQHandler(CAN_HandleTypeDef* hcan) {
+    if (auto transmitter = CANTransmitter::get(hcan)) {
+        transmitter->tx_isr();
+    }
+}
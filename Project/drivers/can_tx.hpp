@@ -0,0 +1,110 @@
+#ifndef PROJECT_DRIVERS_CAN_TX_HPP
+#define PROJECT_DRIVERS_CAN_TX_HPP
+
+#include "can.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Project::drivers {
+    class CANTransmitter;
+}
+
+/// CAN transmit scheduler.
+/// Pending frames wait in a software priority queue ordered by arbitration ID. The three
+/// TX mailboxes are refilled from the mailbox-empty interrupt, and a mailbox holding a lower
+/// priority frame is aborted when a higher priority one is queued, so the most important
+/// pending frame always competes for the bus next. Frames carry an optional deadline and
+/// are dropped instead of sent once it has passed; a timer of the transmitter checks the
+/// deadlines, since a frame that never wins the bus raises no interrupt.
+class Project::drivers::CANTransmitter {
+public:
+    static constexpr size_t queue_size = 16;
+
+    struct Message {
+        uint32_t id;
+        bool extended = false;
+        bool rtr = false;
+        uint8_t len = 0;
+        uint8_t data[8] = {};
+        TickType_t deadline = 0; ///< absolute tick count, 0 means no deadline
+    };
+
+    struct Config {
+        CAN_HandleTypeDef& hcan;
+        bool auto_retransmission = true; ///< hardware retries until the frame wins arbitration or is aborted
+        TickType_t expire_period = pdMS_TO_TICKS(10); ///< how often deadlines are checked, 0 leaves it to expire()
+    };
+
+    explicit CANTransmitter(Config config)
+        : hcan(config.hcan), auto_retransmission(config.auto_retransmission), expire_period(config.expire_period) {}
+
+    bool init();
+
+    /// queue a frame without blocking
+    /// @note safe to call from any task
+    /// @return false if the queue is full
+    bool send(const Message& msg);
+
+    /// queue a frame that is dropped if it is not sent within timeout ticks
+    bool send(Message msg, TickType_t timeout) {
+        msg.deadline = xTaskGetTickCount() + timeout;
+        if (msg.deadline == 0) msg.deadline = 1;
+        return send(msg);
+    }
+
+    /// abort mailboxes and drop queued frames whose deadline has passed
+    /// @note called from the timer service task every expire_period
+    void expire();
+
+    uint32_t sent() const { return sent_count; }
+    uint32_t dropped() const { return dropped_count; }
+    uint32_t errors() const { return error_count; }
+    size_t pending() const { return queue_len; }
+
+    /// called from CAN_Transmit_IRQHandler before HAL_CAN_IRQHandler
+    void tx_isr();
+
+    /// find the transmitter of a CAN handle
+    static CANTransmitter* get(const CAN_HandleTypeDef* hcan);
+
+private:
+    struct Entry {
+        Message msg;
+        uint32_t key;      ///< arbitration order, lower wins
+        uint32_t sequence; ///< keeps frames with the same ID in submission order
+    };
+
+    struct Mailbox {
+        Entry entry;
+        bool used;
+        bool aborting;
+    };
+
+    static uint32_t arbitration_key(const Message& msg);
+    static bool before(const Entry& a, const Entry& b);
+    static bool expired(const Message& msg, TickType_t now);
+    static void expire_timer(TimerHandle_t timer);
+
+    bool push(const Entry& entry);
+    Entry pop();
+    void refill(TickType_t now);
+    void preempt();
+
+    CAN_HandleTypeDef& hcan;
+    bool auto_retransmission;
+    TickType_t expire_period;
+
+    Entry queue[queue_size] = {}; ///< binary min-heap
+    volatile size_t queue_len = 0;
+    uint32_t sequence = 0;
+    Mailbox mailboxes[3] = {};
+    volatile uint32_t sent_count = 0;
+    volatile uint32_t dropped_count = 0;
+    volatile uint32_t error_count = 0;
+    StaticTimer_t timer_buffer = {};
+};
+
+#endif // PROJECT_DRIVERS_CAN_TX_HPP
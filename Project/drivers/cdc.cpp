@@ -0,0 +1,142 @@
+#include "drivers/cdc.hpp"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <cstring>
+
+using namespace Project::drivers;
+
+static CDC* instance = nullptr;
+
+void CDC::init() {
+    rx_sem = xSemaphoreCreateBinaryStatic(&rx_sem_buffer);
+    instance = this;
+}
+
+size_t CDC::write(const void* buf, size_t len) {
+    auto mask = taskENTER_CRITICAL_FROM_ISR();
+
+    size_t n = tx_ring.push_n(static_cast<const uint8_t*>(buf), len);
+    tx_dropped_count = tx_dropped_count + (len - n);
+    tx_kick();
+
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    return n;
+}
+
+size_t CDC::write(const char* str) {
+    return write(str, ::strlen(str));
+}
+
+void CDC::tx_complete_isr() {
+    tx_ring.consume(tx_in_flight);
+    tx_in_flight = 0;
+    tx_kick();
+}
+
+void CDC::tx_kick() {
+    auto hcdc = static_cast<USBD_CDC_HandleTypeDef*>(husbd.pClassData);
+    if (hcdc == nullptr or husbd.dev_state != USBD_STATE_CONFIGURED) {
+        return;
+    }
+
+    // TxState is cleared right before the completion callback runs in the same ISR,
+    // so seeing it cleared with a transfer still in flight means the class was reset
+    // and the data has to be sent again
+    if (tx_in_flight != 0 and hcdc->TxState == 0) {
+        tx_in_flight = 0;
+    }
+    if (tx_in_flight != 0 or hcdc->TxState != 0) {
+        return;
+    }
+
+    // send the whole contiguous region in one transfer, the PCD splits it into
+    // packets and keeps both PMA buffers of the endpoint filled
+    auto span = tx_ring.read_span();
+    if (span.len == 0) {
+        return;
+    }
+
+    tx_in_flight = span.len;
+    USBD_CDC_SetTxBuffer(&husbd, span.data, span.len);
+    if (USBD_CDC_TransmitPacket(&husbd) != USBD_OK) {
+        tx_in_flight = 0;
+    }
+}
+
+bool CDC::receive(Packet& pkt, TickType_t timeout) {
+    while (rx_consumed == rx_filled) {
+        if (xSemaphoreTake(rx_sem, timeout) != pdTRUE) {
+            return false;
+        }
+    }
+
+    size_t index = rx_consumed % rx_pool_size;
+    pkt = {rx_pool[index], rx_len[index]};
+    rx_consumed = rx_consumed + 1;
+    return true;
+}
+
+void CDC::release() {
+    taskENTER_CRITICAL();
+    if (rx_released != rx_consumed) {
+        rx_released = rx_released + 1;
+    }
+    if (rx_paused) {
+        if (auto buf = rx_next_buffer(); buf != nullptr) {
+            rx_paused = false;
+            CDC_ReceiveResume_FS(buf);
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+uint8_t* CDC::rx_next_buffer() {
+    // the buffer for the next packet is free once every packet before it in the
+    // pool rotation has been released
+    if (rx_filled - rx_released >= rx_pool_size) {
+        return nullptr;
+    }
+    return rx_pool[rx_filled % rx_pool_size];
+}
+
+uint8_t* CDC::rx_init_isr() {
+    auto buf = rx_next_buffer();
+    rx_paused = buf == nullptr;
+    if (rx_paused) {
+        // the class always arms the endpoint after a reset, so park the first
+        // packet in the scratch buffer, it is counted as an overrun
+        return UserRxBufferFS;
+    }
+    return buf;
+}
+
+uint8_t* CDC::rx_complete_isr(uint8_t* buf, size_t len) {
+    if (buf == rx_pool[rx_filled % rx_pool_size] and rx_filled - rx_released < rx_pool_size) {
+        rx_len[rx_filled % rx_pool_size] = len;
+        rx_filled = rx_filled + 1;
+
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(rx_sem, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        rx_overrun_count = rx_overrun_count + 1;
+    }
+
+    auto next = rx_next_buffer();
+    rx_paused = next == nullptr;
+    return next;
+}
+
+extern "C" uint8_t* CDC_ReceiveStream_Init() {
+    return instance ? instance->rx_init_isr() : UserRxBufferFS;
+}
+
+extern "C" uint8_t* CDC_ReceiveStream_Callback(uint8_t* pbuf, uint32_t len) {
+    return instance ? instance->rx_complete_isr(pbuf, len) : pbuf;
+}
+
+extern "C" void CDC_TransmitCplt_Callback(const uint8_t*, uint32_t) {
+    if (instance) {
+        instance->tx_complete_isr();
+    }
+}
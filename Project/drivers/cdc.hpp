@@ -0,0 +1,92 @@
+#ifndef PROJECT_DRIVERS_CDC_HPP
+#define PROJECT_DRIVERS_CDC_HPP
+
+#include "usbd_cdc_if.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "utils/ring_buffer.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace Project::drivers {
+    class CDC;
+}
+
+/// USB CDC stream.
+/// Writes are copied into a transmit ring and streamed to the bulk IN endpoint from
+/// the DataIn completion callback, so callers never wait for the previous transfer.
+/// Small writes issued while a transfer is in flight are coalesced into full packets.
+/// OUT packets land in a pool of packet buffers that are handed to the consumer task
+/// without copying; when every buffer is taken, the endpoint is left unarmed and the
+/// host is NAKed until the consumer releases one.
+class Project::drivers::CDC {
+public:
+    static constexpr size_t tx_buffer_size = 512;
+    static constexpr size_t rx_pool_size = 4;
+
+    /// received OUT packet, owned by the consumer until released
+    struct Packet {
+        const uint8_t* data;
+        size_t len;
+    };
+
+    struct Config {
+        USBD_HandleTypeDef& husbd;
+    };
+
+    explicit CDC(Config config) : husbd(config.husbd) {}
+
+    void init();
+
+    /// queue bytes for transmission without blocking
+    /// @note safe to call from any task or ISR
+    /// @return number of bytes accepted, less than len if the ring is full
+    size_t write(const void* buf, size_t len);
+    size_t write(const char* str);
+
+    /// number of queued bytes that are not yet acknowledged by the host
+    size_t tx_pending() const { return tx_ring.size(); }
+
+    /// number of bytes rejected because the ring was full
+    uint32_t tx_dropped() const { return tx_dropped_count; }
+
+    /// called from CDC_TransmitCplt_Callback
+    void tx_complete_isr();
+
+    /// wait for the next received packet
+    /// @note single consumer; the packet must be released before its buffer can be reused
+    /// @return false on timeout
+    bool receive(Packet& pkt, TickType_t timeout = portMAX_DELAY);
+
+    /// give the oldest received packet back to the pool
+    void release();
+
+    /// number of OUT packets that were discarded
+    uint32_t rx_overrun() const { return rx_overrun_count; }
+
+    /// called from CDC_ReceiveStream_Init and CDC_ReceiveStream_Callback
+    uint8_t* rx_init_isr();
+    uint8_t* rx_complete_isr(uint8_t* buf, size_t len);
+
+private:
+    void tx_kick();
+    uint8_t* rx_next_buffer();
+
+    USBD_HandleTypeDef& husbd;
+
+    utils::RingBuffer<uint8_t, tx_buffer_size> tx_ring; ///< producers are serialized by a critical section
+    volatile size_t tx_in_flight = 0;
+    volatile uint32_t tx_dropped_count = 0;
+
+    uint8_t rx_pool[rx_pool_size][CDC_DATA_FS_OUT_PACKET_SIZE] = {};
+    size_t rx_len[rx_pool_size] = {};
+    volatile size_t rx_filled = 0;   ///< packets written by the host
+    volatile size_t rx_consumed = 0; ///< packets handed to the consumer
+    volatile size_t rx_released = 0; ///< packets given back to the pool
+    volatile bool rx_paused = false;
+    volatile uint32_t rx_overrun_count = 0;
+    StaticSemaphore_t rx_sem_buffer = {};
+    SemaphoreHandle_t rx_sem = nullptr;
+};
+
+#endif // PROJECT_DRIVERS_CDC_HPP
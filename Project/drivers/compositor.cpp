@@ -0,0 +1,87 @@
+#include "drivers/compositor.hpp"
+#include <atomic>
+
+using namespace Project::drivers;
+
+Compositor::Region::Region(Config config) : row(config.row), column(config.column), width(config.width) {
+    row %= Oled::pages;
+    column = column < max_chars ? column : max_chars;
+    width = width < max_chars - column ? width : max_chars - column;
+}
+
+void Compositor::Region::write(const char* str) {
+    uint32_t seq = sequence;
+    auto& back = buffers[(seq + 1) & 1];
+
+    // the renderer copies the front buffer; one still copying this buffer from before the
+    // last publish drops what it got
+    uint8_t len = 0;
+    for (; len < width and str[len] != '\0' and str[len] != '\n'; ++len) {
+        back.text[len] = str[len];
+    }
+    back.len = len;
+
+    std::atomic_signal_fence(std::memory_order_release);
+    sequence = seq + 1;
+}
+
+bool Compositor::add(Region& region) {
+    size_t n = n_regions;
+    if (n == max_regions) {
+        return false;
+    }
+    regions[n] = &region;
+    std::atomic_signal_fence(std::memory_order_release);
+    n_regions = n + 1;
+    return true;
+}
+
+bool Compositor::init() {
+    task = xTaskCreateStatic(task_function, "compositor", stack_size, this, priority, stack, &task_buffer);
+    return task != nullptr;
+}
+
+void Compositor::task_function(void* self) {
+    static_cast<Compositor*>(self)->run();
+}
+
+void Compositor::run() {
+    for (;;) {
+        size_t n = n_regions;
+        std::atomic_signal_fence(std::memory_order_acquire);
+        for (size_t i = 0; i < n; ++i) {
+            render(*regions[i]);
+        }
+        oled.flush();
+        vTaskDelay(period);
+    }
+}
+
+void Compositor::render(Region& region) {
+    uint32_t seq = region.sequence;
+    if (seq == region.rendered) {
+        return;
+    }
+
+    std::atomic_signal_fence(std::memory_order_acquire);
+    auto& front = region.buffers[seq & 1];
+    char text[max_chars];
+    uint8_t len = front.len < region.width ? front.len : region.width;
+    for (uint8_t i = 0; i < len; ++i) {
+        text[i] = front.text[i];
+    }
+
+    // a second publish would have reused the front buffer
+    std::atomic_signal_fence(std::memory_order_acquire);
+    if (region.sequence != seq) {
+        statistics.retries++;
+        return;
+    }
+
+    oled.setCursor({uint8_t(region.column * Oled::char_width), region.row});
+    for (uint8_t i = 0; i < region.width; ++i) {
+        oled << (i < len ? text[i] : ' ');
+    }
+    region.rendered = seq;
+    statistics.renders++;
+}
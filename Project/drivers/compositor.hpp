@@ -0,0 +1,114 @@
+#ifndef PROJECT_DRIVERS_COMPOSITOR_HPP
+#define PROJECT_DRIVERS_COMPOSITOR_HPP
+
+#include "drivers/oled.hpp"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Project::drivers {
+    class Compositor;
+}
+
+/// Text cell compositor for the oled.
+/// Every producer owns a Region, a run of character cells on one line, and replaces its text
+/// without locking: the region is double buffered, the producer fills the buffer that is not
+/// published and publishes it by bumping a sequence, so a write never waits for anything.
+/// The renderer, a task of its own, copies the published text of every region that changed, draws it into
+/// the framebuffer and flushes, and is then the only one touching the display; a copy during
+/// which the producer published again is dropped and the newer text is taken on the next pass.
+/// @code
+/// compositor.init();
+///
+/// static drivers::Compositor::Region status({.row=0});
+///
+/// APP(status) {
+///     compositor.add(status);
+///     ...
+/// }
+///
+/// status.write("link up");
+/// @endcode
+class Project::drivers::Compositor {
+public:
+    static constexpr size_t max_regions = 8;
+    static constexpr size_t max_chars = Oled::width / Oled::char_width;
+
+    class Region;
+
+    struct Config {
+        Oled& oled;
+        TickType_t period = pdMS_TO_TICKS(50); ///< between render passes
+        UBaseType_t priority = tskIDLE_PRIORITY + 1;
+    };
+
+    struct Stats {
+        uint32_t renders;  ///< regions drawn
+        uint32_t retries;  ///< copies dropped because the region was published meanwhile
+    };
+
+    explicit Compositor(Config config) : oled(config.oled), period(config.period), priority(config.priority) {}
+
+    /// start the renderer task, from then on it is the only one that flushes the display
+    bool init();
+
+    /// render the region from the next pass on
+    /// @return false if there are max_regions already
+    bool add(Region& region);
+
+    const Stats& stats() const { return statistics; }
+
+private:
+    static constexpr size_t stack_size = 160;
+
+    static void task_function(void* self);
+    [[noreturn]] void run();
+    void render(Region& region);
+
+    Oled& oled;
+    TickType_t period;
+    UBaseType_t priority;
+    Region* regions[max_regions] = {};
+    volatile size_t n_regions = 0;
+    Stats statistics = {};
+    TaskHandle_t task = nullptr;
+    StaticTask_t task_buffer = {};
+    StackType_t stack[stack_size] = {};
+};
+
+/// Character cells of one line, written by a single task.
+class Project::drivers::Compositor::Region {
+public:
+    struct Config {
+        uint8_t row;                      ///< oled page
+        uint8_t column = 0;               ///< in characters
+        uint8_t width = max_chars;        ///< in characters, cut at the edge of the screen
+    };
+
+    explicit Region(Config config);
+
+    /// replace the text, up to the width or the first newline; the rest of the cells is blank
+    /// @note wait-free, only the task owning the region may call it
+    void write(const char* str);
+
+    template <typename String>
+    auto write(const String& str) -> decltype(str.data(), void()) { write(str.data()); }
+
+private:
+    friend class Compositor;
+
+    struct Buffer {
+        char text[max_chars];
+        uint8_t len;
+    };
+
+    uint8_t row;
+    uint8_t column;
+    uint8_t width;
+    Buffer buffers[2] = {};
+    volatile uint32_t sequence = 0;  ///< publishes so far, the front buffer is buffers[sequence & 1]
+    uint32_t rendered = 0;           ///< sequence drawn last, renderer only
+};
+
+#endif // PROJECT_DRIVERS_COMPOSITOR_HPP
@@ -0,0 +1,339 @@
+#include "drivers/oled.hpp"
+#include "task.h"
+
+using namespace Project::drivers;
+
+static Oled* instance = nullptr;
+
+/// flag waits spin at most this many times, about 10 ms at 72 MHz, as they also run with
+/// interrupts disabled
+static constexpr uint32_t max_spins = 100000;
+
+/// control bytes of the SSD1306: a single command follows, or data up to the stop condition
+static constexpr uint8_t single_command = 0x80;
+static constexpr uint8_t data_stream = 0x40;
+static constexpr uint8_t command_stream = 0x00;
+
+static const uint8_t setup[] = {
+    0xAE,        // display off
+    0xD5, 0x80,  // clock divide ratio
+    0xA8, 0x3F,  // multiplex 64
+    0xD3, 0x00,  // no display offset
+    0x40,        // start line 0
+    0x8D, 0x14,  // charge pump on
+    0x20, 0x02,  // page addressing
+    0xA1,        // column 127 is SEG0
+    0xC8,        // scan COM63 to COM0
+    0xDA, 0x12,  // alternative COM pins
+    0x81, 0xCF,  // contrast
+    0xD9, 0xF1,  // precharge
+    0xDB, 0x40,  // VCOMH deselect level
+    0xA4,        // display the RAM
+    0xA6,        // not inverted
+    0xAF,        // display on
+};
+
+/// 5x7 glyphs of ASCII 0x20..0x7E, one byte per column, bit 0 at the top
+static const uint8_t font[][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00}, {0x14, 0x7F, 0x14, 0x7F, 0x14},
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62}, {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00},
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x08, 0x2A, 0x1C, 0x2A, 0x08}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00}, {0x20, 0x10, 0x08, 0x04, 0x02},
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00}, {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31},
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00}, {0x00, 0x56, 0x36, 0x00, 0x00},
+    {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14}, {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06},
+    {0x32, 0x49, 0x79, 0x41, 0x3E}, {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01}, {0x3E, 0x41, 0x49, 0x49, 0x7A},
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00}, {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41},
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, {0x7F, 0x02, 0x0C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46}, {0x46, 0x49, 0x49, 0x49, 0x31},
+    {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F}, {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F},
+    {0x63, 0x14, 0x08, 0x14, 0x63}, {0x07, 0x08, 0x70, 0x08, 0x07}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04}, {0x40, 0x40, 0x40, 0x40, 0x40},
+    {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78}, {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20},
+    {0x38, 0x44, 0x44, 0x48, 0x7F}, {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x0C, 0x52, 0x52, 0x52, 0x3E},
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00}, {0x7F, 0x10, 0x28, 0x44, 0x00},
+    {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78}, {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38},
+    {0x7C, 0x14, 0x14, 0x14, 0x08}, {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20},
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C}, {0x3C, 0x40, 0x30, 0x40, 0x3C},
+    {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C}, {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00},
+    {0x00, 0x00, 0x7F, 0x00, 0x00}, {0x00, 0x41, 0x36, 0x08, 0x00}, {0x08, 0x04, 0x08, 0x10, 0x08},
+};
+
+static_assert(sizeof(font) / sizeof(font[0]) == 0x7F - 0x20, "Missing glyphs");
+
+/// tasks can block and the dirty ranges need a critical section, not so before the scheduler
+/// starts or from panic()
+static bool scheduler_running() {
+    return xTaskGetSchedulerState() == taskSCHEDULER_RUNNING and __get_PRIMASK() == 0;
+}
+
+static void dma_complete_callback(DMA_HandleTypeDef*) {
+    if (instance) {
+        instance->dma_complete_isr();
+    }
+}
+
+static void dma_error_callback(DMA_HandleTypeDef*) {
+    if (instance) {
+        instance->dma_error_isr();
+    }
+}
+
+/// program the channel directly, the HAL start functions refuse a channel whose previous
+/// transfer was stopped by a timeout
+static void arm(DMA_HandleTypeDef* hdma, volatile uint32_t* periph, const void* mem, size_t len) {
+    auto channel = hdma->Instance;
+    CLEAR_BIT(channel->CCR, DMA_CCR_EN);
+    hdma->DmaBaseAddress->IFCR = DMA_ISR_GIF1 << hdma->ChannelIndex;
+    MODIFY_REG(channel->CCR, DMA_CCR_HTIE, DMA_CCR_TCIE | DMA_CCR_TEIE);
+    channel->CNDTR = len;
+    channel->CPAR = uint32_t(reinterpret_cast<uintptr_t>(periph));
+    channel->CMAR = uint32_t(reinterpret_cast<uintptr_t>(mem));
+    SET_BIT(channel->CCR, DMA_CCR_EN);
+}
+
+void Oled::init() {
+    if (done_sem == nullptr) {
+        done_sem = xSemaphoreCreateBinaryStatic(&done_sem_buffer);
+    }
+
+    hi2c.hdmatx->XferCpltCallback = dma_complete_callback;
+    hi2c.hdmatx->XferErrorCallback = dma_error_callback;
+    hi2c.hdmatx->XferHalfCpltCallback = nullptr;
+    hi2c.hdmatx->XferAbortCallback = nullptr;
+    __HAL_I2C_ENABLE(&hi2c);
+    instance = this;
+
+    // the flush time is counted in cycles
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    uint8_t control = command_stream;
+    transfer(&control, 1, setup, sizeof(setup));
+
+    // the controller RAM holds noise after power up, the whole screen goes out once
+    for (size_t page = 0; page < pages; ++page) {
+        for (size_t column = 0; column < width; ++column) {
+            buffer[page][column] = 0;
+        }
+        dirty_lo[page] = 0;
+        dirty_hi[page] = width;
+    }
+    cursor = {};
+    flush();
+}
+
+bool Oled::flush() {
+    bool locked = scheduler_running();
+    uint32_t start = DWT->CYCCNT;
+    bool ok = true, sent = false;
+
+    for (uint8_t page = 0; page < pages; ++page) {
+        if (locked) {
+            taskENTER_CRITICAL();
+        }
+        uint8_t lo = dirty_lo[page], hi = dirty_hi[page];
+        dirty_lo[page] = dirty_hi[page] = 0;
+        if (locked) {
+            taskEXIT_CRITICAL();
+        }
+        if (lo >= hi) {
+            continue;
+        }
+
+        // page and column go in the same transaction as the pixels
+        uint8_t prefix[] = {
+            single_command, uint8_t(0xB0 | page),
+            single_command, uint8_t(lo & 0x0F),
+            single_command, uint8_t(0x10 | lo >> 4),
+            data_stream,
+        };
+        sent = true;
+        if (not transfer(prefix, sizeof(prefix), &buffer[page][lo], hi - lo)) {
+            statistics.errors++;
+            mark(page, lo, hi);
+            ok = false;
+        }
+    }
+
+    if (sent) {
+        statistics.frames++;
+        statistics.cycles += DWT->CYCCNT - start;
+    }
+    return ok;
+}
+
+void Oled::clear() {
+    for (uint8_t page = 0; page < pages; ++page) {
+        uint8_t lo = width, hi = 0;
+        for (uint8_t column = 0; column < width; ++column) {
+            set(page, column, 0, lo, hi);
+        }
+        mark(page, lo, hi);
+    }
+}
+
+auto Oled::operator<<(char ch) -> Oled& {
+    if (ch == '\n') {
+        newline();
+        return *this;
+    }
+    if (cursor.x + char_width > int(width)) {
+        newline();
+    }
+
+    auto& glyph = font[ch >= 0x20 and ch < 0x7F ? ch - 0x20 : '?' - 0x20];
+    uint8_t page = cursor.y % pages;
+    uint8_t lo = width, hi = 0;
+    for (uint8_t k = 0; k < char_width; ++k) {
+        set(page, cursor.x + k, k < sizeof(glyph) ? glyph[k] : 0, lo, hi);
+    }
+    mark(page, lo, hi);
+    cursor.x += char_width;
+    return *this;
+}
+
+auto Oled::operator<<(const char* str) -> Oled& {
+    while (*str) {
+        *this << *str++;
+    }
+    return *this;
+}
+
+void Oled::write(std::string_view str) {
+    for (char ch : str) {
+        *this << ch;
+    }
+}
+
+void Oled::draw(Point point, const uint8_t* columns, size_t n) {
+    uint8_t page = point.y % pages;
+    uint8_t lo = width, hi = 0;
+    for (size_t k = 0; k < n and point.x + k < width; ++k) {
+        set(page, uint8_t(point.x + k), columns[k], lo, hi);
+    }
+    mark(page, lo, hi);
+}
+
+void Oled::set(uint8_t page, uint8_t column, uint8_t value, uint8_t& lo, uint8_t& hi) {
+    if (compare_enabled and buffer[page][column] == value) {
+        return;
+    }
+    buffer[page][column] = value;
+    lo = column < lo ? column : lo;
+    hi = column + 1 > hi ? column + 1 : hi;
+}
+
+void Oled::mark(uint8_t page, uint8_t lo, uint8_t hi) {
+    if (lo >= hi) {
+        return;
+    }
+    bool locked = scheduler_running();
+    if (locked) {
+        taskENTER_CRITICAL();
+    }
+    if (dirty_lo[page] >= dirty_hi[page]) {
+        dirty_lo[page] = lo;
+        dirty_hi[page] = hi;
+    } else {
+        dirty_lo[page] = lo < dirty_lo[page] ? lo : dirty_lo[page];
+        dirty_hi[page] = hi > dirty_hi[page] ? hi : dirty_hi[page];
+    }
+    if (locked) {
+        taskEXIT_CRITICAL();
+    }
+}
+
+void Oled::newline() {
+    // what is left of the line belongs to the previous text
+    uint8_t page = cursor.y % pages;
+    uint8_t lo = width, hi = 0;
+    for (uint8_t column = cursor.x; column < width; ++column) {
+        set(page, column, 0, lo, hi);
+    }
+    mark(page, lo, hi);
+    cursor.x = 0;
+    cursor.y = (page + 1) % pages;
+}
+
+bool Oled::transfer(const uint8_t* prefix, size_t prefix_len, const uint8_t* data, size_t len) {
+    auto i2c = hi2c.Instance;
+    bool dma = len >= dma_threshold and scheduler_running();
+    statistics.bytes += 1 + prefix_len + len;
+
+    if (not start()) {
+        return false;
+    }
+    bool ok = send(prefix, prefix_len);
+    if (ok and dma) {
+        // the channel takes over from the next TXE request
+        dma_failed = false;
+        xSemaphoreTake(done_sem, 0);
+        arm(hi2c.hdmatx, &i2c->DR, data, len);
+        SET_BIT(i2c->CR2, I2C_CR2_DMAEN);
+        ok = xSemaphoreTake(done_sem, timeout) == pdTRUE and not dma_failed;
+        CLEAR_BIT(i2c->CR2, I2C_CR2_DMAEN);
+        CLEAR_BIT(hi2c.hdmatx->Instance->CCR, DMA_CCR_EN);
+    } else if (ok) {
+        ok = send(data, len);
+    }
+
+    // the DMA is done once the last byte is in the data register, not on the bus
+    ok = ok and wait(I2C_FLAG_BTF);
+    SET_BIT(i2c->CR1, I2C_CR1_STOP);
+    return ok;
+}
+
+bool Oled::start() {
+    auto i2c = hi2c.Instance;
+    SET_BIT(i2c->CR1, I2C_CR1_START);
+    if (not wait(I2C_FLAG_SB)) {
+        SET_BIT(i2c->CR1, I2C_CR1_STOP);
+        return false;
+    }
+    i2c->DR = address;
+    if (not wait(I2C_FLAG_ADDR)) {
+        SET_BIT(i2c->CR1, I2C_CR1_STOP);
+        return false;
+    }
+    __HAL_I2C_CLEAR_ADDRFLAG(&hi2c);
+    return true;
+}
+
+bool Oled::send(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        if (not wait(I2C_FLAG_TXE)) {
+            return false;
+        }
+        hi2c.Instance->DR = data[i];
+    }
+    return true;
+}
+
+bool Oled::wait(uint32_t flag) {
+    for (uint32_t n = 0; n < max_spins; ++n) {
+        if (__HAL_I2C_GET_FLAG(&hi2c, flag)) {
+            return true;
+        }
+        if (__HAL_I2C_GET_FLAG(&hi2c, I2C_FLAG_AF)) {
+            __HAL_I2C_CLEAR_FLAG(&hi2c, I2C_FLAG_AF);
+            return false;
+        }
+    }
+    return false;
+}
+
+void Oled::dma_complete_isr() {
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(done_sem, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void Oled::dma_error_isr() {
+    dma_failed = true;
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(done_sem, &woken);
+    portYIELD_FROM_ISR(woken);
+}
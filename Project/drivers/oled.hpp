@@ -0,0 +1,115 @@
+#ifndef PROJECT_DRIVERS_OLED_HPP
+#define PROJECT_DRIVERS_OLED_HPP
+
+#include "i2c.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Project::drivers {
+    class Oled;
+}
+
+/// SSD1306 128x64 display on I2C with a local framebuffer.
+/// Drawing only changes the 1 KB framebuffer in RAM and widens the dirty column range of the
+/// pages it touched, skipping columns whose byte did not change, so rewriting the same text
+/// costs nothing. A single task flushes the dirty ranges, one I2C transaction each: the page
+/// and column commands are polled in first and the pixels follow on the I2C TX DMA channel
+/// straight from the framebuffer while the task blocks.
+/// Drawing is not locked, tasks that share the display serialize among themselves; the flush
+/// task may run between them and sends whatever it finds, a range drawn meanwhile is marked
+/// again and goes out with the next flush.
+/// @note the I2C HAL callbacks are not used, the transfer is driven through the registers
+class Project::drivers::Oled {
+public:
+    static constexpr size_t width = 128;
+    static constexpr size_t pages = 8;       ///< rows of 8 pixels, one text line each
+    static constexpr uint8_t char_width = 6; ///< 5x7 glyph and a blank column
+
+    struct Config {
+        I2C_HandleTypeDef& hi2c;
+        uint8_t address = 0x3C << 1;
+        TickType_t timeout = pdMS_TO_TICKS(20);
+        size_t dma_threshold = 8;              ///< shorter ranges are polled
+    };
+
+    /// x is a column in pixels, y a page
+    struct Point {
+        uint8_t x;
+        uint8_t y;
+    };
+
+    struct Stats {
+        uint32_t frames;  ///< flushes that sent something
+        uint32_t bytes;   ///< on the bus, address and control bytes included
+        uint32_t cycles;  ///< CPU cycles from the first start condition to the last stop of a flush
+        uint32_t errors;  ///< transfers that were not acknowledged or timed out
+    };
+
+    explicit Oled(Config config)
+        : hi2c(config.hi2c), address(config.address), timeout(config.timeout),
+          dma_threshold(config.dma_threshold) {}
+
+    /// configure the controller and clear the screen, polled
+    void init();
+
+    /// send the dirty ranges now, polled if the scheduler is not running
+    /// @return false if a transfer failed, its range is marked again
+    bool flush();
+
+    void clear();
+    void setCursor(Point point) { cursor = point; }
+    Point getCursor() const { return cursor; }
+
+    /// text at the cursor; a newline clears the rest of the line, a line that is too long wraps
+    Oled& operator<<(char ch);
+    Oled& operator<<(const char* str);
+
+    template <typename String>
+    auto operator<<(const String& str) -> decltype(str.data(), *this) { return *this << str.data(); }
+
+    /// text at the cursor, as a sink of fmt::write
+    void write(std::string_view str);
+
+    /// copy n columns of a page, bit 0 at the top
+    void draw(Point point, const uint8_t* columns, size_t n);
+
+    /// skip columns whose byte did not change, on by default; when off every drawn column is
+    /// sent, as much as writing straight to the display would, for comparison
+    void compare(bool enable) { compare_enabled = enable; }
+
+    const Stats& stats() const { return statistics; }
+
+    /// called from the I2C TX DMA callbacks
+    void dma_complete_isr();
+    void dma_error_isr();
+
+private:
+    void set(uint8_t page, uint8_t column, uint8_t value, uint8_t& lo, uint8_t& hi);
+    void mark(uint8_t page, uint8_t lo, uint8_t hi);
+    void newline();
+    bool transfer(const uint8_t* prefix, size_t prefix_len, const uint8_t* data, size_t len);
+    bool start();
+    bool send(const uint8_t* data, size_t len);
+    bool wait(uint32_t flag);
+
+    I2C_HandleTypeDef& hi2c;
+    uint8_t address;
+    TickType_t timeout;
+    size_t dma_threshold;
+
+    uint8_t buffer[pages][width] = {};
+    uint8_t dirty_lo[pages] = {};            ///< first dirty column
+    uint8_t dirty_hi[pages] = {};            ///< past the last dirty column, the range is empty if not above lo
+    Point cursor = {};
+    bool compare_enabled = true;
+
+    volatile bool dma_failed = false;
+    Stats statistics = {};
+    StaticSemaphore_t done_sem_buffer = {};
+    SemaphoreHandle_t done_sem = nullptr;
+};
+
+#endif // PROJECT_DRIVERS_OLED_HPP
@@ -0,0 +1,219 @@
+#include "drivers/periodic.hpp"
+
+using namespace Project::drivers;
+
+static PeriodicScheduler* instance = nullptr;
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        auto t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+PeriodicScheduler* PeriodicScheduler::get(const TIM_HandleTypeDef* htim) {
+    return instance and &instance->htim == htim ? instance : nullptr;
+}
+
+bool PeriodicScheduler::init() {
+    task = xTaskCreateStatic(task_function, "periodic", stack_size, this, priority, stack, &task_buffer);
+    if (task == nullptr) {
+        return false;
+    }
+
+    instance = this;
+    __HAL_TIM_SET_COUNTER(&htim, 0);
+    return HAL_TIM_Base_Start_IT(&htim) == HAL_OK;
+}
+
+int PeriodicScheduler::add(const Message& msg) {
+    if (msg.period == 0 or msg.producer == nullptr or (msg.offset != auto_offset and msg.offset >= msg.period)) {
+        return -1;
+    }
+    if ((msg.bus == Bus::CAN and can == nullptr) or (msg.bus == Bus::UART and uart == nullptr)) {
+        return -1;
+    }
+
+    // the search only reads messages that are already published, so it runs with
+    // interrupts enabled
+    auto offset = msg.offset == auto_offset ? pick_offset(msg.period) : msg.offset;
+
+    taskENTER_CRITICAL();
+    int index = -1;
+    if (n_slots < max_messages) {
+        index = n_slots;
+
+        auto& slot = slots[index];
+        slot = {};
+        slot.msg = msg;
+        slot.msg.offset = offset;
+
+        // first instant after now that lies on the message phase
+        uint32_t now = now_ms;
+        uint32_t wait = (slot.msg.offset + msg.period - now % msg.period) % msg.period;
+        slot.next_due = now + (wait == 0 ? msg.period : wait);
+
+        if (n_slots == 0 or int32_t(slot.next_due - next_event) < 0) {
+            next_event = slot.next_due;
+        }
+        n_slots = n_slots + 1;
+    }
+    taskEXIT_CRITICAL();
+    return index;
+}
+
+uint16_t PeriodicScheduler::pick_offset(uint16_t period) const {
+    // two messages with periods p and q and offsets a and b become due on the same tick once
+    // every lcm(p, q) ms when a and b are congruent modulo gcd(p, q), so the offset with the
+    // smallest total collision rate spreads the load evenly over the ticks
+    uint16_t best = 0;
+    uint32_t best_cost = UINT32_MAX;
+    for (uint32_t offset = 0; offset < period and best_cost != 0; ++offset) {
+        uint32_t cost = 0;
+        for (size_t i = 0; i < n_slots; ++i) {
+            auto& other = slots[i].msg;
+            auto g = gcd(period, other.period);
+            if (offset % g == other.offset % g) {
+                cost += 1'000'000 / (uint32_t(period / g) * other.period);
+            }
+        }
+        if (cost < best_cost) {
+            best_cost = cost;
+            best = offset;
+        }
+    }
+    return best;
+}
+
+PeriodicScheduler::Stats PeriodicScheduler::stats(int index) const {
+    taskENTER_CRITICAL();
+    auto res = slots[index].stats;
+    taskEXIT_CRITICAL();
+    return res;
+}
+
+void PeriodicScheduler::reset_stats() {
+    taskENTER_CRITICAL();
+    for (size_t i = 0; i < n_slots; ++i) {
+        slots[i].stats = {};
+    }
+    taskEXIT_CRITICAL();
+}
+
+uint32_t PeriodicScheduler::now_us() const {
+    // the millisecond count and the counter are read again if the timer overflowed in between
+    uint32_t ms, us;
+    do {
+        ms = now_ms;
+        us = __HAL_TIM_GET_COUNTER(&htim);
+    } while (ms != now_ms);
+    return ms * 1000 + us;
+}
+
+void PeriodicScheduler::tick_isr() {
+    if (not __HAL_TIM_GET_FLAG(&htim, TIM_FLAG_UPDATE) or not __HAL_TIM_GET_IT_SOURCE(&htim, TIM_IT_UPDATE)) {
+        return;
+    }
+    __HAL_TIM_CLEAR_IT(&htim, TIM_IT_UPDATE);
+
+    uint32_t now = now_ms + 1;
+    now_ms = now;
+    if (n_slots == 0 or int32_t(now - next_event) < 0) {
+        return;
+    }
+
+    uint32_t due = pending;
+    uint32_t earliest = now + UINT16_MAX;
+    for (size_t i = 0; i < n_slots; ++i) {
+        auto& slot = slots[i];
+        if (int32_t(now - slot.next_due) >= 0) {
+            if (due & (1u << i)) {
+                slot.stats.missed++;
+            }
+            due |= 1u << i;
+            slot.due = slot.next_due;
+            slot.next_due += slot.msg.period;
+        }
+        if (int32_t(slot.next_due - earliest) < 0) {
+            earliest = slot.next_due;
+        }
+    }
+    next_event = earliest;
+
+    if (due != pending) {
+        pending = due;
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+void PeriodicScheduler::task_function(void* self) {
+    static_cast<PeriodicScheduler*>(self)->run();
+}
+
+void PeriodicScheduler::run() {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // lower indices first, a message that becomes due again while the others are
+        // being sent is picked up on the next pass
+        for (;;) {
+            taskENTER_CRITICAL();
+            uint32_t due = pending;
+            size_t index = due ? __builtin_ctz(due) : 0;
+            pending = due & (due - 1);
+            taskEXIT_CRITICAL();
+
+            if (due == 0) {
+                break;
+            }
+            transmit(slots[index]);
+        }
+    }
+}
+
+void PeriodicScheduler::transmit(Slot& slot) {
+    uint32_t jitter = now_us() - slot.due * 1000;
+
+    // neither transmitter is waited on for room, a full queue drops the message so that one
+    // slow bus cannot hold back the others; a UART write still waits for its own bytes, which
+    // are borrowed from this stack, and for the at most queue_size - 1 writes ahead of them
+    auto& msg = slot.msg;
+    size_t len = 0;
+    bool ok = false;
+    if (msg.bus == Bus::CAN) {
+        CANTransmitter::Message frame = {.id=msg.id, .extended=msg.extended};
+        len = msg.producer(frame.data, sizeof(frame.data), msg.arg);
+        frame.len = len;
+        // a frame still queued when the next one is produced is stale
+        ok = len > 0 and len <= sizeof(frame.data) and can->send(frame, pdMS_TO_TICKS(msg.period));
+    } else {
+        uint8_t buf[max_payload];
+        len = msg.producer(buf, sizeof(buf), msg.arg);
+        ok = len > 0 and len <= sizeof(buf) and uart->write(buf, len, 0);
+    }
+
+    taskENTER_CRITICAL();
+    auto& stats = slot.stats;
+    if (ok) {
+        stats.sent++;
+    } else if (len > 0) {
+        stats.dropped++;
+    } else {
+        stats.skipped++;
+    }
+    if (jitter > stats.jitter_max) {
+        stats.jitter_max = jitter;
+    }
+    stats.jitter_avg = stats.sent + stats.skipped + stats.dropped == 1 ? jitter : (stats.jitter_avg * 7 + jitter) / 8;
+    taskEXIT_CRITICAL();
+}
+
+extern "C" void TIM_Scheduler_IRQHandler(TIM_HandleTypeDef* htim) {
+    if (auto scheduler = PeriodicScheduler::get(htim)) {
+        scheduler->tick_isr();
+    }
+}
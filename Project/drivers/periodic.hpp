@@ -0,0 +1,119 @@
+#ifndef PROJECT_DRIVERS_PERIODIC_HPP
+#define PROJECT_DRIVERS_PERIODIC_HPP
+
+#include "tim.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "drivers/can_tx.hpp"
+#include "drivers/uart_tx.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace Project::drivers {
+    class PeriodicScheduler;
+}
+
+/// Cyclic message scheduler.
+/// A hardware timer ticks every millisecond and marks the messages of the table that are due.
+/// One task then pulls each payload from its producer callback and sends it over CAN or UART,
+/// so any number of periodic transmissions share a single stack instead of one sleeping task
+/// each. Messages get a phase offset inside their period, picked automatically to keep
+/// messages from becoming due on the same tick, and the release jitter of every message is
+/// measured against the timer. A CAN frame is sent with its period as deadline, so a frame
+/// the bus did not take in time is dropped by the transmitter rather than sent late.
+/// @note the timer must count at 1 MHz and overflow every millisecond
+class Project::drivers::PeriodicScheduler {
+public:
+    static constexpr size_t max_messages = 8;
+    static constexpr size_t max_payload = 64;
+    static constexpr uint16_t auto_offset = 0xFFFF;
+
+    /// fill buf with the payload of this period
+    /// @note runs in the scheduler task
+    /// @return payload length, 0 to skip this period
+    using Producer = size_t(*)(uint8_t* buf, size_t size, void* arg);
+
+    enum class Bus : uint8_t { CAN, UART };
+
+    struct Message {
+        Bus bus;
+        uint32_t id = 0;                ///< CAN identifier
+        bool extended = false;
+        uint16_t period;                ///< ms
+        uint16_t offset = auto_offset;  ///< ms after the start of the period
+        Producer producer;
+        void* arg = nullptr;
+    };
+
+    struct Stats {
+        uint32_t sent;
+        uint32_t skipped;    ///< producer returned nothing
+        uint32_t dropped;    ///< the transmitter had no room, the task does not wait for one
+        uint32_t missed;     ///< the message became due again before it was sent
+        uint32_t jitter_max; ///< us between the due time and the producer call
+        uint32_t jitter_avg; ///< us, moving average over the last 8 periods
+    };
+
+    struct Config {
+        TIM_HandleTypeDef& htim;
+        CANTransmitter* can = nullptr;
+        UARTTransmitter* uart = nullptr;
+        UBaseType_t priority = configMAX_PRIORITIES - 2;
+    };
+
+    explicit PeriodicScheduler(Config config) : htim(config.htim), can(config.can), uart(config.uart), priority(config.priority) {}
+
+    bool init();
+
+    /// add a message to the table
+    /// @note safe to call while the scheduler is running
+    /// @return message index, -1 if the table is full or the message is invalid
+    int add(const Message& msg);
+
+    /// offset that was assigned to a message
+    uint16_t offset(int index) const { return slots[index].msg.offset; }
+
+    /// transmission statistics of a message
+    Stats stats(int index) const;
+    void reset_stats();
+
+    /// microseconds since the scheduler was started
+    uint32_t now_us() const;
+
+    /// called from TIM_Scheduler_IRQHandler before HAL_TIM_IRQHandler
+    void tick_isr();
+
+    /// find the scheduler of a timer handle
+    static PeriodicScheduler* get(const TIM_HandleTypeDef* htim);
+
+private:
+    static constexpr size_t stack_size = 192;
+
+    struct Slot {
+        Message msg;
+        uint32_t next_due; ///< ms
+        uint32_t due;      ///< ms, release time of the pending transmission
+        Stats stats;
+    };
+
+    static void task_function(void* self);
+    void run();
+    void transmit(Slot& slot);
+    uint16_t pick_offset(uint16_t period) const;
+
+    TIM_HandleTypeDef& htim;
+    CANTransmitter* can;
+    UARTTransmitter* uart;
+    UBaseType_t priority;
+
+    Slot slots[max_messages] = {};
+    volatile size_t n_slots = 0;
+    volatile uint32_t now_ms = 0;
+    volatile uint32_t next_event = 0; ///< earliest next_due of the table
+    volatile uint32_t pending = 0;    ///< one bit per due message
+    TaskHandle_t task = nullptr;
+    StaticTask_t task_buffer = {};
+    StackType_t stack[stack_size] = {};
+};
+
+#endif // PROJECT_DRIVERS_PERIODIC_HPP
@@ -0,0 +1,207 @@
+#include "drivers/uart_stream.hpp"
+#include "task.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace Project::drivers;
+
+static UARTStream* instances[2] = {};
+
+UARTStream* UARTStream::get(const UART_HandleTypeDef* huart) {
+    for (auto stream : instances) {
+        if (stream and &stream->huart == huart) {
+            return stream;
+        }
+    }
+    return nullptr;
+}
+
+static void dma_event_callback(DMA_HandleTypeDef* hdma) {
+    if (auto stream = UARTStream::get(static_cast<UART_HandleTypeDef*>(hdma->Parent))) {
+        stream->rx_event_isr();
+    }
+}
+
+void UARTStream::init() {
+    if (rx_sem == nullptr) {
+        rx_sem = xSemaphoreCreateBinaryStatic(&rx_sem_buffer);
+        tx_sem = xSemaphoreCreateBinaryStatic(&tx_sem_buffer);
+    }
+
+    HAL_UART_AbortReceive(&huart);
+    if (baudrate != 0) {
+        huart.Init.BaudRate = baudrate;
+        HAL_UART_Init(&huart);
+    }
+
+    // the RX channel is generated in normal mode, switch it to circular
+    auto hdma = huart.hdmarx;
+    hdma->Init.Mode = DMA_CIRCULAR;
+    HAL_DMA_Init(hdma);
+    hdma->XferHalfCpltCallback = dma_event_callback;
+    hdma->XferCpltCallback = dma_event_callback;
+    hdma->XferErrorCallback = nullptr;
+    hdma->XferAbortCallback = nullptr;
+
+    for (auto& slot : instances) {
+        if (slot == nullptr or slot == this) {
+            slot = this;
+            break;
+        }
+    }
+
+    rx_dma_pos = 0;
+    rx_write = 0;
+    rx_read = 0;
+    rx_idle = 0;
+    HAL_DMA_Start_IT(hdma, reinterpret_cast<uint32_t>(&huart.Instance->DR), reinterpret_cast<uint32_t>(rx_buffer), rx_buffer_size);
+
+    __HAL_UART_CLEAR_IDLEFLAG(&huart);
+    __HAL_UART_ENABLE_IT(&huart, UART_IT_IDLE);
+    SET_BIT(huart.Instance->CR3, USART_CR3_DMAR);
+}
+
+void UARTStream::deinit() {
+    __HAL_UART_DISABLE_IT(&huart, UART_IT_IDLE);
+    CLEAR_BIT(huart.Instance->CR1, USART_CR1_TXEIE | USART_CR1_TCIE);
+    CLEAR_BIT(huart.Instance->CR3, USART_CR3_DMAR);
+    HAL_DMA_Abort(huart.hdmarx);
+
+    for (auto& slot : instances) {
+        if (slot == this) {
+            slot = nullptr;
+        }
+    }
+}
+
+size_t UARTStream::read(uint8_t* buf, size_t len, TickType_t timeout) {
+    while (rx_write == rx_read) {
+        if (xSemaphoreTake(rx_sem, timeout) != pdTRUE) {
+            return 0;
+        }
+    }
+    return copy(buf, len, rx_write);
+}
+
+size_t UARTStream::read_burst(uint8_t* buf, size_t len, TickType_t timeout) {
+    // the idle mark is behind the read position once everything up to it was read
+    while (ptrdiff_t(rx_idle - rx_read) <= 0) {
+        if (xSemaphoreTake(rx_sem, timeout) != pdTRUE) {
+            return 0;
+        }
+    }
+    return copy(buf, len, rx_idle);
+}
+
+size_t UARTStream::copy(uint8_t* buf, size_t len, size_t end) {
+    taskENTER_CRITICAL();
+    size_t write = rx_write;
+    size_t read = rx_read;
+    if (write - read > rx_buffer_size) {
+        // the DMA went around the ring before the consumer caught up
+        overrun_count = overrun_count + (write - read - rx_buffer_size);
+        read = write - rx_buffer_size;
+    }
+    taskEXIT_CRITICAL();
+
+    if (ptrdiff_t(end - read) <= 0) {
+        rx_read = read;
+        return 0;
+    }
+
+    size_t n = std::min(len, end - read);
+    size_t offset = read & (rx_buffer_size - 1);
+    size_t first = std::min(n, rx_buffer_size - offset);
+    ::memcpy(buf, &rx_buffer[offset], first);
+    ::memcpy(buf + first, &rx_buffer[0], n - first);
+    rx_read = read + n;
+    return n;
+}
+
+bool UARTStream::write(const uint8_t* data, size_t len, TickType_t timeout) {
+    if (len == 0) {
+        return true;
+    }
+
+    xSemaphoreTake(tx_sem, 0);
+    tx_data = data;
+    tx_len = len;
+    SET_BIT(huart.Instance->CR1, USART_CR1_TXEIE);
+
+    if (xSemaphoreTake(tx_sem, timeout) != pdTRUE) {
+        CLEAR_BIT(huart.Instance->CR1, USART_CR1_TXEIE | USART_CR1_TCIE);
+        tx_len = 0;
+        return false;
+    }
+    return true;
+}
+
+void UARTStream::rx_event_isr() {
+    if (not rx_update()) {
+        return;
+    }
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(rx_sem, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+bool UARTStream::rx_update() {
+    // half and full transfer interrupts guarantee this runs at least every half ring,
+    // so the distance from the previous position is never ambiguous
+    size_t pos = (rx_buffer_size - __HAL_DMA_GET_COUNTER(huart.hdmarx)) & (rx_buffer_size - 1);
+    size_t n = (pos - rx_dma_pos) & (rx_buffer_size - 1);
+    if (n == 0) {
+        return false;
+    }
+
+    rx_dma_pos = pos;
+    rx_write = rx_write + n;
+    return true;
+}
+
+void UARTStream::uart_irq_isr() {
+    // the flags are handled here and their interrupts disabled before HAL_UART_IRQHandler
+    // runs, so the HAL never sees a transfer it did not start
+    uint32_t sr = READ_REG(huart.Instance->SR);
+    uint32_t cr1 = READ_REG(huart.Instance->CR1);
+    BaseType_t woken = pdFALSE;
+
+    if ((sr & USART_SR_TXE) and (cr1 & USART_CR1_TXEIE)) {
+        if (tx_len > 0) {
+            auto data = tx_data;
+            huart.Instance->DR = *data;
+            tx_data = data + 1;
+            tx_len = tx_len - 1;
+        }
+        if (tx_len == 0) {
+            CLEAR_BIT(huart.Instance->CR1, USART_CR1_TXEIE);
+            SET_BIT(huart.Instance->CR1, USART_CR1_TCIE);
+        }
+    }
+
+    if ((sr & USART_SR_TC) and (cr1 & USART_CR1_TCIE)) {
+        CLEAR_BIT(huart.Instance->CR1, USART_CR1_TCIE);
+        xSemaphoreGiveFromISR(tx_sem, &woken);
+    }
+
+    if ((sr & USART_SR_IDLE) and (cr1 & USART_CR1_IDLEIE)) {
+        // reading SR then DR clears IDLE together with the error flags
+        (void) READ_REG(huart.Instance->DR);
+        if (sr & USART_SR_ORE) {
+            overrun_count = overrun_count + 1;
+        }
+        // the line went quiet after at least one byte, which ends a burst even if the DMA
+        // interrupts already published its bytes
+        rx_update();
+        rx_idle = rx_write;
+        xSemaphoreGiveFromISR(rx_sem, &woken);
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+
+extern "C" void UART_Stream_IRQHandler(UART_HandleTypeDef* huart) {
+    if (auto stream = UARTStream::get(huart)) {
+        stream->uart_irq_isr();
+    }
+}
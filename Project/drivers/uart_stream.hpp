@@ -0,0 +1,90 @@
+#ifndef PROJECT_DRIVERS_UART_STREAM_HPP
+#define PROJECT_DRIVERS_UART_STREAM_HPP
+
+#include "usart.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Project::drivers {
+    class UARTStream;
+}
+
+/// Streaming UART receiver.
+/// The RX DMA channel runs in circular mode over a ring buffer. Received bytes are
+/// published from the half-transfer, transfer-complete and IDLE-line interrupts, so a
+/// frame of any length reaches the consumer task without per-byte interrupts or re-arming.
+/// The position of the last IDLE line is kept as well, for protocols that delimit frames
+/// by silence on the line.
+/// Transmission is interrupt driven, for ports whose TX DMA channel is taken.
+/// @note the port must not be used for periph::UART reception while the stream is running
+class Project::drivers::UARTStream {
+public:
+    static constexpr size_t rx_buffer_size = 256;
+    static_assert((rx_buffer_size & (rx_buffer_size - 1)) == 0, "Buffer size must be a power of two");
+
+    struct Config {
+        UART_HandleTypeDef& huart;
+        uint32_t baudrate = 0; ///< reconfigure the port if not zero
+    };
+
+    explicit UARTStream(Config config) : huart(config.huart), baudrate(config.baudrate) {}
+
+    void init();
+    void deinit();
+
+    /// wait until bytes are available and copy up to len of them into buf
+    /// @note single consumer, meant to be called from an etl::async task
+    /// @return number of bytes copied, 0 on timeout
+    size_t read(uint8_t* buf, size_t len, TickType_t timeout = portMAX_DELAY);
+
+    /// wait until the line goes idle after some bytes and copy up to len of them into buf
+    /// @note bursts the consumer did not get to in time are returned together
+    /// @return number of bytes copied, 0 on timeout
+    size_t read_burst(uint8_t* buf, size_t len, TickType_t timeout = portMAX_DELAY);
+
+    /// send len bytes from the TXE interrupt and wait until the last stop bit is out
+    /// @note single producer, meant to be called from an etl::async task
+    /// @return false on timeout
+    bool write(const uint8_t* data, size_t len, TickType_t timeout = portMAX_DELAY);
+
+    /// number of received bytes not yet read
+    size_t available() const { return rx_write - rx_read; }
+
+    /// number of bytes lost, either overwritten before the consumer read them or
+    /// dropped by the USART overrun flag
+    uint32_t overrun() const { return overrun_count; }
+
+    /// called from the DMA half/full transfer callbacks and the USART IDLE interrupt
+    void rx_event_isr();
+
+    /// called from UART_Stream_IRQHandler before HAL_UART_IRQHandler
+    void uart_irq_isr();
+
+    /// find the running stream of a UART handle
+    static UARTStream* get(const UART_HandleTypeDef* huart);
+
+private:
+    bool rx_update();
+    size_t copy(uint8_t* buf, size_t len, size_t end);
+
+    UART_HandleTypeDef& huart;
+    uint32_t baudrate;
+
+    uint8_t rx_buffer[rx_buffer_size] = {};
+    size_t rx_dma_pos = 0;        ///< last observed DMA write position
+    volatile size_t rx_write = 0; ///< total bytes written by the DMA
+    volatile size_t rx_read = 0;  ///< total bytes read by the consumer
+    volatile size_t rx_idle = 0;  ///< rx_write at the last IDLE line
+    volatile uint32_t overrun_count = 0;
+    StaticSemaphore_t rx_sem_buffer = {};
+    SemaphoreHandle_t rx_sem = nullptr;
+
+    const uint8_t* volatile tx_data = nullptr;
+    volatile size_t tx_len = 0;   ///< bytes left to hand to the data register
+    StaticSemaphore_t tx_sem_buffer = {};
+    SemaphoreHandle_t tx_sem = nullptr;
+};
+
+#endif // PROJECT_DRIVERS_UART_STREAM_HPP
@@ -0,0 +1,131 @@
+#include "drivers/uart_tx.hpp"
+#include "task.h"
+
+using namespace Project::drivers;
+
+static UARTTransmitter* instances[2] = {};
+
+UARTTransmitter* UARTTransmitter::get(const UART_HandleTypeDef* huart) {
+    for (auto tx : instances) {
+        if (tx and &tx->huart == huart) {
+            return tx;
+        }
+    }
+    return nullptr;
+}
+
+static void dma_complete_callback(DMA_HandleTypeDef* hdma) {
+    if (auto tx = UARTTransmitter::get(static_cast<UART_HandleTypeDef*>(hdma->Parent))) {
+        tx->tx_complete_isr();
+    }
+}
+
+static void dma_error_callback(DMA_HandleTypeDef* hdma) {
+    if (auto tx = UARTTransmitter::get(static_cast<UART_HandleTypeDef*>(hdma->Parent))) {
+        tx->tx_complete_isr(true);
+    }
+}
+
+void UARTTransmitter::init() {
+    if (free_slots == nullptr) {
+        free_slots = xSemaphoreCreateCountingStatic(queue_size, queue_size, &free_slots_buffer);
+        for (auto& slot : slots) {
+            slot.done = xSemaphoreCreateBinaryStatic(&slot.done_buffer);
+        }
+    }
+
+    huart.hdmatx->XferCpltCallback = dma_complete_callback;
+    huart.hdmatx->XferHalfCpltCallback = nullptr;
+    huart.hdmatx->XferErrorCallback = dma_error_callback;
+
+    for (auto& slot : instances) {
+        if (slot == nullptr or slot == this) {
+            slot = this;
+            break;
+        }
+    }
+}
+
+bool UARTTransmitter::write(std::initializer_list<Segment> segments, TickType_t timeout) {
+    if (segments.size() == 0 or segments.size() > max_segments) {
+        return false;
+    }
+
+    size_t count = 0;
+    for (auto& segment : segments) {
+        if (segment.len > 0xFFFF) {
+            return false; // beyond the DMA counter
+        }
+        count += segment.len > 0;
+    }
+    if (count == 0) {
+        return true;
+    }
+
+    if (xSemaphoreTake(free_slots, timeout) != pdTRUE) {
+        return false;
+    }
+
+    // a slot stays taken until its writer has seen the completion, so every semaphore has
+    // one waiter; writers may return out of order, the DMA order is kept apart
+    taskENTER_CRITICAL();
+    size_t index = 0;
+    while (slots[index].used) {
+        ++index;
+    }
+    auto& slot = slots[index];
+    slot.used = true;
+    slot.failed = false;
+    slot.count = 0;
+    for (auto& segment : segments) {
+        if (segment.len > 0) {
+            slot.segments[slot.count++] = segment;
+        }
+    }
+    order[head % queue_size] = uint8_t(index);
+    head = head + 1;
+    if (not busy) {
+        segment_index = 0;
+        start_segment();
+    }
+    taskEXIT_CRITICAL();
+
+    // the segments are borrowed from the caller, so it has to wait for the DMA
+    // regardless of the slot timeout
+    xSemaphoreTake(slot.done, portMAX_DELAY);
+    bool ok = not slot.failed;
+
+    taskENTER_CRITICAL();
+    slot.used = false;
+    taskEXIT_CRITICAL();
+    xSemaphoreGive(free_slots);
+    return ok;
+}
+
+void UARTTransmitter::start_segment() {
+    auto& segment = slots[order[tail % queue_size]].segments[segment_index];
+    busy = true;
+    HAL_DMA_Start_IT(huart.hdmatx, reinterpret_cast<uint32_t>(segment.data), reinterpret_cast<uint32_t>(&huart.Instance->DR), segment.len);
+    SET_BIT(huart.Instance->CR3, USART_CR3_DMAT);
+}
+
+void UARTTransmitter::tx_complete_isr(bool failed) {
+    auto& slot = slots[order[tail % queue_size]];
+    // the rest of a failed write is dropped, the next one starts clean
+    if (not failed and ++segment_index < slot.count) {
+        start_segment();
+        return;
+    }
+
+    tail = tail + 1;
+    segment_index = 0;
+    busy = false;
+    slot.failed = failed;
+
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(slot.done, &woken);
+    if (tail != head) {
+        start_segment();
+    }
+    portYIELD_FROM_ISR(woken);
+}
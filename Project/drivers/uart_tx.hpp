@@ -0,0 +1,78 @@
+#ifndef PROJECT_DRIVERS_UART_TX_HPP
+#define PROJECT_DRIVERS_UART_TX_HPP
+
+#include "usart.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace Project::drivers {
+    class UARTTransmitter;
+}
+
+/// DMA UART transmit queue.
+/// A write is a list of (pointer, length) segments, e.g. header, payload and CRC, that are
+/// chained through the TX DMA channel from the transfer-complete interrupt without being
+/// concatenated first. Writes from several tasks are queued and sent in order.
+/// @note the UART handle must have a TX DMA channel linked
+class Project::drivers::UARTTransmitter {
+public:
+    static constexpr size_t queue_size = 4;
+    static constexpr size_t max_segments = 4;
+
+    struct Segment {
+        const void* data;
+        size_t len;
+    };
+
+    struct Config {
+        UART_HandleTypeDef& huart;
+    };
+
+    explicit UARTTransmitter(Config config) : huart(config.huart) {}
+
+    void init();
+
+    /// queue the segments and wait until the DMA has moved the last byte into the USART
+    /// @note the segments must stay valid until the function returns; meant to be called
+    /// from an etl::async task
+    /// @return false if the list is invalid, no queue slot is freed within timeout or the DMA
+    /// reported a transfer error
+    bool write(std::initializer_list<Segment> segments, TickType_t timeout = portMAX_DELAY);
+    bool write(const void* data, size_t len, TickType_t timeout = portMAX_DELAY) {
+        return write({Segment{data, len}}, timeout);
+    }
+
+    /// called from the TX DMA transfer complete and error callbacks
+    void tx_complete_isr(bool failed = false);
+
+    /// find the transmitter of a UART handle
+    static UARTTransmitter* get(const UART_HandleTypeDef* huart);
+
+private:
+    struct Slot {
+        Segment segments[max_segments];
+        size_t count;
+        bool used;                     ///< taken by a writer that has not returned yet
+        bool failed;
+        StaticSemaphore_t done_buffer;
+        SemaphoreHandle_t done;        ///< given once the DMA is through with the segments
+    };
+
+    void start_segment();
+
+    UART_HandleTypeDef& huart;
+
+    Slot slots[queue_size] = {};
+    uint8_t order[queue_size] = {}; ///< slots in transmission order
+    volatile size_t head = 0;       ///< total writes queued
+    volatile size_t tail = 0;       ///< total writes completed
+    size_t segment_index = 0;
+    volatile bool busy = false;
+    StaticSemaphore_t free_slots_buffer = {};
+    SemaphoreHandle_t free_slots = nullptr;
+};
+
+#endif // PROJECT_DRIVERS_UART_TX_HPP
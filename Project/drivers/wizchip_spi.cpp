@@ -0,0 +1,221 @@
+#include "drivers/wizchip_spi.hpp"
+#include "wizchip_conf.h"
+#include "task.h"
+#include <cstring>
+
+using namespace Project::drivers;
+
+static WizchipSPI* instance = nullptr;
+static const uint8_t dummy = 0;
+
+static bool scheduler_running() {
+    return xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+static void dma_callback(DMA_HandleTypeDef*) {
+    if (instance) {
+        instance->dma_complete_isr();
+    }
+}
+
+static void dma_error_callback(DMA_HandleTypeDef*) {
+    if (instance) {
+        instance->dma_error_isr();
+    }
+}
+
+/// program a channel directly, the HAL start functions refuse a channel whose previous
+/// transfer completed without an interrupt
+static void arm(DMA_HandleTypeDef* hdma, volatile uint32_t* periph, const void* mem, size_t len, bool increment, bool irq) {
+    auto channel = hdma->Instance;
+    CLEAR_BIT(channel->CCR, DMA_CCR_EN);
+    hdma->DmaBaseAddress->IFCR = DMA_ISR_GIF1 << hdma->ChannelIndex;
+    MODIFY_REG(channel->CCR, DMA_CCR_MINC | DMA_CCR_TCIE | DMA_CCR_HTIE | DMA_CCR_TEIE,
+        (increment ? DMA_CCR_MINC : 0) | (irq ? DMA_CCR_TCIE | DMA_CCR_TEIE : 0));
+    channel->CNDTR = len;
+    channel->CPAR = uint32_t(reinterpret_cast<uintptr_t>(periph));
+    channel->CMAR = uint32_t(reinterpret_cast<uintptr_t>(mem));
+    SET_BIT(channel->CCR, DMA_CCR_EN);
+}
+
+void WizchipSPI::init() {
+    if (done_sem == nullptr) {
+        done_sem = xSemaphoreCreateBinaryStatic(&done_sem_buffer);
+        bus_mutex = xSemaphoreCreateMutexStatic(&bus_mutex_buffer);
+    }
+
+    // only the RX channel interrupts, it finishes last
+    hspi.hdmarx->XferCpltCallback = dma_callback;
+    hspi.hdmarx->XferErrorCallback = dma_error_callback;
+    hspi.hdmarx->XferHalfCpltCallback = nullptr;
+    hspi.hdmarx->XferAbortCallback = nullptr;
+    __HAL_SPI_ENABLE(&hspi);
+
+    instance = this;
+    reg_wizchip_cris_cbfunc([] { instance->lock(); }, [] { instance->unlock(); });
+    reg_wizchip_cs_cbfunc([] { instance->select(); }, [] { instance->deselect(); });
+    reg_wizchip_spi_cbfunc(
+        [] { uint8_t byte; instance->read(&byte, 1); return byte; },
+        [](uint8_t byte) { instance->write(&byte, 1); });
+    reg_wizchip_spiburst_cbfunc(
+        [](uint8_t* buf, uint16_t len) { instance->read(buf, len); },
+        [](uint8_t* buf, uint16_t len) { instance->write_burst(buf, len); });
+}
+
+void WizchipSPI::lock() {
+    if (scheduler_running()) {
+        xSemaphoreTake(bus_mutex, portMAX_DELAY);
+    }
+}
+
+void WizchipSPI::unlock() {
+    if (scheduler_running()) {
+        xSemaphoreGive(bus_mutex);
+    }
+}
+
+void WizchipSPI::select() {
+    address_len = 0;
+    fresh = true;
+    HAL_GPIO_WritePin(cs_port, cs_pin, GPIO_PIN_RESET);
+}
+
+void WizchipSPI::deselect() {
+    if (address_len > 0) {
+        HAL_SPI_Transmit(&hspi, address, address_len, HAL_MAX_DELAY);
+        address_len = 0;
+    }
+    HAL_GPIO_WritePin(cs_port, cs_pin, GPIO_PIN_SET);
+}
+
+void WizchipSPI::write_burst(uint8_t* buf, uint16_t len) {
+    // the io library starts every access with the address phase as a burst of its own
+    if (fresh and len == address_size) {
+        ::memcpy(address, buf, address_size);
+        address_len = address_size;
+        fresh = false;
+        return;
+    }
+    write(buf, len);
+}
+
+void WizchipSPI::write(const uint8_t* data, size_t len) {
+    fresh = false;
+    // only a transfer that follows its address can be started over, see transfer_dma
+    if (len >= dma_threshold and address_len > 0 and scheduler_running()) {
+        return transfer_dma(data, nullptr, len);
+    }
+    write_polled(data, len);
+}
+
+void WizchipSPI::write_polled(const uint8_t* data, size_t len) {
+    statistics.polled++;
+    if (address_len + len <= merge_size) {
+        uint8_t buf[merge_size];
+        ::memcpy(buf, address, address_len);
+        ::memcpy(buf + address_len, data, len);
+        HAL_SPI_Transmit(&hspi, buf, address_len + len, HAL_MAX_DELAY);
+    } else {
+        if (address_len > 0) {
+            HAL_SPI_Transmit(&hspi, address, address_len, HAL_MAX_DELAY);
+        }
+        HAL_SPI_Transmit(&hspi, const_cast<uint8_t*>(data), len, HAL_MAX_DELAY);
+    }
+    address_len = 0;
+}
+
+void WizchipSPI::read(uint8_t* data, size_t len) {
+    fresh = false;
+    if (len >= dma_threshold and address_len > 0 and scheduler_running()) {
+        return transfer_dma(nullptr, data, len);
+    }
+    read_polled(data, len);
+}
+
+void WizchipSPI::read_polled(uint8_t* data, size_t len) {
+    statistics.polled++;
+    if (address_len + len <= merge_size) {
+        // the bytes clocked in during the address phase are dropped
+        uint8_t buf[merge_size] = {};
+        ::memcpy(buf, address, address_len);
+        HAL_SPI_TransmitReceive(&hspi, buf, buf, address_len + len, HAL_MAX_DELAY);
+        ::memcpy(data, buf + address_len, len);
+    } else {
+        if (address_len > 0) {
+            HAL_SPI_Transmit(&hspi, address, address_len, HAL_MAX_DELAY);
+        }
+        HAL_SPI_Receive(&hspi, data, len, HAL_MAX_DELAY);
+    }
+    address_len = 0;
+}
+
+void WizchipSPI::transfer_dma(const uint8_t* tx, uint8_t* rx, size_t len) {
+    dma_tx = tx;
+    dma_rx = rx;
+    dma_len = len;
+    dma_address = address_len > 0;
+    dma_failed = false;
+    address_len = 0;
+
+    // a polled transmit leaves the receive side overrun
+    __HAL_SPI_CLEAR_OVRFLAG(&hspi);
+    xSemaphoreTake(done_sem, 0);
+    start_segment();
+    SET_BIT(hspi.Instance->CR2, SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+
+    bool done = xSemaphoreTake(done_sem, timeout) == pdTRUE and not dma_failed;
+    CLEAR_BIT(hspi.hdmarx->Instance->CCR, DMA_CCR_EN);
+    CLEAR_BIT(hspi.hdmatx->Instance->CCR, DMA_CCR_EN);
+    CLEAR_BIT(hspi.Instance->CR2, SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+    while (__HAL_SPI_GET_FLAG(&hspi, SPI_FLAG_BSY)) {}
+
+    if (done) {
+        statistics.dma++;
+        return;
+    }
+
+    // the transfer stopped somewhere in the data; socket buffer memory reads and writes have
+    // no side effects, so the access starts over from its address under a new chip select,
+    // polled this time
+    statistics.errors++;
+    __HAL_SPI_CLEAR_OVRFLAG(&hspi);
+    HAL_GPIO_WritePin(cs_port, cs_pin, GPIO_PIN_SET);
+    HAL_GPIO_WritePin(cs_port, cs_pin, GPIO_PIN_RESET);
+    address_len = address_size;
+    if (tx) {
+        write_polled(tx, len);
+    } else {
+        read_polled(rx, len);
+    }
+}
+
+void WizchipSPI::start_segment() {
+    auto dr = &hspi.Instance->DR;
+    // the receive channel is armed first so no byte is missed once the transmit side starts
+    if (dma_address) {
+        arm(hspi.hdmarx, dr, &scratch, address_size, false, true);
+        arm(hspi.hdmatx, dr, address, address_size, true, false);
+    } else {
+        arm(hspi.hdmarx, dr, dma_rx ? dma_rx : &scratch, dma_len, dma_rx != nullptr, true);
+        arm(hspi.hdmatx, dr, dma_tx ? dma_tx : &dummy, dma_len, dma_tx != nullptr, false);
+    }
+}
+
+void WizchipSPI::dma_complete_isr() {
+    // the address went out, the data follows under the same chip select
+    if (dma_address) {
+        dma_address = false;
+        start_segment();
+        return;
+    }
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(done_sem, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void WizchipSPI::dma_error_isr() {
+    dma_failed = true;
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(done_sem, &woken);
+    portYIELD_FROM_ISR(woken);
+}
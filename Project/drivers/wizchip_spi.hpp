@@ -0,0 +1,97 @@
+#ifndef PROJECT_DRIVERS_WIZCHIP_SPI_HPP
+#define PROJECT_DRIVERS_WIZCHIP_SPI_HPP
+
+#include "spi.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Project::drivers {
+    class WizchipSPI;
+}
+
+/// W5500 bus layer with DMA burst transfers.
+/// Replaces the SPI callbacks of the wizchip io library. Register accesses stay polled, while
+/// socket buffer reads and writes from the threshold up run on the SPI1 DMA channels and the
+/// calling task blocks until the transfer is done, instead of spinning on every byte.
+///
+/// The io library sends the 3-byte address and control phase as a burst of its own before the
+/// data. That burst is held back and goes out as the first part of the data transfer: merged
+/// into one polled transfer for short accesses, or as the first segment of the DMA transaction,
+/// which re-arms itself for the data from the completion interrupt without involving the task.
+/// A DMA transfer that fails or times out is redone polled, from the address on.
+/// The bus is guarded by a mutex registered as the io library critical section, so several
+/// tasks may use the chip and may block while holding it.
+/// @note call init() after the ethernet driver, which registers its own callbacks
+class Project::drivers::WizchipSPI {
+public:
+    static constexpr size_t address_size = 3;
+    static constexpr size_t merge_size = 32; ///< longest polled access sent in one piece
+
+    struct Config {
+        SPI_HandleTypeDef& hspi;
+        GPIO_TypeDef* cs_port;
+        uint16_t cs_pin;
+        size_t dma_threshold = 32;                 ///< shorter data is polled
+        TickType_t timeout = pdMS_TO_TICKS(10);
+    };
+
+    struct Stats {
+        uint32_t dma;      ///< transfers done by DMA
+        uint32_t polled;   ///< transfers done by polling
+        uint32_t errors;   ///< DMA transfers that failed or timed out, then redone polled
+    };
+
+    explicit WizchipSPI(Config config)
+        : hspi(config.hspi), cs_port(config.cs_port), cs_pin(config.cs_pin),
+          dma_threshold(config.dma_threshold), timeout(config.timeout) {}
+
+    /// register the bus callbacks with the io library
+    void init();
+
+    const Stats& stats() const { return statistics; }
+
+    /// called from the SPI1 RX DMA callbacks
+    void dma_complete_isr();
+    void dma_error_isr();
+
+private:
+    void lock();
+    void unlock();
+    void select();
+    void deselect();
+    void write_burst(uint8_t* buf, uint16_t len);
+    void write(const uint8_t* data, size_t len);
+    void read(uint8_t* data, size_t len);
+    void write_polled(const uint8_t* data, size_t len);
+    void read_polled(uint8_t* data, size_t len);
+    void transfer_dma(const uint8_t* tx, uint8_t* rx, size_t len);
+    void start_segment();
+
+    SPI_HandleTypeDef& hspi;
+    GPIO_TypeDef* cs_port;
+    uint16_t cs_pin;
+    size_t dma_threshold;
+    TickType_t timeout;
+
+    uint8_t address[address_size] = {};
+    size_t address_len = 0;     ///< address phase held back for the next transfer
+    bool fresh = false;         ///< nothing was sent since chip select
+
+    // state of the DMA transaction, read by the completion interrupt
+    const uint8_t* dma_tx = nullptr;
+    uint8_t* dma_rx = nullptr;
+    size_t dma_len = 0;
+    volatile bool dma_address = false;  ///< the address segment is still to complete
+    volatile bool dma_failed = false;
+    uint8_t scratch = 0;
+
+    Stats statistics = {};
+    StaticSemaphore_t done_sem_buffer = {};
+    SemaphoreHandle_t done_sem = nullptr;
+    StaticSemaphore_t bus_mutex_buffer = {};
+    SemaphoreHandle_t bus_mutex = nullptr;
+};
+
+#endif // PROJECT_DRIVERS_WIZCHIP_SPI_HPP
@@ -1,11 +1,13 @@
 #include "main.hpp"
+#include "utils/format.hpp"
 
 namespace Project {
     etl::Tasks tasks;
     etl::Mutex mutex;
-    etl::String<128> f;
 
-    Oled oled { .hi2c=hi2c2 };
+    // drawn and flushed by the compositor task, tasks write their own regions
+    drivers::Oled oled({ .hi2c=hi2c2 });
+    drivers::Compositor compositor({ .oled=oled });
     wizchip::Ethernet ethernet({
         .hspi=hspi1,
         .cs={.port=CS_GPIO_Port, .pin=CS_Pin},
@@ -34,8 +36,47 @@ namespace Project::periph {
     #endif
 }
 
+namespace Project::drivers {
+    #ifdef F103_MODBUS
+    UARTTransmitter uart2_tx({ .huart=huart2 });
+    #endif
+
+    #ifdef F103_USE_CAN
+    CANReceiver can_rx({ .hcan=hcan });
+    CANTransmitter can_tx({ .hcan=hcan });
+
+    // IDs 0x000..0x07F are high priority and go to FIFO1, everything else to FIFO0
+    static const CANReceiver::Filter can_filters[] = {
+        {.id=0x000, .mask=0x780, .extended=false, .fifo=CAN_FILTER_FIFO1},
+        {.id=0x000, .mask=0x000, .extended=false, .fifo=CAN_FILTER_FIFO0},
+        {.id=0x000, .mask=0x000, .extended=true,  .fifo=CAN_FILTER_FIFO0},
+    };
+    #endif
+
+    #ifdef F103_USE_USB
+    CDC cdc({ .husbd=hUsbDeviceFS });
+    #endif
+
+    #ifdef F103_USE_CAN
+    // CAN only, uart2 belongs to the Modbus master; the messages come from the can_status app
+    PeriodicScheduler periodic({
+        .htim=htim2,
+        .can=&can_tx,
+    });
+    #endif
+
+    // socket buffer bursts on DMA1 channels 2 and 3
+    WizchipSPI wizchip_spi({
+        .hspi=hspi1,
+        .cs_port=CS_GPIO_Port,
+        .cs_pin=CS_Pin,
+    });
+}
+
 using namespace Project;
 
+static drivers::Compositor::Region ethernet_log({ .row=1 });
+
 extern "C" void project_init() {
     HAL_Delay(50);
     periph::adc1.init();
@@ -47,16 +88,31 @@ extern "C" void project_init() {
 
     #ifdef F103_USE_CAN
     periph::can.init();
+    drivers::can_rx.init(drivers::can_filters);
+    drivers::can_tx.init();
+    #endif
+
+    #ifdef F103_MODBUS
+    drivers::uart2_tx.init();
+    #endif
+
+    #ifdef F103_USE_USB
+    drivers::cdc.init();
+    #endif
+
+    #ifdef F103_USE_CAN
+    drivers::periodic.init();
     #endif
 
     tasks.init();
     oled.init();
+    compositor.add(ethernet_log);
+    compositor.init();
     mutex.init();
     ethernet.init();
-    ethernet.logger.function = [](const char* str) { 
-        auto lock = mutex.lock().await();
-        oled.setCursor({0, 1});
-        oled << str;
+    drivers::wizchip_spi.init();
+    ethernet.logger.function = [](const char* str) {
+        ethernet_log.write(str);
     };
     
     App::run();
@@ -83,7 +139,8 @@ extern "C" void panic(const char* msg) {
         default: psc = 0;
     }
     auto restart_time = ((IWDG->RLR) * psc) / 32000;
-    oled << f("Restart in %d s\n", restart_time);
+    utils::fmt::write(oled, FMT("Restart in %u s\n"), restart_time);
+    oled.flush();
     
     for (;;);
 }
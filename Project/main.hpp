@@ -4,8 +4,15 @@
 #include "etl/async.h"
 #include "etl/mutex.h"
 #include "periph/all.h"
-#include "oled/oled.h"
 #include "wizchip/ethernet.h"
+#include "drivers/cdc.hpp"
+#include "drivers/oled.hpp"
+#include "drivers/compositor.hpp"
+#include "drivers/uart_tx.hpp"
+#include "drivers/can_rx.hpp"
+#include "drivers/can_tx.hpp"
+#include "drivers/periodic.hpp"
+#include "drivers/wizchip_spi.hpp"
 
 extern "C" {
     extern char blinkSymbols[16];
@@ -27,11 +34,29 @@ namespace Project::periph {
     #endif
 }
 
+namespace Project::drivers {
+    #ifdef F103_MODBUS
+    extern UARTTransmitter uart2_tx;
+    #endif
+
+    #ifdef F103_USE_CAN
+    extern CANReceiver can_rx;
+    extern CANTransmitter can_tx;
+    extern PeriodicScheduler periodic;
+    #endif
+
+    #ifdef F103_USE_USB
+    extern CDC cdc;
+    #endif
+
+    extern WizchipSPI wizchip_spi;
+}
+
 namespace Project {
     extern etl::Tasks tasks;
     extern etl::Mutex mutex;
-    extern etl::String<128> f;
-    extern Oled oled;
+    extern drivers::Oled oled;
+    extern drivers::Compositor compositor;
     extern wizchip::Ethernet ethernet;
     class App;
 }
@@ -0,0 +1,631 @@
+#include "net/http/client.hpp"
+#include "net/interrupt.hpp"
+#include "wizchip/ethernet.h"
+#include "socket.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace Project::net::http;
+
+using State = Client::Slot::State;
+
+namespace {
+    enum class Parse { Complete, Incomplete, Invalid };
+}
+
+static std::string_view trim(std::string_view str) {
+    while (not str.empty() and (str.front() == ' ' or str.front() == '\t')) str.remove_prefix(1);
+    while (not str.empty() and (str.back() == ' ' or str.back() == '\t')) str.remove_suffix(1);
+    return str;
+}
+
+static bool parse_number(std::string_view str, size_t max, size_t& res) {
+    if (str.empty() or str.size() > 9) {
+        return false;
+    }
+    res = 0;
+    for (char ch : str) {
+        if (ch < '0' or ch > '9') {
+            return false;
+        }
+        res = res * 10 + (ch - '0');
+    }
+    return res <= max;
+}
+
+static bool parse_hex(std::string_view str, size_t& res) {
+    if (str.empty() or str.size() > 6) {
+        return false;
+    }
+    res = 0;
+    for (char ch : str) {
+        int digit = ch >= '0' and ch <= '9' ? ch - '0' :
+                    ch >= 'a' and ch <= 'f' ? ch - 'a' + 10 :
+                    ch >= 'A' and ch <= 'F' ? ch - 'A' + 10 : -1;
+        if (digit < 0) {
+            return false;
+        }
+        res = res * 16 + digit;
+    }
+    return true;
+}
+
+/// "[http://]a.b.c.d[:port][/path]", there is no resolver
+static bool parse_url(std::string_view url, uint8_t* ip, uint16_t& port, std::string_view& path) {
+    if (url.substr(0, 7) == "http://") {
+        url.remove_prefix(7);
+    }
+    auto slash = url.find('/');
+    path = slash == std::string_view::npos ? std::string_view("/") : url.substr(slash);
+    auto host = url.substr(0, slash);
+
+    size_t value;
+    port = 80;
+    if (auto colon = host.find(':'); colon != std::string_view::npos) {
+        if (not parse_number(host.substr(colon + 1), 0xFFFF, value) or value == 0) {
+            return false;
+        }
+        port = value;
+        host = host.substr(0, colon);
+    }
+    for (int i = 0; i < 4; ++i) {
+        auto dot = host.find('.');
+        if ((i < 3) == (dot == std::string_view::npos)) {
+            return false;
+        }
+        if (not parse_number(host.substr(0, dot), 0xFF, value)) {
+            return false;
+        }
+        ip[i] = value;
+        host.remove_prefix(dot == std::string_view::npos ? host.size() : dot + 1);
+    }
+    return true;
+}
+
+/// walk a chunked body, moving the data of every chunk to the front if compact is set
+/// @param used bytes of the encoded body, trailer included
+/// @note compacting only overwrites bytes that were already walked, so it runs as a second
+/// pass once the body is known to be complete
+static Parse dechunk(char* buf, size_t len, bool compact, size_t& body_len, size_t& used) {
+    std::string_view data(buf, len);
+    size_t pos = 0;
+    body_len = 0;
+    for (;;) {
+        auto eol = data.find("\r\n", pos);
+        if (eol == std::string_view::npos) {
+            return Parse::Incomplete;
+        }
+        auto line = data.substr(pos, eol - pos);
+        size_t size;
+        if (not parse_hex(trim(line.substr(0, line.find(';'))), size)) {
+            return Parse::Invalid;
+        }
+        pos = eol + 2;
+        if (size == 0) {
+            break;
+        }
+        if (len - pos < size + 2) {
+            return Parse::Incomplete;
+        }
+        if (data.substr(pos + size, 2) != "\r\n") {
+            return Parse::Invalid;
+        }
+        if (compact) {
+            ::memmove(buf + body_len, buf + pos, size);
+        }
+        body_len += size;
+        pos += size + 2;
+    }
+
+    // trailer fields, up to an empty line
+    for (bool empty = false; not empty;) {
+        auto eol = data.find("\r\n", pos);
+        if (eol == std::string_view::npos) {
+            return Parse::Incomplete;
+        }
+        empty = eol == pos;
+        pos = eol + 2;
+    }
+    used = pos;
+    return Parse::Complete;
+}
+
+/// parse the response at the start of buf, the body is de-chunked in place
+/// @param eof the server closed the connection, which ends a body without framing
+static Parse parse(char* buf, size_t len, bool eof, bool head, Client::Response& res, bool& keep) {
+    res = {};
+    std::string_view data(buf, len);
+    auto header_end = data.find("\r\n\r\n");
+    if (header_end == std::string_view::npos) {
+        return Parse::Incomplete;
+    }
+    auto head_lines = data.substr(0, header_end + 2);
+
+    // status line, "HTTP/1.1 200 OK"
+    auto eol = head_lines.find("\r\n");
+    auto line = head_lines.substr(0, eol);
+    size_t status;
+    if (line.size() < 12 or line.substr(0, 7) != "HTTP/1." or line[8] != ' ' or
+        not parse_number(line.substr(9, 3), 999, status) or (line.size() > 12 and line[12] != ' ')) {
+        return Parse::Invalid;
+    }
+    auto version = line.substr(0, 8);
+    res.status = status;
+
+    // header fields, the framing ones are picked up even when the list is full
+    std::string_view connection, transfer_encoding, content_length;
+    for (auto rest = head_lines.substr(eol + 2); not rest.empty();) {
+        eol = rest.find("\r\n");
+        line = rest.substr(0, eol);
+        rest.remove_prefix(eol + 2);
+
+        auto colon = line.find(':');
+        if (colon == 0 or colon == std::string_view::npos) {
+            return Parse::Invalid;
+        }
+        Field field = {line.substr(0, colon), trim(line.substr(colon + 1))};
+        if (equals_ignore_case(field.name, "Connection")) {
+            connection = field.value;
+        } else if (equals_ignore_case(field.name, "Transfer-Encoding")) {
+            transfer_encoding = field.value;
+        } else if (equals_ignore_case(field.name, "Content-Length")) {
+            content_length = field.value;
+        }
+        res.headers.append(field);
+    }
+
+    keep = version == "HTTP/1.1" ? not equals_ignore_case(connection, "close") : equals_ignore_case(connection, "keep-alive");
+
+    char* body = buf + header_end + 4;
+    size_t available = len - (header_end + 4);
+    size_t body_len = 0;
+    size_t used = 0;
+    if (head or res.status == 204 or res.status == 304) {
+        // no body, whatever the headers say
+    } else if (not transfer_encoding.empty()) {
+        if (not equals_ignore_case(transfer_encoding, "chunked")) {
+            return Parse::Invalid;
+        }
+        if (auto result = dechunk(body, available, false, body_len, used); result != Parse::Complete) {
+            return result;
+        }
+        dechunk(body, available, true, body_len, used);
+    } else if (not content_length.empty()) {
+        if (not parse_number(content_length, SIZE_MAX, body_len)) {
+            return Parse::Invalid;
+        }
+        if (available < body_len) {
+            return Parse::Incomplete;
+        }
+        used = body_len;
+    } else {
+        // the body ends with the connection
+        if (not eof) {
+            return Parse::Incomplete;
+        }
+        body_len = used = available;
+        keep = false;
+    }
+
+    // bytes past the response were never asked for, the framing can't be trusted
+    if (used != available) {
+        keep = false;
+    }
+    res.body = {body, body_len};
+    return Parse::Complete;
+}
+
+Client::Client(Config config)
+    : first_socket(config.socket), slots(config.slots),
+      n_slots(config.n_slots < max_slots ? config.n_slots : max_slots),
+      keep_alive_timeout(config.keep_alive_timeout), priority(config.priority) {
+    events = xEventGroupCreateStatic(&events_buffer);
+    for (size_t i = 0; i < n_slots; ++i) {
+        auto& slot = slots[i];
+        slot.sn = first_socket + i;
+        slot.state = State::Free;
+        slot.open = false;
+        slot.sending = false;
+    }
+}
+
+Future Client::request(std::string_view method, std::string_view url, const Options& options) {
+    uint8_t ip[4];
+    uint16_t port;
+    std::string_view path;
+    if (not parse_url(url, ip, port, path)) {
+        return {this, nullptr, Error::InvalidUrl};
+    }
+
+    // a pooled connection to the same host saves the handshake, a socket without a
+    // connection comes next so the pool is not emptied for nothing
+    Slot* slot = nullptr;
+    int best = 0;
+    taskENTER_CRITICAL();
+    for (size_t i = 0; i < n_slots; ++i) {
+        auto& candidate = slots[i];
+        if (candidate.state != State::Free) {
+            continue;
+        }
+        bool same_host = candidate.open and candidate.open_port == port and ::memcmp(candidate.open_ip, ip, 4) == 0;
+        int rank = same_host ? 3 : not candidate.open ? 2 : 1;
+        if (rank > best) {
+            best = rank;
+            slot = &candidate;
+        }
+    }
+    if (slot) {
+        slot->state = State::Reserved;
+    }
+    taskEXIT_CRITICAL();
+    if (slot == nullptr) {
+        return {this, nullptr, Error::Busy};
+    }
+
+    auto buf = slot->buffer;
+    size_t size = buffer_size;
+    size_t len = ::snprintf(buf, size, "%.*s %.*s HTTP/1.1\r\nHost: %u.%u.%u.%u:%u\r\n",
+        int(method.size()), method.data(), int(path.size()), path.data(), ip[0], ip[1], ip[2], ip[3], port);
+    for (auto& field : options.headers) {
+        if (len < size) {
+            len += ::snprintf(buf + len, size - len, "%.*s: %.*s\r\n",
+                int(field.name.size()), field.name.data(), int(field.value.size()), field.value.data());
+        }
+    }
+    if (len < size and (not options.body.empty() or method == "POST" or method == "PUT")) {
+        len += ::snprintf(buf + len, size - len, "Content-Length: %u\r\n", unsigned(options.body.size()));
+    }
+    if (len < size) {
+        len += ::snprintf(buf + len, size - len, "\r\n");
+    }
+    if (len >= size or size - len < options.body.size()) {
+        slot->state = State::Free;
+        return {this, nullptr, Error::TooLarge};
+    }
+    ::memcpy(buf + len, options.body.data(), options.body.size());
+
+    slot->len = len + options.body.size();
+    ::memcpy(slot->ip, ip, 4);
+    slot->port = port;
+    slot->head = method == "HEAD";
+    slot->cancel = Error::None;
+    slot->released = false;
+    slot->error = Error::None;
+    slot->response = {};
+    slot->callback = nullptr;
+    slot->arg = nullptr;
+    slot->started = xTaskGetTickCount();
+    slot->timeout = options.timeout;
+    xEventGroupClearBits(events, bit(*slot));
+
+    // the client task only looks at queued slots, so this publishes the request
+    slot->state = State::Queued;
+    if (task) {
+        xTaskNotifyGive(task);
+    }
+    return {this, slot, Error::None};
+}
+
+Future Client::request(std::string_view method, std::string_view url) {
+    return request(method, url, Options{});
+}
+
+bool Client::when_all(std::initializer_list<Future*> futures, TickType_t timeout) {
+    // one deadline for all, what is left of it goes to the next future
+    auto start = xTaskGetTickCount();
+    bool ok = true;
+    for (auto future : futures) {
+        auto elapsed = xTaskGetTickCount() - start;
+        ok &= future->wait(elapsed < timeout ? timeout - elapsed : 0) != nullptr;
+    }
+    return ok;
+}
+
+bool Client::init() {
+    if (n_slots == 0 or first_socket + n_slots > _WIZCHIP_SOCK_NUM_) {
+        return false;
+    }
+    task = xTaskCreateStatic(task_function, "http client", stack_size, this, priority, stack, &task_buffer);
+    return task != nullptr;
+}
+
+void Client::task_function(void* self) {
+    static_cast<Client*>(self)->run();
+}
+
+void Client::run() {
+    // SENDOK too, a pooled connection takes the next request once the previous one left
+    uint8_t mask = 0;
+    for (size_t i = 0; i < n_slots; ++i) {
+        setSn_IMR(slots[i].sn, Sn_IR_CON | Sn_IR_RECV | Sn_IR_DISCON | Sn_IR_TIMEOUT | Sn_IR_SENDOK);
+        mask |= 1u << slots[i].sn;
+    }
+    Project::net::notify_on_interrupt(xTaskGetCurrentTaskHandle(), mask);
+
+    for (;;) {
+        bool busy = false;
+        for (size_t i = 0; i < n_slots; ++i) {
+            busy |= step(slots[i]);
+        }
+        if (not busy) {
+            ulTaskNotifyTake(pdTRUE, idle_poll);
+        }
+    }
+}
+
+bool Client::step(Slot& slot) {
+    auto sn = slot.sn;
+    auto ir = getSn_IR(sn);
+    if (ir != 0) {
+        setSn_IR(sn, ir);
+    }
+    if (ir & Sn_IR_SENDOK) {
+        slot.sending = false;
+    }
+
+    State state = slot.state;
+    switch (state) {
+        case State::Free:
+            return idle(slot);
+        case State::Reserved:
+        case State::Done:
+            return false;
+        default:
+            break;
+    }
+
+    if (slot.cancel != Error::None) {
+        finish(slot, slot.cancel);
+        return true;
+    }
+    if (xTaskGetTickCount() - slot.started >= slot.timeout) {
+        finish(slot, state == State::Connecting ? Error::Connect : Error::Timeout);
+        return true;
+    }
+
+    switch (state) {
+        case State::Queued:
+            if (slot.open and slot.open_port == slot.port and ::memcmp(slot.open_ip, slot.ip, 4) == 0 and
+                getSn_SR(sn) == SOCK_ESTABLISHED) {
+                return send(slot);
+            }
+            // a connection to another host, or one the server closed meanwhile, is replaced
+            slot.open = false;
+            slot.sending = false;
+            if (::socket(sn, Sn_MR_TCP, 0, SF_IO_NONBLOCK) != sn or ::connect(sn, slot.ip, slot.port) < 0) {
+                finish(slot, Error::Connect);
+                return true;
+            }
+            slot.state = State::Connecting;
+            return true;
+
+        case State::Connecting:
+            switch (getSn_SR(sn)) {
+                case SOCK_ESTABLISHED:
+                    return send(slot);
+                case SOCK_CLOSED:
+                    finish(slot, Error::Connect);
+                    return true;
+                default:
+                    return false;
+            }
+
+        case State::Receiving:
+            return receive(slot);
+
+        default:
+            return false;
+    }
+}
+
+bool Client::idle(Slot& slot) {
+    if (not slot.open) {
+        return false;
+    }
+    // a pooled connection goes when the server closes it or it sits unused for too long
+    auto sr = getSn_SR(slot.sn);
+    if (sr == SOCK_ESTABLISHED and xTaskGetTickCount() - slot.last_activity < keep_alive_timeout) {
+        return false;
+    }
+    slot.open = false;
+    if (sr == SOCK_ESTABLISHED or sr == SOCK_CLOSE_WAIT) {
+        ::disconnect(slot.sn);
+    } else {
+        ::close(slot.sn);
+    }
+    return true;
+}
+
+bool Client::send(Slot& slot) {
+    // the socket takes one SEND at a time, and a request always fits the TX memory once the
+    // previous one left, so it goes in one piece and nothing waits here
+    auto sn = slot.sn;
+    if (slot.sending or getSn_TX_FSR(sn) < slot.len) {
+        return false;
+    }
+    wiz_send_data(sn, reinterpret_cast<uint8_t*>(slot.buffer), slot.len);
+    setSn_CR(sn, Sn_CR_SEND);
+    while (getSn_CR(sn)) {}
+    slot.sending = true;
+
+    // the buffer takes the response from now on
+    slot.len = 0;
+    slot.state = State::Receiving;
+    return true;
+}
+
+bool Client::receive(Slot& slot) {
+    auto sn = slot.sn;
+    auto sr = getSn_SR(sn);
+    size_t available = getSn_RX_RSR(sn);
+    bool eof = sr != SOCK_ESTABLISHED and available == 0;
+    if (available == 0 and not eof) {
+        return false;
+    }
+
+    if (available > 0) {
+        size_t space = buffer_size - slot.len;
+        if (space == 0) {
+            finish(slot, Error::TooLarge);
+            return true;
+        }
+        auto n = ::recv(sn, reinterpret_cast<uint8_t*>(slot.buffer + slot.len), available < space ? available : space);
+        if (n <= 0) {
+            finish(slot, Error::Closed);
+            return true;
+        }
+        slot.len += n;
+    }
+
+    bool keep = false;
+    switch (parse(slot.buffer, slot.len, eof, slot.head, slot.response, keep)) {
+        case Parse::Complete:
+            finish(slot, Error::None, keep and sr == SOCK_ESTABLISHED);
+            break;
+        case Parse::Incomplete:
+            if (eof) {
+                finish(slot, Error::Closed);
+            } else if (slot.len == buffer_size) {
+                finish(slot, Error::TooLarge);
+            }
+            break;
+        case Parse::Invalid:
+            finish(slot, Error::Invalid);
+            break;
+    }
+    return true;
+}
+
+void Client::finish(Slot& slot, Error error, bool keep) {
+    if (keep) {
+        slot.open = true;
+        ::memcpy(slot.open_ip, slot.ip, 4);
+        slot.open_port = slot.port;
+        slot.last_activity = xTaskGetTickCount();
+    } else {
+        slot.open = false;
+        if (error == Error::None and getSn_SR(slot.sn) == SOCK_ESTABLISHED) {
+            ::disconnect(slot.sn);
+        } else {
+            ::close(slot.sn);
+        }
+    }
+    if (error != Error::None) {
+        slot.response = {};
+    }
+    slot.error = error;
+
+    // a released slot is nobody's anymore, it goes straight back to the pool
+    Future::Callback callback = nullptr;
+    taskENTER_CRITICAL();
+    if (slot.released) {
+        slot.state = State::Free;
+    } else {
+        slot.state = State::Done;
+        callback = slot.callback;
+    }
+    taskEXIT_CRITICAL();
+
+    if (callback) {
+        callback(error == Error::None ? &slot.response : nullptr, error, slot.arg);
+    }
+    xEventGroupSetBits(events, bit(slot));
+}
+
+Future& Future::operator=(Future&& other) noexcept {
+    if (this != &other) {
+        release();
+        client = other.client;
+        slot = other.slot;
+        early_error = other.early_error;
+        other.slot = nullptr;
+    }
+    return *this;
+}
+
+bool Future::ready() const {
+    return slot == nullptr or slot->state == State::Done;
+}
+
+const Client::Response* Future::wait(TickType_t timeout) {
+    if (slot == nullptr) {
+        return nullptr;
+    }
+
+    // the bit of a slot can be set by the request that used it before, so the state decides
+    auto start = xTaskGetTickCount();
+    bool stopped = false;
+    while (slot->state != State::Done) {
+        auto elapsed = xTaskGetTickCount() - start;
+        if (elapsed >= timeout) {
+            if (stopped) {
+                return nullptr;
+            }
+            // the client task closes the socket and completes the request
+            stop(Client::Error::Timeout);
+            stopped = true;
+            start = xTaskGetTickCount();
+            timeout = Client::cancel_timeout;
+            continue;
+        }
+        xEventGroupWaitBits(client->events, client->bit(*slot), pdTRUE, pdTRUE, timeout - elapsed);
+    }
+    return slot->error == Client::Error::None ? &slot->response : nullptr;
+}
+
+Client::Error Future::error() const {
+    if (slot == nullptr) {
+        return early_error;
+    }
+    // a stopped request that did not complete yet already has its error
+    return slot->state == State::Done ? slot->error : slot->cancel;
+}
+
+Future& Future::then(Callback cb, void* arg) {
+    if (slot == nullptr) {
+        cb(nullptr, early_error, arg);
+        return *this;
+    }
+
+    bool done;
+    taskENTER_CRITICAL();
+    done = slot->state == State::Done;
+    if (not done) {
+        slot->callback = cb;
+        slot->arg = arg;
+    }
+    taskEXIT_CRITICAL();
+
+    if (done) {
+        cb(slot->error == Client::Error::None ? &slot->response : nullptr, slot->error, arg);
+    }
+    return *this;
+}
+
+void Future::stop(Client::Error reason) {
+    if (slot == nullptr or slot->state == State::Done) {
+        return;
+    }
+    slot->cancel = reason;
+    if (client->task) {
+        xTaskNotifyGive(client->task);
+    }
+}
+
+void Future::release() {
+    if (slot == nullptr) {
+        return;
+    }
+    taskENTER_CRITICAL();
+    if (slot->state == State::Done) {
+        slot->state = State::Free;
+    } else {
+        slot->released = true;
+        slot->cancel = Client::Error::Cancelled;
+    }
+    taskEXIT_CRITICAL();
+    if (client->task) {
+        xTaskNotifyGive(client->task);
+    }
+    slot = nullptr;
+}
@@ -0,0 +1,202 @@
+#ifndef PROJECT_NET_HTTP_CLIENT_HPP
+#define PROJECT_NET_HTTP_CLIENT_HPP
+
+#include "net/http/request.hpp"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+
+namespace Project::net::http {
+    class Client;
+    class Future;
+}
+
+/// Asynchronous HTTP/1.1 client on W5500 TCP sockets.
+/// Every slot owns one socket and one buffer that holds the request until it is sent and the
+/// response after that, so requests never allocate. request() only formats the request into a
+/// free slot and returns a future; the client task connects, sends and receives for all slots
+/// at once and never waits on a single one, so several requests to different upstreams are
+/// in flight together. A request is copied to the socket TX memory in one piece and the task
+/// moves on, the SENDOK interrupt tells when the socket may take the next one.
+///
+/// Connections are pooled per host: a slot keeps its socket open after a keep-alive response,
+/// and the next request to the same host is given that slot and skips the TCP handshake.
+/// Idle connections are closed after a while, or when a slot is needed for another host.
+/// @code
+/// auto a = client.request("GET", "10.20.30.1:5000/a");
+/// auto b = client.request("GET", "10.20.30.2:5000/b");
+/// if (Client::when_all({&a, &b}, pdMS_TO_TICKS(1000))) {
+///     use(a.wait()->body, b.wait()->body);
+/// }
+/// @endcode
+class Project::net::http::Client {
+public:
+    static constexpr size_t buffer_size = 512;
+    static constexpr size_t max_headers = 8;
+    static constexpr size_t max_slots = 24; ///< one event group bit each
+    static constexpr TickType_t idle_poll = pdMS_TO_TICKS(10); ///< granularity of the timeouts
+    static constexpr TickType_t cancel_timeout = 2 * idle_poll; ///< longest the task takes to see a cancel
+
+    enum class Error : uint8_t {
+        None,
+        Busy,        ///< no free slot
+        InvalidUrl,  ///< only "[http://]a.b.c.d[:port][/path]" is understood
+        TooLarge,    ///< the request or the response does not fit in the slot buffer
+        Connect,     ///< the connection was refused or timed out
+        Closed,      ///< the connection dropped before the response was complete
+        Invalid,     ///< malformed response
+        Timeout,
+        Cancelled,
+    };
+
+    struct Response {
+        int status;
+        Fields<max_headers, true> headers;  ///< the first ones, framing does not depend on them
+        std::string_view body;   ///< de-chunked if it was sent chunked
+    };
+
+    struct Options {
+        std::initializer_list<Field> headers = {};
+        std::string_view body = {};
+        TickType_t timeout = pdMS_TO_TICKS(5000);
+    };
+
+    /// request state, owned by the client and its future in turn
+    struct Slot {
+        enum class State : uint8_t {
+            Free,
+            Reserved,    ///< being filled in by request()
+            Queued,
+            Connecting,
+            Receiving,
+            Done,
+        };
+
+        char buffer[buffer_size];
+        size_t len;              ///< request bytes to send, then response bytes received
+        uint8_t sn;
+        uint8_t ip[4];           ///< host of the request
+        uint16_t port;
+        uint8_t open_ip[4];      ///< host of the open connection
+        uint16_t open_port;
+        bool open;               ///< the socket holds a keep-alive connection
+        bool head;               ///< HEAD request, the response has no body
+        bool sending;            ///< a SEND was issued and SENDOK was not seen yet
+        volatile State state;
+        volatile Error cancel;   ///< set by the future, handled by the client task
+        volatile bool released;  ///< the future is gone, free the slot once done
+        Error error;
+        TickType_t started;
+        TickType_t timeout;
+        TickType_t last_activity;
+        Response response;
+        void (*callback)(const Response* res, Error err, void* arg);
+        void* arg;
+    };
+
+    struct Config {
+        uint8_t socket = 0;          ///< W5500 socket of the first slot, the others follow
+        Slot* slots;
+        size_t n_slots = 1;
+        TickType_t keep_alive_timeout = pdMS_TO_TICKS(5000); ///< close pooled connections idle for this long
+        UBaseType_t priority = tskIDLE_PRIORITY + 2;
+    };
+
+    explicit Client(Config config);
+
+    /// queue a request
+    /// @param url "10.20.30.1:5000/test", the scheme is optional and only plain http is spoken
+    /// @return a future, invalid with an error if the request could not be queued
+    /// @note header values and the body are copied, they only have to live until this returns
+    Future request(std::string_view method, std::string_view url, const Options& options);
+    Future request(std::string_view method, std::string_view url);
+
+    /// wait for every future, and cancel the ones still running once the timeout expires
+    /// @return true if all completed without error
+    static bool when_all(std::initializer_list<Future*> futures, TickType_t timeout);
+
+    /// drive the connections forever in a task of its own
+    /// @return false if the sockets are out of range
+    bool init();
+
+private:
+    friend class Future;
+
+    static constexpr size_t stack_size = 256;  ///< completion callbacks run here too
+
+    static void task_function(void* self);
+    [[noreturn]] void run();
+    bool step(Slot& slot);
+    bool idle(Slot& slot);
+    bool send(Slot& slot);
+    bool receive(Slot& slot);
+    void finish(Slot& slot, Error error, bool keep = false);
+    EventBits_t bit(const Slot& slot) const { return EventBits_t(1) << (&slot - slots); }
+
+    uint8_t first_socket;
+    Slot* slots;
+    size_t n_slots;
+    TickType_t keep_alive_timeout;
+    UBaseType_t priority;
+
+    TaskHandle_t task = nullptr;
+    StaticTask_t task_buffer = {};
+    StackType_t stack[stack_size] = {};
+    StaticEventGroup_t events_buffer = {};
+    EventGroupHandle_t events = nullptr;
+};
+
+/// Handle to the response of a request.
+/// Move only; the response is a view into the slot buffer and the slot is handed back to the
+/// client when the future is destroyed, cancelling the request if it is still running.
+class Project::net::http::Future {
+public:
+    using Callback = void(*)(const Client::Response* res, Client::Error err, void* arg);
+
+    Future() = default;
+    Future(Future&& other) noexcept { *this = static_cast<Future&&>(other); }
+    Future& operator=(Future&& other) noexcept;
+    Future(const Future&) = delete;
+    Future& operator=(const Future&) = delete;
+    ~Future() { release(); }
+
+    /// false if the request was never queued
+    bool valid() const { return slot != nullptr; }
+
+    /// true once the request completed, successfully or not
+    bool ready() const;
+
+    /// block the calling task until the response arrives
+    /// @note on timeout the request is stopped and its error is Timeout
+    /// @return nullptr on error, see error()
+    const Client::Response* wait(TickType_t timeout = portMAX_DELAY);
+
+    Client::Error error() const;
+
+    /// call cb from the client task once the request completes, or right away if it has
+    /// @note one callback per request, it must not block
+    Future& then(Callback cb, void* arg = nullptr);
+
+    /// stop the request and close its connection, wait() returns Cancelled
+    void cancel() { stop(Client::Error::Cancelled); }
+
+    /// hand the slot back to the client, the response is no longer valid
+    void release();
+
+private:
+    friend class Client;
+
+    Future(Client* client, Client::Slot* slot, Client::Error error) : client(client), slot(slot), early_error(error) {}
+
+    void stop(Client::Error reason);
+
+    Client* client = nullptr;
+    Client::Slot* slot = nullptr;
+    Client::Error early_error = Client::Error::None;
+};
+
+#endif // PROJECT_NET_HTTP_CLIENT_HPP
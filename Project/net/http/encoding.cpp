@@ -0,0 +1,93 @@
+#include "net/http/encoding.hpp"
+
+using namespace Project::net::http;
+
+static std::string_view trim(std::string_view str) {
+    while (not str.empty() and (str.front() == ' ' or str.front() == '\t')) str.remove_prefix(1);
+    while (not str.empty() and (str.back() == ' ' or str.back() == '\t')) str.remove_suffix(1);
+    return str;
+}
+
+/// "0.5" as 500, "1" as 1000
+static int quality(std::string_view str) {
+    if (str.empty() or str.front() == '1') {
+        return 1000;
+    }
+    int q = 0;
+    size_t digits = 0;
+    for (size_t i = 2; i < str.size() and digits < 3; ++i, ++digits) {
+        if (str[i] < '0' or str[i] > '9') {
+            return 0;
+        }
+        q = q * 10 + (str[i] - '0');
+    }
+    for (; digits < 3; ++digits) {
+        q *= 10;
+    }
+    return q;
+}
+
+/// quality the Accept header gives a media type, taken from its most specific range
+static int accepted(std::string_view accept, std::string_view type) {
+    auto slash = type.find('/');
+    int best_specificity = 0;
+    int best_q = 0;
+    for (auto rest = accept; not rest.empty();) {
+        auto comma = rest.find(',');
+        auto item = rest.substr(0, comma);
+        rest.remove_prefix(comma == std::string_view::npos ? rest.size() : comma + 1);
+
+        auto semicolon = item.find(';');
+        auto range = trim(item.substr(0, semicolon));
+        int q = 1000;
+        for (auto params = semicolon == std::string_view::npos ? std::string_view() : item.substr(semicolon + 1); not params.empty();) {
+            auto next = params.find(';');
+            auto param = trim(params.substr(0, next));
+            params.remove_prefix(next == std::string_view::npos ? params.size() : next + 1);
+            if (param.size() > 2 and (param[0] == 'q' or param[0] == 'Q') and param[1] == '=') {
+                q = quality(param.substr(2));
+            }
+        }
+
+        int specificity = 0;
+        if (equals_ignore_case(range, type)) {
+            specificity = 3;
+        } else if (range.size() == slash + 2 and equals_ignore_case(range.substr(0, slash + 1), type.substr(0, slash + 1)) and range.back() == '*') {
+            specificity = 2;
+        } else if (range == "*/*") {
+            specificity = 1;
+        }
+        if (specificity > best_specificity) {
+            best_specificity = specificity;
+            best_q = q;
+        }
+    }
+    return best_q;
+}
+
+bool Project::net::http::request_encoding(const Request& req, Encoding& res) {
+    auto type = trim(req.headers["Content-Type"].substr(0, req.headers["Content-Type"].find(';')));
+    if (type.empty() or equals_ignore_case(type, media_type(Encoding::Json))) {
+        res = Encoding::Json;
+        return true;
+    }
+    if (equals_ignore_case(type, media_type(Encoding::Cbor))) {
+        res = Encoding::Cbor;
+        return true;
+    }
+    return false;
+}
+
+Encoding Project::net::http::response_encoding(const Request& req) {
+    auto accept = req.headers["Accept"];
+    if (accept.empty()) {
+        return Encoding::Json;
+    }
+    // json wins a tie, it is what a client that names neither expects
+    int cbor = accepted(accept, media_type(Encoding::Cbor));
+    return cbor > 0 and cbor > accepted(accept, media_type(Encoding::Json)) ? Encoding::Cbor : Encoding::Json;
+}
+
+std::string_view Project::net::http::media_type(Encoding encoding) {
+    return encoding == Encoding::Cbor ? "application/cbor" : "application/json";
+}
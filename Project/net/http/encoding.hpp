@@ -0,0 +1,49 @@
+#ifndef PROJECT_NET_HTTP_ENCODING_HPP
+#define PROJECT_NET_HTTP_ENCODING_HPP
+
+#include "net/http/request.hpp"
+#include "net/http/response.hpp"
+#include "utils/json.hpp"
+#include "utils/cbor.hpp"
+#include <string_view>
+
+namespace Project::net::http {
+    /// body encodings of the structs described with JSON_SCHEMA
+    enum class Encoding { Json, Cbor };
+
+    /// encoding of the request body from its Content-Type, json if there is none
+    /// @return false for any other media type, which is answered with 415
+    bool request_encoding(const Request& req, Encoding& res);
+
+    /// encoding of the response from the Accept header: cbor if the client ranks it above
+    /// json, json otherwise
+    Encoding response_encoding(const Request& req);
+
+    std::string_view media_type(Encoding encoding);
+
+    /// decode the request body into value
+    /// @note a json body is unescaped in place, it is a slice of the writable receive buffer
+    template <typename T>
+    bool read(const Request& req, Encoding encoding, T& value) {
+        if (encoding == Encoding::Cbor) {
+            utils::cbor::Reader reader(req.body);
+            return reader.read(value) and reader.size() == req.body.size();
+        }
+        utils::json::Parser parser(value);
+        return parser.feed(const_cast<char*>(req.body.data()), req.body.size(), true) == utils::json::Parser::Status::Complete;
+    }
+
+    /// write value as the response body with its Content-Type
+    template <typename T>
+    void write(Response& res, Encoding encoding, const T& value) {
+        res.header("Content-Type", media_type(encoding));
+        res.header("Vary", "Accept");
+        if (encoding == Encoding::Cbor) {
+            utils::cbor::Writer(res).value(value);
+        } else {
+            utils::json::Writer(res).value(value);
+        }
+    }
+}
+
+#endif // PROJECT_NET_HTTP_ENCODING_HPP
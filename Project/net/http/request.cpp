@@ -0,0 +1,148 @@
+#include "net/http/request.hpp"
+
+using namespace Project::net::http;
+
+static std::string_view trim(std::string_view str) {
+    while (not str.empty() and (str.front() == ' ' or str.front() == '\t')) str.remove_prefix(1);
+    while (not str.empty() and (str.back() == ' ' or str.back() == '\t')) str.remove_suffix(1);
+    return str;
+}
+
+static int hex_value(char ch) {
+    if (ch >= '0' and ch <= '9') return ch - '0';
+    if (ch >= 'a' and ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' and ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+/// decode %XX and '+' in place
+/// @return decoded length
+static size_t percent_decode(char* str, size_t len) {
+    size_t out = 0;
+    for (size_t i = 0; i < len; ++i) {
+        char ch = str[i];
+        if (ch == '+') {
+            ch = ' ';
+        } else if (ch == '%' and i + 2 < len and hex_value(str[i + 1]) >= 0 and hex_value(str[i + 2]) >= 0) {
+            ch = char(hex_value(str[i + 1]) << 4 | hex_value(str[i + 2]));
+            i += 2;
+        }
+        str[out++] = ch;
+    }
+    return out;
+}
+
+static bool parse_size(std::string_view str, size_t& res) {
+    if (str.empty() or str.size() > 9) {
+        return false;
+    }
+    res = 0;
+    for (char ch : str) {
+        if (ch < '0' or ch > '9') {
+            return false;
+        }
+        res = res * 10 + (ch - '0');
+    }
+    return true;
+}
+
+Request::Status Request::parse(char* buf, size_t len) {
+    *this = {};
+
+    std::string_view data(buf, len);
+    auto header_end = data.find("\r\n\r\n");
+    if (header_end == std::string_view::npos) {
+        return Status::Incomplete;
+    }
+    auto head = data.substr(0, header_end + 2);
+
+    // request line
+    auto eol = head.find("\r\n");
+    auto line = head.substr(0, eol);
+    auto sp1 = line.find(' ');
+    auto sp2 = line.rfind(' ');
+    if (sp1 == std::string_view::npos or sp1 == sp2) {
+        return Status::Invalid;
+    }
+    method = line.substr(0, sp1);
+    target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    version = line.substr(sp2 + 1);
+    if (method.empty() or target.empty() or target.front() != '/' or version.substr(0, 7) != "HTTP/1.") {
+        return Status::Invalid;
+    }
+
+    // header fields
+    for (auto rest = head.substr(eol + 2); not rest.empty();) {
+        eol = rest.find("\r\n");
+        line = rest.substr(0, eol);
+        rest.remove_prefix(eol + 2);
+
+        auto colon = line.find(':');
+        if (colon == 0 or colon == std::string_view::npos) {
+            return Status::Invalid;
+        }
+        if (not headers.append({line.substr(0, colon), trim(line.substr(colon + 1))})) {
+            return Status::TooLarge;
+        }
+    }
+
+    // body framing, chunked request bodies are not supported
+    size_t content_length = 0;
+    if (headers.has("Transfer-Encoding")) {
+        return Status::Invalid;
+    }
+    if (auto value = headers["Content-Length"]; not value.empty() and not parse_size(value, content_length)) {
+        return Status::Invalid;
+    }
+    size_t body_start = header_end + 4;
+    if (len - body_start < content_length) {
+        return Status::Incomplete;
+    }
+    body = data.substr(body_start, content_length);
+    length = body_start + content_length;
+
+    // path and query, decoding shrinks the query in place so it goes last
+    auto question = target.find('?');
+    path = target.substr(0, question);
+    if (question != std::string_view::npos) {
+        query = target.substr(question + 1);
+    }
+    for (auto rest = path; not rest.empty();) {
+        auto slash = rest.find('/');
+        auto segment = rest.substr(0, slash);
+        rest.remove_prefix(slash == std::string_view::npos ? rest.size() : slash + 1);
+        if (segment.empty()) {
+            continue;
+        }
+        if (n_segments == max_segments) {
+            return Status::TooLarge;
+        }
+        segments[n_segments++] = segment;
+    }
+
+    if (not query.empty()) {
+        // the query string has to be writable, it is a slice of buf
+        char* str = buf + (query.data() - buf);
+        for (size_t pos = 0; pos < query.size();) {
+            auto end = query.find('&', pos);
+            if (end == std::string_view::npos) end = query.size();
+
+            auto pair = query.substr(pos, end - pos);
+            auto eq = pair.find('=');
+            size_t name_len = eq == std::string_view::npos ? pair.size() : eq;
+            size_t value_pos = eq == std::string_view::npos ? pair.size() : eq + 1;
+
+            char* name = str + pos;
+            char* value = str + pos + value_pos;
+            name_len = percent_decode(name, name_len);
+            size_t value_len = percent_decode(value, pair.size() - value_pos);
+
+            if (name_len > 0 and not queries.append({{name, name_len}, {value, value_len}})) {
+                return Status::TooLarge;
+            }
+            pos = end + 1;
+        }
+    }
+
+    return Status::Complete;
+}
@@ -0,0 +1,124 @@
+#ifndef PROJECT_NET_HTTP_REQUEST_HPP
+#define PROJECT_NET_HTTP_REQUEST_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Project::net::http {
+    struct Field;
+    template <size_t N, bool fold_case> class Fields;
+    class Request;
+
+    /// ASCII case-insensitive comparison, as used for header names and tokens
+    constexpr bool equals_ignore_case(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            char x = a[i], y = b[i];
+            if (x >= 'A' and x <= 'Z') x += 'a' - 'A';
+            if (y >= 'A' and y <= 'Z') y += 'a' - 'A';
+            if (x != y) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+struct Project::net::http::Field {
+    std::string_view name;
+    std::string_view value;
+};
+
+/// Fixed capacity list of name/value pairs.
+/// Lookup is linear, which beats hashing for the handful of fields a request carries.
+template <size_t N, bool fold_case>
+class Project::net::http::Fields {
+public:
+    static bool equals(std::string_view a, std::string_view b) {
+        if constexpr (fold_case) {
+            return equals_ignore_case(a, b);
+        } else {
+            return a == b;
+        }
+    }
+
+    bool has(std::string_view name) const { return find(name) != nullptr; }
+
+    /// @return empty view if the field is not present
+    std::string_view operator[](std::string_view name) const {
+        auto field = find(name);
+        return field ? field->value : std::string_view();
+    }
+
+    const Field* find(std::string_view name) const {
+        for (size_t i = 0; i < count; ++i) {
+            if (equals(items[i].name, name)) {
+                return &items[i];
+            }
+        }
+        return nullptr;
+    }
+
+    /// @return false if the list is full
+    bool append(Field field) {
+        if (count == N) {
+            return false;
+        }
+        items[count++] = field;
+        return true;
+    }
+
+    void clear() { count = 0; }
+
+    size_t len() const { return count; }
+    const Field* begin() const { return items; }
+    const Field* end() const { return items + count; }
+
+private:
+    Field items[N] = {};
+    size_t count = 0;
+};
+
+/// HTTP/1.x request parsed in place.
+/// Every string is a slice of the receive buffer, so parsing never allocates. Query
+/// parameters are percent-decoded in place, which is why the buffer is not const.
+/// @note the buffer must outlive the request
+class Project::net::http::Request {
+public:
+    static constexpr size_t max_headers = 16;
+    static constexpr size_t max_queries = 8;
+    static constexpr size_t max_segments = 8;
+
+    enum class Status {
+        Complete,   ///< request line, headers and body are all in the buffer
+        Incomplete, ///< more bytes are needed
+        Invalid,    ///< malformed request
+        TooLarge,   ///< more fields than the fixed capacity allows
+    };
+
+    /// parse the bytes at the start of buf
+    /// @note an incomplete request must be parsed again from the start once more bytes arrived
+    Status parse(char* buf, size_t len);
+
+    std::string_view method;
+    std::string_view target;  ///< path and query as received
+    std::string_view path;
+    std::string_view query;   ///< overwritten by the in-place decoding of the parameters
+    std::string_view version;
+    std::string_view body;
+    std::string_view segments[max_segments] = {}; ///< non empty components of the path
+    size_t n_segments = 0;
+    Fields<max_headers, true> headers;
+    Fields<max_queries, false> queries;
+
+    /// number of bytes taken by this request, including its body
+    size_t size() const { return length; }
+
+private:
+    size_t length = 0;
+};
+
+#endif // PROJECT_NET_HTTP_REQUEST_HPP
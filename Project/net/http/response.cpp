@@ -0,0 +1,85 @@
+#include "net/http/response.hpp"
+#include "net/http/stream.hpp"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+using namespace Project::net::http;
+
+const char* Project::net::http::reason(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 415: return "Unsupported Media Type";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        default:  return "Unknown";
+    }
+}
+
+size_t Response::write(std::string_view str) {
+    if (stream) {
+        size_t n = stream->write(str);
+        truncated = truncated or n < str.size();
+        return n;
+    }
+
+    size_t n = str.size() < capacity - len ? str.size() : capacity - len;
+    ::memcpy(buf + len, str.data(), n);
+    len += n;
+    truncated = truncated or n < str.size();
+    return n;
+}
+
+bool Response::chunked(Producer producer, const void* state) {
+    if (start != nullptr and stream == nullptr and start(context, *this, producer, state)) {
+        return true;
+    }
+    // without chunked encoding the body is buffered as usual
+    for (size_t i = 0; producer(*this, i, state) and not truncated; ++i) {}
+    return false;
+}
+
+size_t Response::print(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    if (stream) {
+        char str[max_print];
+        int n = ::vsnprintf(str, sizeof(str), fmt, args);
+        va_end(args);
+        if (n < 0) {
+            return 0;
+        }
+        if (size_t(n) >= sizeof(str)) {
+            truncated = true;
+            n = sizeof(str) - 1;
+        }
+        return write({str, size_t(n)});
+    }
+
+    int n = ::vsnprintf(buf + len, capacity - len, fmt, args);
+    va_end(args);
+
+    if (n < 0) {
+        return 0;
+    }
+    if (size_t(n) >= capacity - len) {
+        // the last byte of the buffer holds the terminator
+        truncated = true;
+        n = capacity > len ? capacity - len - 1 : 0;
+    }
+    len += n;
+    return n;
+}
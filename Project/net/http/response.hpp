@@ -0,0 +1,74 @@
+#ifndef PROJECT_NET_HTTP_RESPONSE_HPP
+#define PROJECT_NET_HTTP_RESPONSE_HPP
+
+#include "net/http/request.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Project::net::http {
+    class Response;
+    class Stream;
+
+    /// reason phrase of a status code
+    const char* reason(int status);
+}
+
+/// HTTP response built into a caller-provided buffer.
+/// Header values are not copied, they must be literals or live in the connection arena.
+/// A body that does not fit can be streamed instead, see chunked().
+class Project::net::http::Response {
+public:
+    static constexpr size_t max_headers = 8;
+    static constexpr size_t max_print = 128; ///< longest print() while streaming
+    static constexpr size_t max_piece = 128; ///< most a producer writes at a time
+
+    /// writes the piece of a streamed body with the given index, at most max_piece bytes
+    /// @return false once the body is complete
+    using Producer = bool(*)(Response& res, size_t index, const void* context);
+
+    /// sends the status and headers and takes over the producer of the body
+    using Start = bool(*)(void* context, Response& res, Producer producer, const void* state);
+
+    Response(char* buf, size_t size, Start start = nullptr, void* context = nullptr)
+        : buf(buf), capacity(size), start(start), context(context) {}
+
+    int status = 200;
+    Fields<max_headers, true> headers;
+
+    /// @return false if the header list is full
+    bool header(std::string_view name, std::string_view value) { return headers.append({name, value}); }
+
+    /// append to the body
+    /// @return number of bytes written, the rest is dropped and marks the response as overflowed
+    size_t write(std::string_view str);
+    size_t print(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+    std::string_view body() const { return {buf, len}; }
+    void clear() { len = 0; truncated = false; headers.clear(); }
+
+    /// true if the body did not fit in the buffer, or the stream failed
+    bool overflow() const { return truncated; }
+
+    /// send the status and headers now and have the server call producer for the body, one
+    /// piece at a time whenever the socket has room, each piece going straight to the socket
+    /// @return false if the client cannot take a chunked body, the producer has then written
+    /// the whole body into the buffer as usual
+    /// @note the producer runs after the handler returned, when the request and the arena are
+    /// gone; status and headers set after this are ignored
+    bool chunked(Producer producer, const void* state = nullptr);
+
+    bool streaming() const { return stream != nullptr; }
+    void attach(Stream* s) { stream = s; }
+
+private:
+    char* buf;
+    size_t capacity;
+    size_t len = 0;
+    bool truncated = false;
+    Start start;
+    void* context;
+    Stream* stream = nullptr;
+};
+
+#endif // PROJECT_NET_HTTP_RESPONSE_HPP
@@ -0,0 +1,25 @@
+#include "net/http/routes.hpp"
+
+using namespace Project::net::http;
+
+const Route* Routes::find(std::string_view method, std::string_view path) const {
+    if (seed == 0) {
+        return nullptr;
+    }
+    auto index = slots[route_hash(seed, method, path) & mask];
+    if (index == 0) {
+        return nullptr;
+    }
+    // a request that is not in the table can still land in an occupied slot
+    auto& route = routes[index - 1];
+    return route.method == method and route.path == path ? &route : nullptr;
+}
+
+bool Routes::has_path(std::string_view path) const {
+    for (auto& route : *this) {
+        if (route.path == path) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,137 @@
+#ifndef PROJECT_NET_HTTP_ROUTES_HPP
+#define PROJECT_NET_HTTP_ROUTES_HPP
+
+#include "net/http/request.hpp"
+#include "net/http/response.hpp"
+#include "utils/arena.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Project::net::http {
+    constexpr size_t arena_size = 256;
+    using Arena = utils::Arena<arena_size>;
+    using Handler = void(*)(const Request& req, Response& res, Arena& arena);
+
+    struct Route;
+    class Routes;
+    template <size_t N> class RouteTable;
+
+    /// FNV-1a over "<method> <path>", salted with the table seed
+    constexpr uint32_t route_hash(uint32_t seed, std::string_view method, std::string_view path) {
+        uint32_t h = 2166136261u ^ seed;
+        for (char ch : method) {
+            h = (h ^ uint8_t(ch)) * 16777619u;
+        }
+        h = (h ^ uint8_t(' ')) * 16777619u;
+        for (char ch : path) {
+            h = (h ^ uint8_t(ch)) * 16777619u;
+        }
+        return h ^ (h >> 16);
+    }
+}
+
+struct Project::net::http::Route {
+    std::string_view method = {};
+    std::string_view path = {};
+    Handler handler = nullptr;
+};
+
+/// Read-only view of a route table, used by the server to dispatch requests.
+class Project::net::http::Routes {
+public:
+    constexpr Routes(const Route* routes, size_t n_routes, const uint8_t* slots, size_t n_slots, uint32_t seed)
+        : routes(routes), n_routes(n_routes), slots(slots), mask(n_slots - 1), seed(seed) {}
+
+    /// route registered for a method and path, a hash and a single comparison
+    /// @return nullptr if there is none
+    const Route* find(std::string_view method, std::string_view path) const;
+
+    /// true if the path is registered for any method
+    /// @note linear, only meant to tell 405 from 404
+    bool has_path(std::string_view path) const;
+
+    const Route* begin() const { return routes; }
+    const Route* end() const { return routes + n_routes; }
+    size_t len() const { return n_routes; }
+
+private:
+    const Route* routes;
+    size_t n_routes;
+    const uint8_t* slots;
+    size_t mask;
+    uint32_t seed;
+};
+
+/// Route table with a perfect hash built at compile time.
+/// The constructor searches for a hash seed that puts every method and path pair in its own
+/// slot, so a request is matched by hashing its method and path once. Declared constexpr,
+/// the table lives in flash and costs no RAM.
+/// @code
+/// static constexpr RouteTable routes({
+///     Route{"GET", "/hello", hello},
+///     Route{"POST", "/foo", foo},
+/// });
+/// static_assert(routes.valid(), "duplicate route");
+/// @endcode
+template <size_t N>
+class Project::net::http::RouteTable {
+public:
+    static_assert(N > 0 and N < 256, "Route table must hold between 1 and 255 routes");
+
+    /// slot count is a power of two at least twice the route count, which keeps the seed
+    /// search short
+    static constexpr size_t n_slots = [] {
+        size_t n = 1;
+        while (n < 2 * N) n <<= 1;
+        return n;
+    }();
+
+    static constexpr uint32_t max_seed = 1u << 16;
+
+    constexpr explicit RouteTable(const Route (&list)[N]) {
+        for (size_t i = 0; i < N; ++i) {
+            routes[i] = list[i];
+        }
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t j = 0; j < i; ++j) {
+                if (routes[i].method == routes[j].method and routes[i].path == routes[j].path) {
+                    return; // duplicates can never be told apart, valid() stays false
+                }
+            }
+        }
+        for (uint32_t s = 1; s < max_seed; ++s) {
+            if (place(s)) {
+                seed = s;
+                return;
+            }
+        }
+    }
+
+    /// false if the table has duplicate routes or no seed was found
+    constexpr bool valid() const { return seed != 0; }
+
+    constexpr Routes view() const { return {routes, N, slots, n_slots, seed}; }
+    constexpr operator Routes() const { return view(); }
+
+private:
+    constexpr bool place(uint32_t s) {
+        for (size_t i = 0; i < n_slots; ++i) {
+            slots[i] = 0;
+        }
+        for (size_t i = 0; i < N; ++i) {
+            auto& slot = slots[route_hash(s, routes[i].method, routes[i].path) & (n_slots - 1)];
+            if (slot != 0) {
+                return false;
+            }
+            slot = uint8_t(i + 1);
+        }
+        return true;
+    }
+
+    Route routes[N] = {};
+    uint8_t slots[n_slots] = {}; ///< route index + 1, 0 for an empty slot
+    uint32_t seed = 0;
+};
+
+#endif // PROJECT_NET_HTTP_ROUTES_HPP
@@ -0,0 +1,368 @@
+#include "net/http/server.hpp"
+#include "net/interrupt.hpp"
+#include "socket.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace Project::net::http;
+
+bool Server::init() {
+    if (n_connections == 0 or first_socket + n_connections > _WIZCHIP_SOCK_NUM_) {
+        return false;
+    }
+    task = xTaskCreateStatic(task_function, "http server", stack_size, this, priority, stack, &task_buffer);
+    return task != nullptr;
+}
+
+void Server::task_function(void* self) {
+    static_cast<Server*>(self)->serve();
+}
+
+void Server::serve() {
+    // SENDOK wakes the task to issue the next SEND of a connection
+    uint8_t mask = 0;
+    for (size_t i = 0; i < n_connections; ++i) {
+        auto& conn = connections[i];
+        conn = {};
+        conn.sn = first_socket + i;
+        setSn_IMR(conn.sn, Sn_IR_CON | Sn_IR_RECV | Sn_IR_DISCON | Sn_IR_TIMEOUT | Sn_IR_SENDOK);
+        mask |= 1u << conn.sn;
+    }
+
+    Project::net::notify_on_interrupt(xTaskGetCurrentTaskHandle(), mask);
+
+    for (;;) {
+        bool busy = false;
+        waiting = false;
+        for (size_t i = 0; i < n_connections; ++i) {
+            busy |= poll(connections[i]);
+        }
+        // TX memory is freed as the client acknowledges, which raises no interrupt
+        if (not busy) {
+            ulTaskNotifyTake(pdTRUE, waiting ? 1 : idle_poll);
+        }
+    }
+}
+
+bool Server::poll(Connection& conn) {
+    auto sn = conn.sn;
+
+    // the INT pin stays low while any flag is set, clearing them all lets the next event
+    // produce a new edge; the socket status register is checked below anyway
+    auto ir = getSn_IR(sn);
+    if (ir != 0) {
+        setSn_IR(sn, ir);
+    }
+
+    auto sr = getSn_SR(sn);
+    switch (sr) {
+        case SOCK_CLOSED:
+            ::socket(sn, Sn_MR_TCP, port, 0);
+            return true;
+
+        case SOCK_INIT:
+            // the next connection starts from a clean state here rather than on its CON flag:
+            // one established between the reads of Sn_IR and Sn_SR above is served before its
+            // flag is seen
+            conn.rx_len = 0;
+            conn.pipelined = false;
+            conn.closing = false;
+            conn.requests = 0;
+            conn.last_activity = xTaskGetTickCount();
+            conn.stream.reset(sn);
+            conn.producer = nullptr;
+            ::listen(sn);
+            return true;
+
+        case SOCK_LISTEN:
+            // the idle time of a connection counts from when it was established
+            conn.last_activity = xTaskGetTickCount();
+            return false;
+
+        case SOCK_ESTABLISHED:
+        case SOCK_CLOSE_WAIT:
+            break;
+
+        default:
+            return false;
+    }
+
+    auto now = xTaskGetTickCount();
+    if (ir & Sn_IR_SENDOK) {
+        conn.stream.sent();
+        conn.last_activity = now;
+    }
+
+    // a streamed body goes on as the socket makes room, before anything else is read
+    if (conn.producer != nullptr) {
+        if (not pump(conn)) {
+            return wait(conn, now);
+        }
+        conn.last_activity = now;
+        return true;
+    }
+
+    // a client that is done sending is still owed what is on its way out
+    if (conn.closing or sr == SOCK_CLOSE_WAIT) {
+        if (not conn.stream.idle()) {
+            return wait(conn, now);
+        }
+        ::disconnect(sn);
+        return true;
+    }
+
+    // a pipelined request already in the buffer is answered before reading more
+    size_t available = getSn_RX_RSR(sn);
+    size_t space = rx_buffer_size - conn.rx_len;
+    if (available > 0 and space > 0) {
+        auto n = ::recv(sn, reinterpret_cast<uint8_t*>(conn.rx_buffer + conn.rx_len), available < space ? available : space);
+        if (n <= 0) {
+            return false;
+        }
+        conn.rx_len += n;
+        conn.last_activity = now;
+        if (conn.rx_len > statistics.rx_high_water) {
+            statistics.rx_high_water = conn.rx_len;
+        }
+    } else if (not conn.pipelined) {
+        // idle, whether between requests or before the first one
+        if (now - conn.last_activity >= keep_alive_timeout) {
+            close(conn);
+            return true;
+        }
+        return false;
+    }
+
+    // the largest buffered response must fit, so answering never waits on the socket
+    if (conn.stream.room() < head_size + tx_buffer_size + Stream::size_line + 2) {
+        conn.pipelined = true;
+        return wait(conn, now);
+    }
+
+    conn.pipelined = false;
+    switch (request.parse(conn.rx_buffer, conn.rx_len)) {
+        case Request::Status::Complete: {
+            // the request is a slice of the receive buffer, it is dropped after the response
+            bool keep = dispatch(conn, keep_alive(conn));
+            consume(conn, request.size());
+            if (not keep) {
+                close(conn);
+            }
+            return true;
+        }
+        case Request::Status::Incomplete:
+            if (conn.rx_len < rx_buffer_size) {
+                return true;
+            }
+            send(conn, request.method.empty() ? 431 : 413);
+            break;
+        case Request::Status::Invalid:
+            send(conn, 400);
+            break;
+        case Request::Status::TooLarge:
+            send(conn, 431);
+            break;
+    }
+
+    // the framing of whatever follows a rejected request is unknown, so the connection ends
+    close(conn);
+    return true;
+}
+
+bool Server::keep_alive(const Connection& conn) const {
+    if (conn.requests + 1u >= max_requests) {
+        return false;
+    }
+    auto connection = request.headers["Connection"];
+    if (request.version == "HTTP/1.0") {
+        return equals_ignore_case(connection, "keep-alive");
+    }
+    return not equals_ignore_case(connection, "close");
+}
+
+bool Server::pump(Connection& conn) {
+    auto& stream = conn.stream;
+    Response res(nullptr, 0);
+    res.attach(&stream);
+
+    bool progress = false;
+    while (conn.producer != nullptr and stream.room() >= Response::max_piece) {
+        progress = true;
+        if (not conn.producer(res, conn.piece++, conn.state)) {
+            conn.producer = nullptr;
+            stream.finish();
+        }
+    }
+    if (conn.producer != nullptr) {
+        stream.flush();
+    }
+
+    // the head is out already, a body cut short can only be signalled by closing
+    if (res.overflow() or stream.failed()) {
+        statistics.errors++;
+        conn.producer = nullptr;
+        close(conn);
+        return true;
+    }
+    return progress;
+}
+
+bool Server::wait(Connection& conn, TickType_t now) {
+    if (now - conn.last_activity < Stream::stall_timeout) {
+        waiting = true;
+        return false;
+    }
+    // the client stopped reading, what is left in the TX memory is dropped
+    statistics.errors++;
+    conn.producer = nullptr;
+    ::close(conn.sn);
+    return true;
+}
+
+bool Server::dispatch(Connection& conn, bool keep) {
+    conn.requests++;
+
+    auto route = table.find(request.method, request.path);
+    if (route == nullptr) {
+        statistics.errors++;
+        Response res(tx_buffer, tx_buffer_size);
+        res.status = table.has_path(request.path) ? 405 : 404;
+        res.write(reason(res.status));
+        return send(conn, res, keep) and keep;
+    }
+
+    current = &conn;
+    current_keep = keep;
+    Response res(tx_buffer, tx_buffer_size, start, this);
+    route->handler(request, res, arena);
+    current = nullptr;
+
+    if (res.streaming()) {
+        // the head is out already, a body cut short can only be signalled by closing
+        if (res.overflow() or conn.stream.failed()) {
+            statistics.errors++;
+            conn.producer = nullptr;
+            return false;
+        }
+        // the producer goes on in later steps, closing waits for it
+        statistics.requests++;
+        pump(conn);
+        return keep and not conn.closing;
+    }
+    if (res.overflow()) {
+        statistics.errors++;
+        res.clear();
+        res.status = 500;
+        res.write("Response too large");
+        return send(conn, res, keep) and keep;
+    }
+    statistics.requests++;
+    return send(conn, res, keep) and keep;
+}
+
+void Server::send(Connection& conn, int status, std::string_view body) {
+    Response res(tx_buffer, tx_buffer_size);
+    res.status = status;
+    res.write(body.empty() ? std::string_view(reason(status)) : body);
+    statistics.errors++;
+    send(conn, res, false);
+}
+
+bool Server::send(Connection& conn, Response& res, bool keep) {
+    // status line and headers are formatted on the stack, head and body are copied to the
+    // socket one after the other and leave in the same segment
+    char buf[head_size];
+    size_t len = head(conn, res, keep, false, buf, sizeof(buf));
+    if (len == 0) {
+        len = ::snprintf(buf, sizeof(buf), "HTTP/1.1 500 %s\r\nContent-Length: 0\r\n%s\r\n",
+            reason(500), keep ? "" : "Connection: close\r\n");
+        res.clear();
+    }
+
+    auto& stream = conn.stream;
+    stream.begin();
+    stream.write({buf, len});
+    stream.write(res.body());
+    return stream.finish();
+}
+
+size_t Server::head(const Connection& conn, const Response& res, bool keep, bool chunked, char* buf, size_t size) const {
+    size_t len = ::snprintf(buf, size, "HTTP/1.1 %d %s\r\n", res.status, reason(res.status));
+    for (auto& field : res.headers) {
+        // framing headers are always generated here
+        if (equals_ignore_case(field.name, "Content-Length") or equals_ignore_case(field.name, "Connection") or
+            equals_ignore_case(field.name, "Transfer-Encoding")) {
+            continue;
+        }
+        if (len < size) {
+            len += ::snprintf(buf + len, size - len, "%.*s: %.*s\r\n",
+                int(field.name.size()), field.name.data(), int(field.value.size()), field.value.data());
+        }
+    }
+    if (len < size and keep) {
+        len += ::snprintf(buf + len, size - len, "Connection: keep-alive\r\nKeep-Alive: timeout=%u, max=%u\r\n",
+            unsigned(keep_alive_timeout / configTICK_RATE_HZ), unsigned(max_requests - conn.requests));
+    } else if (len < size) {
+        len += ::snprintf(buf + len, size - len, "Connection: close\r\n");
+    }
+    if (len < size and chunked) {
+        len += ::snprintf(buf + len, size - len, "Transfer-Encoding: chunked\r\n\r\n");
+    } else if (len < size) {
+        len += ::snprintf(buf + len, size - len, "Content-Length: %u\r\n\r\n", unsigned(res.body().size()));
+    }
+    return len < size ? len : 0;
+}
+
+bool Server::start(void* context, Response& res, Response::Producer producer, const void* state) {
+    auto server = static_cast<Server*>(context);
+    auto conn = server->current;
+    // HTTP/1.0 has no chunked encoding, the handler's body is buffered instead
+    if (conn == nullptr or server->request.version != "HTTP/1.1") {
+        return false;
+    }
+
+    char buf[head_size];
+    size_t len = server->head(*conn, res, server->current_keep, true, buf, sizeof(buf));
+    if (len == 0) {
+        return false;
+    }
+
+    // whatever was buffered before the switch becomes the first chunk
+    auto& stream = conn->stream;
+    stream.begin();
+    stream.write({buf, len});
+    stream.chunked();
+    stream.write(res.body());
+    res.clear();
+    res.attach(&stream);
+    conn->producer = producer;
+    conn->state = state;
+    conn->piece = 0;
+    return true;
+}
+
+void Server::consume(Connection& conn, size_t len) {
+    if (arena.high_water() > statistics.arena_high_water) {
+        statistics.arena_high_water = arena.high_water();
+    }
+    arena.reset();
+
+    // bytes past the request belong to the next pipelined one
+    conn.rx_len -= len;
+    ::memmove(conn.rx_buffer, conn.rx_buffer + len, conn.rx_len);
+    conn.pipelined = conn.rx_len > 0;
+}
+
+void Server::close(Connection& conn) {
+    arena.reset();
+    conn.rx_len = 0;
+    conn.pipelined = false;
+    if (conn.closing) {
+        return;
+    }
+    // the rest of the response goes out first, see poll
+    conn.closing = true;
+    if (conn.producer == nullptr and conn.stream.idle()) {
+        ::disconnect(conn.sn);
+    }
+}
@@ -0,0 +1,137 @@
+#ifndef PROJECT_NET_HTTP_SERVER_HPP
+#define PROJECT_NET_HTTP_SERVER_HPP
+
+#include "net/http/request.hpp"
+#include "net/http/response.hpp"
+#include "net/http/routes.hpp"
+#include "net/http/stream.hpp"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Project::net::http {
+    class Server;
+}
+
+/// Allocation-free HTTP server on W5500 TCP sockets.
+/// The request is received into a fixed buffer and parsed in place, the handler writes the
+/// body into a fixed transmit buffer, and anything else a handler needs for the duration of
+/// a request comes from a per-connection arena that is reset after each response, so
+/// serving a request never touches the heap.
+///
+/// Several sockets listen on the same port, each driven by its own small state machine.
+/// One task steps them in turn and never waits on a single client, so a slow client does
+/// not stall the others. A response is built within one step, which lets the parser, arena
+/// and transmit buffer be shared by every socket; the receive buffer and the send state are
+/// per connection. Sending never blocks: a request is only taken once the socket TX memory
+/// has room for its response, and the next SEND is issued on the SENDOK interrupt. The task
+/// sleeps until the W5500 INT pin signals a socket event.
+///
+/// Connections are persistent: HTTP/1.1 clients keep the socket open across requests until
+/// it is idle for too long or has served its request limit, and pipelined requests that
+/// arrive back to back are answered in order from the receive buffer. A buffered response
+/// carries a Content-Length computed by the server, so framing never depends on a handler.
+///
+/// A handler whose body can outgrow the transmit buffer calls Response::chunked() with a
+/// producer, which the server calls for one piece after another whenever the socket has
+/// room, each piece going straight into the socket TX memory as a chunked body, see Stream.
+/// Other connections are served in between.
+class Project::net::http::Server {
+public:
+    static constexpr size_t rx_buffer_size = 768;
+    static constexpr size_t tx_buffer_size = 512;
+    static constexpr size_t head_size = 224;  ///< status line and headers
+    static constexpr TickType_t idle_poll = pdMS_TO_TICKS(100); ///< fallback in case an edge was missed
+
+    using Arena = http::Arena;
+
+    /// receive and send state of one socket
+    struct Connection {
+        char rx_buffer[rx_buffer_size];
+        size_t rx_len;
+        bool pipelined;          ///< rx_buffer holds bytes of a request that was not parsed yet
+        bool closing;            ///< disconnect once the response is out
+        uint16_t requests;       ///< requests answered on this connection
+        TickType_t last_activity;
+        uint8_t sn;
+        Stream stream;
+        Response::Producer producer;  ///< body still being streamed, nullptr if none
+        const void* state;            ///< context of the producer
+        size_t piece;                 ///< index of the next piece
+    };
+
+    struct Config {
+        uint16_t port;
+        uint8_t socket = 7;              ///< W5500 socket of the first connection, the others follow
+        Connection* connections;
+        size_t n_connections = 1;
+        Routes routes;                   ///< usually a constexpr RouteTable
+        TickType_t keep_alive_timeout = pdMS_TO_TICKS(5000); ///< close a connection idle for this long
+        uint16_t max_requests = 100;     ///< close a connection after this many requests
+        UBaseType_t priority = tskIDLE_PRIORITY + 2;
+    };
+
+    struct Stats {
+        uint32_t requests;
+        uint32_t errors;           ///< requests answered by the server with an error status
+        size_t rx_high_water;      ///< largest request received
+        size_t arena_high_water;   ///< most arena bytes used by a single request
+    };
+
+    explicit Server(Config config)
+        : port(config.port), first_socket(config.socket), connections(config.connections),
+          n_connections(config.n_connections), table(config.routes),
+          keep_alive_timeout(config.keep_alive_timeout), max_requests(config.max_requests),
+          priority(config.priority) {}
+
+    /// serve requests forever in a task of its own
+    /// @return false if the sockets are out of range
+    bool init();
+
+    /// advance the state machine of a connection once
+    /// @return false if there was nothing to do
+    bool poll(Connection& conn);
+
+    const Stats& stats() const { return statistics; }
+    const Routes& routes() const { return table; }
+
+private:
+    static constexpr size_t stack_size = 384;  ///< handlers run here
+
+    static void task_function(void* self);
+    [[noreturn]] void serve();
+    bool keep_alive(const Connection& conn) const;
+    bool pump(Connection& conn);
+    bool wait(Connection& conn, TickType_t now);
+    bool dispatch(Connection& conn, bool keep);
+    void send(Connection& conn, int status, std::string_view body = {});
+    bool send(Connection& conn, Response& res, bool keep);
+    size_t head(const Connection& conn, const Response& res, bool keep, bool chunked, char* buf, size_t size) const;
+    static bool start(void* context, Response& res, Response::Producer producer, const void* state);
+    void consume(Connection& conn, size_t len);
+    void close(Connection& conn);
+
+    uint16_t port;
+    uint8_t first_socket;
+    Connection* connections;
+    size_t n_connections;
+    Routes table;
+    TickType_t keep_alive_timeout;
+    uint16_t max_requests;
+    UBaseType_t priority;
+
+    char tx_buffer[tx_buffer_size] = {};
+    Request request;
+    Arena arena;
+    Connection* current = nullptr;  ///< connection of the request being dispatched
+    bool current_keep = false;
+    bool waiting = false;           ///< a connection waits for TX memory, poll again soon
+    Stats statistics = {};
+    TaskHandle_t task = nullptr;
+    StaticTask_t task_buffer = {};
+    StackType_t stack[stack_size] = {};
+};
+
+#endif // PROJECT_NET_HTTP_SERVER_HPP
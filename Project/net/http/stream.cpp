@@ -0,0 +1,192 @@
+#include "net/http/stream.hpp"
+#include "socket.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace Project::net::http;
+
+void Stream::reset(uint8_t sn) {
+    *this = {};
+    this->sn = sn;
+}
+
+void Stream::begin() {
+    if (open) {
+        close_window();
+    }
+    chunks = false;
+}
+
+void Stream::chunked() {
+    // bytes written so far stay unsent and go out together with the first chunk
+    if (open) {
+        close_window();
+    }
+    chunks = true;
+}
+
+size_t Stream::room() {
+    if (error) {
+        return 0;
+    }
+    return open ? capacity - window_len - staged : window_room();
+}
+
+size_t Stream::write(std::string_view str) {
+    size_t done = 0;
+    while (done < str.size() and not error) {
+        if (not open and not open_window()) {
+            break;
+        }
+
+        auto data = str.data() + done;
+        size_t n = str.size() - done;
+        size_t room = capacity - window_len - staged;
+        if (room == 0) {
+            // the window is used up, the next one gets whatever the socket freed meanwhile
+            close_window();
+            transmit();
+            continue;
+        }
+        if (n > room) {
+            n = room;
+        }
+
+        if (staged == 0 and n >= staging_size) {
+            put(data, n);
+            window_len += n;
+        } else {
+            if (n > staging_size - staged) {
+                n = staging_size - staged;
+            }
+            ::memcpy(staging + staged, data, n);
+            staged += n;
+            if (staged == staging_size) {
+                flush_staging();
+            }
+        }
+        done += n;
+    }
+    return done;
+}
+
+bool Stream::flush() {
+    if (open) {
+        close_window();
+    }
+    transmit();
+    return not error;
+}
+
+bool Stream::finish() {
+    if (open) {
+        close_window();
+    }
+    if (chunks and not error) {
+        // every window left room for it
+        chunks = false;
+        put("0\r\n\r\n", tail);
+    }
+    return flush();
+}
+
+void Stream::sent() {
+    sending = false;
+    transmit();
+}
+
+size_t Stream::window_room() {
+    // the free size may or may not count bytes that were written but not sent yet,
+    // leaving them out again only makes the window smaller
+    size_t overhead = (chunks ? size_line + 2 : 0) + tail;
+    size_t free = getSn_TX_FSR(sn);
+    free = free > unsent ? free - unsent : 0;
+    if (free <= overhead) {
+        return 0;
+    }
+    free -= overhead;
+    return free < max_chunk ? free : max_chunk;
+}
+
+bool Stream::open_window() {
+    if (not connected()) {
+        return fail();
+    }
+    capacity = window_room();
+    if (capacity == 0) {
+        // the TX memory is full, writers are expected to check room() first
+        return fail();
+    }
+
+    window_start = getSn_TX_WR(sn);
+    if (chunks) {
+        setSn_TX_WR(sn, window_start + size_line);
+        unsent += size_line;
+    }
+    window_len = 0;
+    open = true;
+    return true;
+}
+
+void Stream::close_window() {
+    flush_staging();
+    open = false;
+    if (not chunks) {
+        return;
+    }
+    if (window_len == 0) {
+        // an empty chunk would end the body, give back the reserved size line
+        setSn_TX_WR(sn, window_start);
+        unsent -= size_line;
+        return;
+    }
+
+    // the TX memory offset wraps around by itself, just like in wiz_send_data
+    char line[size_line + 1];
+    ::snprintf(line, sizeof(line), "%04x\r\n", unsigned(window_len));
+    uint32_t address = (uint32_t(window_start) << 8) + (WIZCHIP_TXBUF_BLOCK(sn) << 3);
+    WIZCHIP_WRITE_BUF(address, reinterpret_cast<uint8_t*>(line), size_line);
+    put("\r\n", 2);
+}
+
+void Stream::flush_staging() {
+    if (staged == 0) {
+        return;
+    }
+    put(staging, staged);
+    window_len += staged;
+    staged = 0;
+}
+
+void Stream::put(const void* data, size_t len) {
+    wiz_send_data(sn, static_cast<uint8_t*>(const_cast<void*>(data)), len);
+    unsent += len;
+}
+
+void Stream::transmit() {
+    // the socket takes one SEND at a time, the rest waits for sent()
+    if (error or open or sending or unsent == 0) {
+        return;
+    }
+    if (not connected()) {
+        fail();
+        return;
+    }
+    setSn_CR(sn, Sn_CR_SEND);
+    while (getSn_CR(sn)) {}
+    sending = true;
+    unsent = 0;
+}
+
+bool Stream::connected() const {
+    auto sr = getSn_SR(sn);
+    return sr == SOCK_ESTABLISHED or sr == SOCK_CLOSE_WAIT;
+}
+
+bool Stream::fail() {
+    error = true;
+    open = false;
+    sending = false;
+    staged = 0;
+    return false;
+}
@@ -0,0 +1,85 @@
+#ifndef PROJECT_NET_HTTP_STREAM_HPP
+#define PROJECT_NET_HTTP_STREAM_HPP
+
+#include "FreeRTOS.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Project::net::http {
+    class Stream;
+}
+
+/// Response bytes written straight into the W5500 socket TX memory of one connection.
+/// Data is copied to the socket as it is written, so a response is never assembled in RAM.
+/// Nothing here waits: a write only takes what fits in the free TX memory, see room(), and a
+/// SEND is issued right away unless the previous one is still in flight, in which case the
+/// owner calls sent() on the SENDOK interrupt and whatever was written meanwhile follows.
+/// Small writes, e.g. single JSON tokens, are coalesced to save SPI transactions.
+///
+/// In chunked mode every flush() ends one chunk of a `Transfer-Encoding: chunked` body.
+/// The chunk size line is reserved at the start of the chunk and filled in when the chunk
+/// is closed, once the size is known.
+class Project::net::http::Stream {
+public:
+    static constexpr size_t size_line = 6;      ///< "xxxx\r\n", fixed width so it can be written last
+    static constexpr size_t max_chunk = 0x800;  ///< the default socket TX memory size
+    static constexpr size_t tail = 5;           ///< "0\r\n\r\n", kept free so a chunked body can always end
+    static constexpr size_t staging_size = 64;
+    static constexpr TickType_t stall_timeout = pdMS_TO_TICKS(2000); ///< give up on a client that stops reading
+
+    /// take over a newly connected socket
+    void reset(uint8_t sn);
+
+    /// start a response, the previous one may still be on its way out
+    void begin();
+
+    /// write everything that follows as chunks
+    void chunked();
+
+    /// @return number of bytes a write takes now
+    size_t room();
+
+    /// @return number of bytes accepted, less than str.size() if the TX memory is full or the
+    /// connection failed, which fails the stream
+    size_t write(std::string_view str);
+
+    /// end the current chunk and send everything written so far, or leave it to sent() if
+    /// a SEND is in flight
+    /// @return false if the connection failed at any point
+    bool flush();
+
+    /// end the body with a zero-length chunk in chunked mode and flush
+    bool finish();
+
+    /// to be called when the socket raises SENDOK
+    void sent();
+
+    /// true once everything written went out, or the stream failed
+    bool idle() const { return error or (not sending and unsent == 0 and not open); }
+    bool failed() const { return error; }
+
+private:
+    size_t window_room();
+    bool open_window();
+    void close_window();
+    void flush_staging();
+    void put(const void* data, size_t len);
+    void transmit();
+    bool connected() const;
+    bool fail();
+
+    uint8_t sn = 0;
+    bool chunks = false;
+    bool open = false;
+    bool sending = false;       ///< a SEND was issued and SENDOK was not seen yet
+    bool error = false;
+    uint16_t window_start = 0;  ///< TX write pointer where the window, or its size line, starts
+    size_t window_len = 0;      ///< data bytes of the window already in TX memory
+    size_t capacity = 0;
+    size_t unsent = 0;          ///< bytes in TX memory since the last SEND
+    uint8_t staging[staging_size] = {};
+    size_t staged = 0;
+};
+
+#endif // PROJECT_NET_HTTP_STREAM_HPP
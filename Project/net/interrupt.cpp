@@ -0,0 +1,48 @@
+#include "net/interrupt.hpp"
+#include "gpio.h"
+#include "wizchip/ethernet.h"
+#include "socket.h"
+
+static TaskHandle_t tasks[Project::net::max_interrupt_tasks] = {};
+static uint8_t socket_mask = 0;
+
+bool Project::net::notify_on_interrupt(TaskHandle_t task, uint8_t sockets) {
+    bool added = false;
+    taskENTER_CRITICAL();
+    for (auto& slot : tasks) {
+        if (slot == task or slot == nullptr) {
+            slot = task;
+            added = true;
+            break;
+        }
+    }
+    if (added) {
+        socket_mask |= sockets;
+    }
+    taskEXIT_CRITICAL();
+
+    // SIMR is written outside the critical section, the SPI bus may block; a task that
+    // registers meanwhile leaves a newer mask behind, which is written on the next round
+    for (uint8_t written = 0;;) {
+        taskENTER_CRITICAL();
+        uint8_t mask = socket_mask;
+        taskEXIT_CRITICAL();
+        if (mask == written) {
+            break;
+        }
+        setSIMR(mask);
+        written = mask;
+    }
+    return added;
+}
+
+extern "C" void Wizchip_IRQHandler() {
+    __HAL_GPIO_EXTI_CLEAR_IT(INT_Pin);
+    BaseType_t woken = pdFALSE;
+    for (auto task : tasks) {
+        if (task) {
+            vTaskNotifyGiveFromISR(task, &woken);
+        }
+    }
+    portYIELD_FROM_ISR(woken);
+}
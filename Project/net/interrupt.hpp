@@ -0,0 +1,20 @@
+#ifndef PROJECT_NET_INTERRUPT_HPP
+#define PROJECT_NET_INTERRUPT_HPP
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Project::net {
+    static constexpr size_t max_interrupt_tasks = 4;
+
+    /// notify a task on every falling edge of the W5500 INT pin, and let the given sockets
+    /// raise the pin
+    /// @param sockets bit mask of W5500 sockets, their Sn_IMR is set up by the caller
+    /// @note the pin is shared by every socket, each task reads and clears the flags of its own
+    /// @return false if the task list is full
+    bool notify_on_interrupt(TaskHandle_t task, uint8_t sockets);
+}
+
+#endif // PROJECT_NET_INTERRUPT_HPP
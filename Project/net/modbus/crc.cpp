@@ -0,0 +1,26 @@
+#include "net/modbus/crc.hpp"
+
+// the CRC unit of the F103 only does CRC-32 over words, so the table it is; generated at
+// compile time, it takes 512 bytes of flash
+struct Table {
+    uint16_t values[256];
+};
+
+static constexpr Table table = [] {
+    Table res = {};
+    for (unsigned i = 0; i < 256; ++i) {
+        uint16_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = crc & 1 ? (crc >> 1) ^ 0xA001 : crc >> 1;
+        }
+        res.values[i] = crc;
+    }
+    return res;
+}();
+
+uint16_t Project::net::modbus::crc16(const uint8_t* data, size_t len, uint16_t crc) {
+    for (size_t i = 0; i < len; ++i) {
+        crc = (crc >> 8) ^ table.values[(crc ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
@@ -0,0 +1,13 @@
+#ifndef PROJECT_NET_MODBUS_CRC_HPP
+#define PROJECT_NET_MODBUS_CRC_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Project::net::modbus {
+    /// CRC-16/MODBUS, reflected polynomial 0xA001, one table lookup per byte
+    /// @note a frame followed by its CRC, low byte first, yields 0
+    uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF);
+}
+
+#endif // PROJECT_NET_MODBUS_CRC_HPP
@@ -0,0 +1,13 @@
+#include "net/modbus/polls.hpp"
+
+using namespace Project::net::modbus;
+
+int Polls::find(uint8_t slave, Table table, uint16_t address, uint16_t count) const {
+    for (size_t i = 0; i < n_reads; ++i) {
+        auto& read = reads[i];
+        if (read.slave == slave and read.table == table and read.address <= address and uint32_t(address) + count <= read.end()) {
+            return int(i);
+        }
+    }
+    return -1;
+}
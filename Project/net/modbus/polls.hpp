@@ -0,0 +1,136 @@
+#ifndef PROJECT_NET_MODBUS_POLLS_HPP
+#define PROJECT_NET_MODBUS_POLLS_HPP
+
+#include "net/modbus/registers.hpp"
+#include "FreeRTOS.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Project::net::modbus {
+    struct Poll;
+    class Polls;
+    template <size_t N> class PollTable;
+
+    /// most values a single read may return
+    constexpr uint16_t max_read(Table table) {
+        return table == Table::Coils or table == Table::DiscreteInputs ? 2000 : 125;
+    }
+}
+
+/// a range of one slave to be read every period
+struct Project::net::modbus::Poll {
+    uint8_t slave = 0;
+    Table table = Table::HoldingRegisters;
+    uint16_t address = 0;
+    uint16_t count = 0;
+    TickType_t period = 0;
+
+    constexpr uint32_t end() const { return uint32_t(address) + count; }
+};
+
+/// Read-only view of a poll table, see PollTable.
+class Project::net::modbus::Polls {
+public:
+    constexpr Polls(const Poll* reads, const uint16_t* offsets, size_t n_reads, size_t n_words)
+        : reads(reads), offsets(offsets), n_reads(n_reads), n_words(n_words) {}
+
+    /// merged read that covers a range
+    /// @return its index, or -1 if no read does
+    int find(uint8_t slave, Table table, uint16_t address, uint16_t count) const;
+
+    const Poll* begin() const { return reads; }
+    const Poll* end() const { return reads + n_reads; }
+    size_t len() const { return n_reads; }
+
+    /// first cache word of a merged read
+    uint16_t offset(size_t read) const { return offsets[read]; }
+
+    /// cache words taken by every read, one per register or bit
+    size_t words() const { return n_words; }
+
+private:
+    const Poll* reads;
+    const uint16_t* offsets;
+    size_t n_reads;
+    size_t n_words;
+};
+
+/// Poll table merged at compile time.
+/// Ranges of the same slave and table that overlap or touch are read with a single request,
+/// as long as it stays within the limit of the function, at the shortest of their periods.
+/// Declared constexpr, the merged reads live in flash.
+/// @code
+/// static constexpr PollTable polls({
+///     {.slave=10, .table=Table::InputRegisters, .address=0, .count=10, .period=pdMS_TO_TICKS(500)},
+///     {.slave=10, .table=Table::InputRegisters, .address=10, .count=6, .period=pdMS_TO_TICKS(1000)},
+/// });
+/// static_assert(polls.valid(), "Invalid poll");
+/// static uint16_t cache[polls.words()];
+/// @endcode
+template <size_t N>
+class Project::net::modbus::PollTable {
+public:
+    static_assert(N > 0, "Poll table must not be empty");
+
+    constexpr explicit PollTable(const Poll (&list)[N]) {
+        Poll sorted[N] = {};
+        for (size_t i = 0; i < N; ++i) {
+            size_t j = i;
+            for (; j > 0 and before(list[i], sorted[j - 1]); --j) {
+                sorted[j] = sorted[j - 1];
+            }
+            sorted[j] = list[i];
+        }
+
+        for (size_t i = 0; i < N; ++i) {
+            auto& poll = sorted[i];
+            if (poll.count == 0 or poll.count > max_read(poll.table) or poll.end() > 0x10000 or poll.period == 0) {
+                return;  // valid() stays false
+            }
+            if (n_reads > 0) {
+                auto& last = reads[n_reads - 1];
+                uint32_t end = poll.end() > last.end() ? poll.end() : last.end();
+                if (last.slave == poll.slave and last.table == poll.table and poll.address <= last.end() and
+                    end - last.address <= max_read(poll.table)) {
+                    last.count = uint16_t(end - last.address);
+                    last.period = poll.period < last.period ? poll.period : last.period;
+                    continue;
+                }
+            }
+            reads[n_reads++] = poll;
+        }
+
+        for (size_t i = 0; i < n_reads; ++i) {
+            offsets[i] = uint16_t(n_words);
+            n_words += reads[i].count;
+        }
+        ok = true;
+    }
+
+    /// false if a poll is empty, too long for one request or has no period
+    constexpr bool valid() const { return ok; }
+
+    /// size of the cache, one word per register or bit
+    constexpr size_t words() const { return n_words; }
+
+    /// requests sent once adjacent ranges are merged
+    constexpr size_t n_requests() const { return n_reads; }
+
+    constexpr Polls view() const { return {reads, offsets, n_reads, n_words}; }
+    constexpr operator Polls() const { return view(); }
+
+private:
+    static constexpr bool before(const Poll& a, const Poll& b) {
+        if (a.slave != b.slave) return a.slave < b.slave;
+        if (a.table != b.table) return a.table < b.table;
+        return a.address < b.address;
+    }
+
+    Poll reads[N] = {};
+    uint16_t offsets[N] = {};
+    size_t n_reads = 0;
+    size_t n_words = 0;
+    bool ok = false;
+};
+
+#endif // PROJECT_NET_MODBUS_POLLS_HPP
@@ -0,0 +1,184 @@
+#include "net/modbus/registers.hpp"
+#include <cstring>
+
+using namespace Project::net::modbus;
+
+static constexpr uint16_t max_read_bits = 2000;
+static constexpr uint16_t max_read_words = 125;
+static constexpr uint16_t max_write_bits = 1968;
+static constexpr uint16_t max_write_words = 123;
+
+static uint16_t get16(const uint8_t* buf) {
+    return uint16_t(buf[0] << 8 | buf[1]);
+}
+
+static void put16(uint8_t* buf, uint16_t value) {
+    buf[0] = uint8_t(value >> 8);
+    buf[1] = uint8_t(value);
+}
+
+static size_t exception(uint8_t* res, uint8_t function, Exception code) {
+    res[0] = function | 0x80;
+    res[1] = uint8_t(code);
+    return 2;
+}
+
+/// call fn(entry, first index in the entry, first index in the request, n) for every entry
+/// a range spans, the range being known to be mapped
+template <typename F>
+static void walk(const Entry* entry, uint16_t address, uint16_t count, F&& fn) {
+    for (uint16_t i = 0; i < count; ++entry) {
+        uint16_t offset = uint16_t(address + i - entry->address);
+        uint16_t n = count - i < entry->count - offset ? count - i : entry->count - offset;
+        fn(*entry, offset, i, n);
+        i += n;
+    }
+}
+
+const Entry* Registers::find(Table table, uint16_t address, uint16_t count) const {
+    // last entry that starts at or before address
+    size_t lo = 0, hi = n_entries;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        auto& entry = entries[mid];
+        if (entry.table < table or (entry.table == table and entry.address <= address)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0 or entries[lo - 1].table != table or entries[lo - 1].end() <= address) {
+        return nullptr;
+    }
+
+    // the following entries must carry on without a gap
+    auto first = &entries[lo - 1];
+    uint32_t end = uint32_t(address) + count;
+    for (auto entry = first; entry->end() < end; ++entry) {
+        auto next = entry + 1;
+        if (next == entries + n_entries or next->table != table or next->address != entry->end()) {
+            return nullptr;
+        }
+    }
+    return first;
+}
+
+size_t Registers::handle(const uint8_t* req, size_t len, uint8_t* res) const {
+    if (len == 0) {
+        return 0;
+    }
+
+    // every supported function starts with an address and a count, each case checks the length
+    uint8_t function = req[0];
+    res[0] = function;
+    uint16_t address = len >= 5 ? get16(req + 1) : 0;
+    uint16_t count = len >= 5 ? get16(req + 3) : 0;
+
+    switch (Function(function)) {
+        case Function::ReadCoils:
+        case Function::ReadDiscreteInputs: {
+            if (len != 5 or count == 0 or count > max_read_bits) {
+                return exception(res, function, Exception::IllegalDataValue);
+            }
+            auto table = Function(function) == Function::ReadCoils ? Table::Coils : Table::DiscreteInputs;
+            auto entry = find(table, address, count);
+            if (entry == nullptr) {
+                return exception(res, function, Exception::IllegalDataAddress);
+            }
+            size_t bytes = (count + 7) / 8;
+            res[1] = uint8_t(bytes);
+            ::memset(res + 2, 0, bytes);
+            walk(entry, address, count, [res](const Entry& e, uint16_t offset, uint16_t i, uint16_t n) {
+                for (uint16_t k = 0; k < n; ++k, ++i) {
+                    if (e.bits[offset + k]) {
+                        res[2 + i / 8] |= uint8_t(1 << (i % 8));
+                    }
+                }
+            });
+            return 2 + bytes;
+        }
+
+        case Function::ReadHoldingRegisters:
+        case Function::ReadInputRegisters: {
+            if (len != 5 or count == 0 or count > max_read_words) {
+                return exception(res, function, Exception::IllegalDataValue);
+            }
+            auto table = Function(function) == Function::ReadHoldingRegisters ? Table::HoldingRegisters : Table::InputRegisters;
+            auto entry = find(table, address, count);
+            if (entry == nullptr) {
+                return exception(res, function, Exception::IllegalDataAddress);
+            }
+            res[1] = uint8_t(count * 2);
+            walk(entry, address, count, [res](const Entry& e, uint16_t offset, uint16_t i, uint16_t n) {
+                for (uint16_t k = 0; k < n; ++k) {
+                    put16(res + 2 + 2 * (i + k), e.words[offset + k]);
+                }
+            });
+            return 2 + count * 2;
+        }
+
+        case Function::WriteSingleCoil: {
+            // count is the value here, 0xFF00 for on and 0x0000 for off
+            if (len != 5 or (count != 0xFF00 and count != 0x0000)) {
+                return exception(res, function, Exception::IllegalDataValue);
+            }
+            auto entry = find(Table::Coils, address, 1);
+            if (entry == nullptr) {
+                return exception(res, function, Exception::IllegalDataAddress);
+            }
+            entry->bits[address - entry->address] = count == 0xFF00;
+            ::memmove(res, req, 5);
+            return 5;
+        }
+
+        case Function::WriteSingleRegister: {
+            if (len != 5) {
+                return exception(res, function, Exception::IllegalDataValue);
+            }
+            auto entry = find(Table::HoldingRegisters, address, 1);
+            if (entry == nullptr) {
+                return exception(res, function, Exception::IllegalDataAddress);
+            }
+            entry->words[address - entry->address] = count;
+            ::memmove(res, req, 5);
+            return 5;
+        }
+
+        case Function::WriteMultipleCoils: {
+            if (len < 6 or count == 0 or count > max_write_bits or req[5] != (count + 7) / 8 or len != 6u + req[5]) {
+                return exception(res, function, Exception::IllegalDataValue);
+            }
+            auto entry = find(Table::Coils, address, count);
+            if (entry == nullptr) {
+                return exception(res, function, Exception::IllegalDataAddress);
+            }
+            const uint8_t* data = req + 6;
+            walk(entry, address, count, [data](const Entry& e, uint16_t offset, uint16_t i, uint16_t n) {
+                for (uint16_t k = 0; k < n; ++k, ++i) {
+                    e.bits[offset + k] = data[i / 8] >> (i % 8) & 1;
+                }
+            });
+            ::memmove(res, req, 5);
+            return 5;
+        }
+
+        case Function::WriteMultipleRegisters: {
+            if (len < 6 or count == 0 or count > max_write_words or req[5] != count * 2 or len != 6u + req[5]) {
+                return exception(res, function, Exception::IllegalDataValue);
+            }
+            auto entry = find(Table::HoldingRegisters, address, count);
+            if (entry == nullptr) {
+                return exception(res, function, Exception::IllegalDataAddress);
+            }
+            const uint8_t* data = req + 6;
+            walk(entry, address, count, [data](const Entry& e, uint16_t offset, uint16_t i, uint16_t n) {
+                for (uint16_t k = 0; k < n; ++k) {
+                    e.words[offset + k] = get16(data + 2 * (i + k));
+                }
+            });
+            ::memmove(res, req, 5);
+            return 5;
+        }
+    }
+    return exception(res, function, Exception::IllegalFunction);
+}
@@ -0,0 +1,181 @@
+#ifndef PROJECT_NET_MODBUS_REGISTERS_HPP
+#define PROJECT_NET_MODBUS_REGISTERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Project::net::modbus {
+    /// the four data tables of the Modbus data model
+    enum class Table : uint8_t {
+        Coils,             ///< bits, read and written by the master
+        DiscreteInputs,    ///< bits, read only
+        HoldingRegisters,  ///< 16 bit words, read and written by the master
+        InputRegisters,    ///< 16 bit words, read only
+    };
+
+    enum class Function : uint8_t {
+        ReadCoils = 0x01,
+        ReadDiscreteInputs = 0x02,
+        ReadHoldingRegisters = 0x03,
+        ReadInputRegisters = 0x04,
+        WriteSingleCoil = 0x05,
+        WriteSingleRegister = 0x06,
+        WriteMultipleCoils = 0x0F,
+        WriteMultipleRegisters = 0x10,
+    };
+
+    enum class Exception : uint8_t {
+        IllegalFunction = 0x01,
+        IllegalDataAddress = 0x02,
+        IllegalDataValue = 0x03,
+    };
+
+    /// largest PDU, function code included
+    static constexpr size_t max_pdu = 253;
+
+    struct Entry;
+    class Registers;
+    template <size_t N> class RegisterMap;
+
+    /// a bit variable, or an array of them, at consecutive addresses
+    constexpr Entry coils(uint16_t address, volatile bool& value);
+    template <size_t N> constexpr Entry coils(uint16_t address, volatile bool (&values)[N]);
+    constexpr Entry discrete_inputs(uint16_t address, volatile bool& value);
+    template <size_t N> constexpr Entry discrete_inputs(uint16_t address, volatile bool (&values)[N]);
+
+    /// a word variable, or an array of them, at consecutive addresses
+    constexpr Entry holding_registers(uint16_t address, volatile uint16_t& value);
+    template <size_t N> constexpr Entry holding_registers(uint16_t address, volatile uint16_t (&values)[N]);
+    constexpr Entry input_registers(uint16_t address, volatile uint16_t& value);
+    template <size_t N> constexpr Entry input_registers(uint16_t address, volatile uint16_t (&values)[N]);
+}
+
+/// consecutive addresses of one table backed by a variable of the application
+struct Project::net::modbus::Entry {
+    Table table = Table::Coils;
+    uint16_t address = 0;
+    uint16_t count = 0;
+    volatile bool* bits = nullptr;       ///< for coils and discrete inputs
+    volatile uint16_t* words = nullptr;  ///< for holding and input registers
+
+    constexpr bool is_bit() const { return table == Table::Coils or table == Table::DiscreteInputs; }
+    constexpr uint32_t end() const { return uint32_t(address) + count; }
+};
+
+/// Read-only view of a register map, shared by the RTU slave and the TCP server.
+class Project::net::modbus::Registers {
+public:
+    constexpr Registers(const Entry* entries, size_t n_entries) : entries(entries), n_entries(n_entries) {}
+
+    /// execute the request PDU and write the response PDU, an exception response if the
+    /// request is refused
+    /// @param req function code and data
+    /// @param res at least max_pdu bytes, may be req to answer in place
+    /// @return response length
+    size_t handle(const uint8_t* req, size_t len, uint8_t* res) const;
+
+    /// first entry of a range of addresses, if every address in it is mapped
+    /// @return nullptr if any of them is not
+    const Entry* find(Table table, uint16_t address, uint16_t count) const;
+
+    const Entry* begin() const { return entries; }
+    const Entry* end() const { return entries + n_entries; }
+    size_t len() const { return n_entries; }
+
+private:
+    const Entry* entries;
+    size_t n_entries;
+};
+
+/// Register map built at compile time.
+/// Every entry points straight at a variable of the application, so a read copies the current
+/// value and a write stores into it, with no callbacks or shadow copies. The constructor sorts
+/// the entries by table and address; declared constexpr, the map lives in flash and a lookup
+/// is a binary search.
+/// @code
+/// static uint16_t setpoints[4];
+/// static bool relays[8];
+/// static constexpr RegisterMap map({
+///     holding_registers(0, setpoints),
+///     coils(0, relays),
+/// });
+/// static_assert(map.valid(), "Overlapping registers");
+/// @endcode
+/// @note accesses to a single word or bit are atomic; a write of several registers is not
+/// atomic as a whole
+template <size_t N>
+class Project::net::modbus::RegisterMap {
+public:
+    static_assert(N > 0, "Register map must not be empty");
+
+    constexpr explicit RegisterMap(const Entry (&list)[N]) {
+        for (size_t i = 0; i < N; ++i) {
+            size_t j = i;
+            for (; j > 0 and before(list[i], entries[j - 1]); --j) {
+                entries[j] = entries[j - 1];
+            }
+            entries[j] = list[i];
+        }
+    }
+
+    /// false if an entry is empty, runs past address 0xFFFF or overlaps another one
+    constexpr bool valid() const {
+        for (size_t i = 0; i < N; ++i) {
+            if (entries[i].count == 0 or entries[i].end() > 0x10000) {
+                return false;
+            }
+            if (i > 0 and entries[i].table == entries[i - 1].table and entries[i].address < entries[i - 1].end()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr Registers view() const { return {entries, N}; }
+    constexpr operator Registers() const { return view(); }
+
+private:
+    static constexpr bool before(const Entry& a, const Entry& b) {
+        return a.table < b.table or (a.table == b.table and a.address < b.address);
+    }
+
+    Entry entries[N] = {};
+};
+
+constexpr Project::net::modbus::Entry Project::net::modbus::coils(uint16_t address, volatile bool& value) {
+    return {Table::Coils, address, 1, &value, nullptr};
+}
+
+template <size_t N>
+constexpr Project::net::modbus::Entry Project::net::modbus::coils(uint16_t address, volatile bool (&values)[N]) {
+    return {Table::Coils, address, uint16_t(N), values, nullptr};
+}
+
+constexpr Project::net::modbus::Entry Project::net::modbus::discrete_inputs(uint16_t address, volatile bool& value) {
+    return {Table::DiscreteInputs, address, 1, &value, nullptr};
+}
+
+template <size_t N>
+constexpr Project::net::modbus::Entry Project::net::modbus::discrete_inputs(uint16_t address, volatile bool (&values)[N]) {
+    return {Table::DiscreteInputs, address, uint16_t(N), values, nullptr};
+}
+
+constexpr Project::net::modbus::Entry Project::net::modbus::holding_registers(uint16_t address, volatile uint16_t& value) {
+    return {Table::HoldingRegisters, address, 1, nullptr, &value};
+}
+
+template <size_t N>
+constexpr Project::net::modbus::Entry Project::net::modbus::holding_registers(uint16_t address, volatile uint16_t (&values)[N]) {
+    return {Table::HoldingRegisters, address, uint16_t(N), nullptr, values};
+}
+
+constexpr Project::net::modbus::Entry Project::net::modbus::input_registers(uint16_t address, volatile uint16_t& value) {
+    return {Table::InputRegisters, address, 1, nullptr, &value};
+}
+
+template <size_t N>
+constexpr Project::net::modbus::Entry Project::net::modbus::input_registers(uint16_t address, volatile uint16_t (&values)[N]) {
+    return {Table::InputRegisters, address, uint16_t(N), nullptr, values};
+}
+
+#endif // PROJECT_NET_MODBUS_REGISTERS_HPP
@@ -0,0 +1,237 @@
+#include "net/modbus/rtu_master.hpp"
+#include "net/modbus/crc.hpp"
+#include <atomic>
+
+using namespace Project::net::modbus;
+
+static uint8_t function_of(Table table) {
+    switch (table) {
+        case Table::Coils: return uint8_t(Function::ReadCoils);
+        case Table::DiscreteInputs: return uint8_t(Function::ReadDiscreteInputs);
+        case Table::HoldingRegisters: return uint8_t(Function::ReadHoldingRegisters);
+        case Table::InputRegisters: return uint8_t(Function::ReadInputRegisters);
+    }
+    return 0;
+}
+
+static bool is_bits(Table table) {
+    return table == Table::Coils or table == Table::DiscreteInputs;
+}
+
+/// a is at or after b, across the wrap of the tick counter
+static bool reached(TickType_t a, TickType_t b) {
+    return int32_t(a - b) >= 0;
+}
+
+RTUMaster::RTUMaster(Config config)
+    : stream(config.stream), tx(config.tx), polls(config.polls), cache(config.cache),
+      response_timeout(config.response_timeout), gap(config.gap), max_backoff(config.max_backoff),
+      priority(config.priority) {
+    // slaves past max_slaves are polled without back-off
+    size_t n = 0;
+    for (auto& read : polls) {
+        if (slave(read.slave) == nullptr and n < max_slaves) {
+            slaves[n++].address = read.slave;
+        }
+    }
+}
+
+RTUMaster::Slave* RTUMaster::slave(uint8_t address) {
+    for (auto& s : slaves) {
+        if (s.address == address and address != 0) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+bool RTUMaster::init() {
+    if (polls.len() == 0 or polls.len() > max_reads) {
+        return false;
+    }
+    task = xTaskCreateStatic(task_function, "modbus master", stack_size, this, priority, stack, &task_buffer);
+    return task != nullptr;
+}
+
+void RTUMaster::task_function(void* self) {
+    static_cast<RTUMaster*>(self)->run();
+}
+
+void RTUMaster::run() {
+    auto now = xTaskGetTickCount();
+    for (size_t i = 0; i < polls.len(); ++i) {
+        due[i] = now;
+    }
+
+    for (;;) {
+        now = xTaskGetTickCount();
+        TickType_t wait;
+        int i = next(now, wait);
+        if (i < 0) {
+            vTaskDelay(wait);
+            continue;
+        }
+
+        // a read that fell behind is not made up for, it carries on from now
+        auto& read = polls.begin()[i];
+        due[i] += read.period;
+        if (reached(now, due[i])) {
+            due[i] = now + read.period;
+        }
+
+        auto status = transact(read, i);
+        last[i] = status;
+        statistics.requests++;
+        auto s = slave(read.slave);
+        if (status == Status::Timeout) {
+            statistics.timeouts++;
+            if (s) {
+                backoff(*s, xTaskGetTickCount());
+            }
+        } else if (status == Status::NotSent) {
+            statistics.not_sent++;
+        } else {
+            if (s) {
+                s->timeouts = 0;
+            }
+            if (status != Status::Ok) {
+                statistics.errors++;
+            }
+        }
+        vTaskDelay(gap);
+    }
+}
+
+int RTUMaster::next(TickType_t now, TickType_t& wait) {
+    int best = -1;
+    wait = portMAX_DELAY;
+    for (size_t i = 0; i < polls.len(); ++i) {
+        if (not reached(now, due[i])) {
+            TickType_t left = due[i] - now;
+            wait = left < wait ? left : wait;
+            continue;
+        }
+        // a read of a slave that is backing off waits for the back-off to end
+        auto s = slave(polls.begin()[i].slave);
+        if (s and not reached(now, s->retry_at)) {
+            due[i] = s->retry_at;
+            statistics.skipped++;
+            TickType_t left = due[i] - now;
+            wait = left < wait ? left : wait;
+            continue;
+        }
+        // the most overdue goes first
+        if (best < 0 or int32_t(due[best] - due[i]) > 0) {
+            best = int(i);
+        }
+    }
+    return best;
+}
+
+RTUMaster::Status RTUMaster::transact(const Poll& read, size_t index) {
+    uint8_t function = function_of(read.table);
+    uint8_t req[6] = {
+        read.slave, function,
+        uint8_t(read.address >> 8), uint8_t(read.address),
+        uint8_t(read.count >> 8), uint8_t(read.count),
+    };
+    uint16_t crc = crc16(req, sizeof(req));
+    uint8_t crc_bytes[2] = {uint8_t(crc), uint8_t(crc >> 8)};
+
+    // whatever came in since the last response, e.g. a reply that was too late, is stale
+    while (stream.read(frame, sizeof(frame), 0) > 0) {}
+
+    if (not tx.write({{req, sizeof(req)}, {crc_bytes, sizeof(crc_bytes)}}, response_timeout)) {
+        return Status::NotSent;
+    }
+
+    size_t data = is_bits(read.table) ? (read.count + 7) / 8 : read.count * 2;
+    size_t expected = 5 + data;
+    size_t len = 0;
+    auto start = xTaskGetTickCount();
+    while (len < expected) {
+        auto elapsed = xTaskGetTickCount() - start;
+        size_t n = elapsed < response_timeout ? stream.read_burst(frame + len, sizeof(frame) - len, response_timeout - elapsed) : 0;
+        if (n == 0) {
+            // a slave that started to answer is alive, the frame was garbled
+            return len == 0 ? Status::Timeout : Status::Invalid;
+        }
+        len += n;
+        if (len >= 2 and frame[1] == (function | 0x80)) {
+            expected = 5;
+        }
+    }
+
+    if (frame[0] != read.slave or crc16(frame, expected) != 0) {
+        return Status::Invalid;
+    }
+    if (frame[1] == (function | 0x80)) {
+        return Status::Exception;
+    }
+    if (frame[1] != function or frame[2] != data) {
+        return Status::Invalid;
+    }
+    store(index, frame + 3, read);
+    return Status::Ok;
+}
+
+void RTUMaster::store(size_t index, const uint8_t* data, const Poll& read) {
+    uint16_t* words = cache + polls.offset(index);
+    bool bits = is_bits(read.table);
+
+    // readers are tasks, none of them runs before the sequence is even again
+    vTaskSuspendAll();
+    sequence = sequence + 1;
+    std::atomic_signal_fence(std::memory_order_release);
+    for (size_t k = 0; k < read.count; ++k) {
+        words[k] = bits ? data[k / 8] >> (k % 8) & 1 : uint16_t(data[2 * k] << 8 | data[2 * k + 1]);
+    }
+    auto now = xTaskGetTickCount();
+    updated[index] = now != 0 ? now : 1;  // 0 is never read
+    std::atomic_signal_fence(std::memory_order_release);
+    sequence = sequence + 1;
+    xTaskResumeAll();
+}
+
+void RTUMaster::backoff(Slave& s, TickType_t now) {
+    if (s.timeouts < 31) {
+        s.timeouts++;
+    }
+    TickType_t wait = response_timeout;
+    for (uint8_t i = 1; i < s.timeouts and wait < max_backoff; ++i) {
+        wait *= 2;
+    }
+    s.retry_at = now + (wait < max_backoff ? wait : max_backoff);
+}
+
+bool RTUMaster::read(uint8_t slave, Table table, uint16_t address, uint16_t* values, size_t n, TickType_t* when) const {
+    int i = polls.find(slave, table, address, uint16_t(n));
+    if (i < 0) {
+        return false;
+    }
+    const uint16_t* words = cache + polls.offset(i) + (address - polls.begin()[i].address);
+
+    TickType_t tick;
+    for (;;) {
+        uint32_t seq = sequence;
+        std::atomic_signal_fence(std::memory_order_acquire);
+        for (size_t k = 0; k < n; ++k) {
+            values[k] = words[k];
+        }
+        tick = updated[i];
+        std::atomic_signal_fence(std::memory_order_acquire);
+        if ((seq & 1) == 0 and sequence == seq) {
+            break;
+        }
+    }
+
+    if (when) {
+        *when = tick;
+    }
+    return tick != 0;
+}
+
+RTUMaster::Status RTUMaster::status(uint8_t slave, Table table, uint16_t address) const {
+    int i = polls.find(slave, table, address, 1);
+    return i < 0 ? Status::Pending : last[i];
+}
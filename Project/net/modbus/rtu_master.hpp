@@ -0,0 +1,125 @@
+#ifndef PROJECT_NET_MODBUS_RTU_MASTER_HPP
+#define PROJECT_NET_MODBUS_RTU_MASTER_HPP
+
+#include "net/modbus/polls.hpp"
+#include "drivers/uart_stream.hpp"
+#include "drivers/uart_tx.hpp"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Project::net::modbus {
+    class RTUMaster;
+}
+
+/// Modbus RTU master that polls slaves from a table.
+/// One task owns the bus and sends the merged reads of a PollTable back to back, each when
+/// its period is due, so no other task ever blocks on a slave. Decoded values go into a
+/// cache behind a sequence lock: the master bumps the sequence around every update and a
+/// reader copies the values and retries if the sequence moved meanwhile, so readers take no
+/// lock and never hold up the bus. The update itself runs with the scheduler suspended, so a
+/// reader of higher priority cannot spin on a preempted writer.
+/// @note read() is for tasks, not interrupts
+///
+/// A slave that does not answer is skipped for a back-off that doubles with every timeout in
+/// a row, up to max_backoff, and its other reads are skipped with it; one answer resets it.
+/// A request that never made it onto the bus says nothing about the slave and leaves its
+/// back-off as it was.
+/// @code
+/// uint16_t values[4];
+/// TickType_t updated;
+/// if (master.read(10, Table::InputRegisters, 0, values, 4, &updated)) {
+///     use(values, xTaskGetTickCount() - updated);
+/// }
+/// @endcode
+class Project::net::modbus::RTUMaster {
+public:
+    static constexpr size_t max_reads = 16;
+    static constexpr size_t max_slaves = 8;
+    static constexpr size_t max_frame = 256;
+
+    enum class Status : uint8_t {
+        Pending,    ///< not answered yet
+        Ok,
+        Timeout,
+        Exception,  ///< the slave refused the read
+        Invalid,    ///< bad CRC or unexpected response
+        NotSent,    ///< the transmitter did not take the request in time
+    };
+
+    struct Config {
+        drivers::UARTStream& stream;         ///< receive side of the port
+        drivers::UARTTransmitter& tx;        ///< transmit side of the same port
+        Polls polls;                         ///< usually a constexpr PollTable
+        uint16_t* cache;                     ///< polls.words() words
+        TickType_t response_timeout = pdMS_TO_TICKS(100);
+        TickType_t gap = pdMS_TO_TICKS(2) + 1;          ///< silence between frames, 3.5 characters in whole ticks
+        TickType_t max_backoff = pdMS_TO_TICKS(10000);
+        UBaseType_t priority = configMAX_PRIORITIES - 3;  ///< keeps the gaps and response timeouts tight
+    };
+
+    struct Stats {
+        uint32_t requests;
+        uint32_t timeouts;
+        uint32_t errors;    ///< exception and invalid responses
+        uint32_t not_sent;  ///< requests the transmitter did not take, no slave is to blame
+        uint32_t skipped;   ///< reads not sent because their slave was backing off
+    };
+
+    explicit RTUMaster(Config config);
+
+    /// poll forever in a task of its own
+    /// @note the stream must be initialized
+    /// @return false if the poll table is empty or too long
+    bool init();
+
+    /// copy polled values, consistent with each other, bits as 0 or 1
+    /// @param when tick of the last successful read, if not null
+    /// @return false if the range is not polled or has never been read
+    bool read(uint8_t slave, Table table, uint16_t address, uint16_t* values, size_t n, TickType_t* when = nullptr) const;
+
+    /// outcome of the last request of the read covering an address
+    Status status(uint8_t slave, Table table, uint16_t address) const;
+
+    const Stats& stats() const { return statistics; }
+
+private:
+    struct Slave {
+        uint8_t address;
+        uint8_t timeouts;     ///< in a row
+        TickType_t retry_at;
+    };
+
+    static constexpr size_t stack_size = 192;  ///< the frame is a member
+
+    static void task_function(void* self);
+    [[noreturn]] void run();
+    Slave* slave(uint8_t address);
+    int next(TickType_t now, TickType_t& wait);
+    Status transact(const Poll& read, size_t index);
+    void store(size_t index, const uint8_t* data, const Poll& read);
+    void backoff(Slave& s, TickType_t now);
+
+    drivers::UARTStream& stream;
+    drivers::UARTTransmitter& tx;
+    Polls polls;
+    uint16_t* cache;
+    TickType_t response_timeout;
+    TickType_t gap;
+    TickType_t max_backoff;
+    UBaseType_t priority;
+
+    volatile uint32_t sequence = 0;              ///< odd while the cache is being written
+    TickType_t due[max_reads] = {};
+    TickType_t updated[max_reads] = {};
+    volatile Status last[max_reads] = {};
+    Slave slaves[max_slaves] = {};
+    uint8_t frame[max_frame] = {};
+    Stats statistics = {};
+    TaskHandle_t task = nullptr;
+    StaticTask_t task_buffer = {};
+    StackType_t stack[stack_size] = {};
+};
+
+#endif // PROJECT_NET_MODBUS_RTU_MASTER_HPP
@@ -0,0 +1,90 @@
+#include "net/modbus/rtu_slave.hpp"
+#include "net/modbus/crc.hpp"
+
+using namespace Project::net::modbus;
+
+static constexpr uint8_t broadcast = 0;
+static constexpr size_t min_frame = 4;  ///< address, function code and CRC
+
+static bool crc_ok(const uint8_t* frame, size_t len) {
+    return len >= min_frame and crc16(frame, len) == 0;
+}
+
+size_t RTUSlave::request_length(const uint8_t* frame, size_t len) {
+    if (len < 2) {
+        return 0;
+    }
+    switch (Function(frame[1])) {
+        case Function::ReadCoils:
+        case Function::ReadDiscreteInputs:
+        case Function::ReadHoldingRegisters:
+        case Function::ReadInputRegisters:
+        case Function::WriteSingleCoil:
+        case Function::WriteSingleRegister:
+            return 8;
+        case Function::WriteMultipleCoils:
+        case Function::WriteMultipleRegisters:
+            // address, function, start, count, byte count, data, CRC
+            return len < 7 ? 0 : 9 + frame[6];
+    }
+    return 0;
+}
+
+bool RTUSlave::init() {
+    task = xTaskCreateStatic(task_function, "modbus rtu", stack_size, this, priority, stack, &task_buffer);
+    return task != nullptr;
+}
+
+void RTUSlave::task_function(void* self) {
+    static_cast<RTUSlave*>(self)->run();
+}
+
+void RTUSlave::run() {
+    size_t len = 0;
+    for (;;) {
+        // a partial frame gets frame_timeout to be completed, a new one can take forever
+        size_t n = stream.read_burst(rx + len, sizeof(rx) - len, len == 0 ? portMAX_DELAY : frame_timeout);
+        if (n == 0) {
+            ++error_count;
+            len = 0;
+            continue;
+        }
+        len += n;
+
+        if (rx[0] != address and rx[0] != broadcast) {
+            len = 0;
+            continue;
+        }
+
+        // a burst that checks out as a whole is a frame, also for functions the length of which
+        // is unknown; otherwise the request may be split or have trailing noise
+        size_t frame = crc_ok(rx, len) ? len : request_length(rx, len);
+        if (frame == 0 or frame > len) {
+            if (len == sizeof(rx) or frame > sizeof(rx)) {
+                ++error_count;
+                len = 0;
+            }
+            continue;
+        }
+        if (not crc_ok(rx, frame)) {
+            ++error_count;
+            len = 0;
+            continue;
+        }
+
+        size_t pdu = registers.handle(rx + 1, frame - 3, tx + 1);
+        if (rx[0] != broadcast and pdu > 0) {
+            reply(pdu);
+        }
+        ++frame_count;
+        len = 0;
+    }
+}
+
+void RTUSlave::reply(size_t len) {
+    tx[0] = address;
+    uint16_t crc = crc16(tx, len + 1);
+    tx[len + 1] = uint8_t(crc);
+    tx[len + 2] = uint8_t(crc >> 8);
+    stream.write(tx, len + 3, tx_timeout);
+}
@@ -0,0 +1,72 @@
+#ifndef PROJECT_NET_MODBUS_RTU_SLAVE_HPP
+#define PROJECT_NET_MODBUS_RTU_SLAVE_HPP
+
+#include "net/modbus/registers.hpp"
+#include "drivers/uart_stream.hpp"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Project::net::modbus {
+    class RTUSlave;
+}
+
+/// Modbus RTU slave on a UART stream.
+/// The end of a frame is taken from the IDLE line interrupt, one character time after the last
+/// byte, instead of waiting out the full 3.5 character gap: a request is answered as soon as
+/// its CRC checks out. A frame split by a longer pause is put back together from its function
+/// code, which tells the request length, and a partial frame is dropped once the line stays
+/// quiet for frame_timeout. Frames for other slaves are dropped a burst at a time, so their
+/// replies are never mistaken for requests.
+class Project::net::modbus::RTUSlave {
+public:
+    static constexpr size_t max_frame = 256;
+    static constexpr TickType_t tx_timeout = pdMS_TO_TICKS(500);  ///< a full frame takes 270 ms at 9600 baud
+
+    struct Config {
+        drivers::UARTStream& stream;
+        uint8_t address;
+        Registers registers;
+        TickType_t frame_timeout = pdMS_TO_TICKS(2) + 1;  ///< the 1.75 ms gap of the spec above 19200 baud, in whole ticks
+        UBaseType_t priority = configMAX_PRIORITIES - 3;  ///< the reply waits for this task only
+    };
+
+    explicit RTUSlave(Config config)
+        : stream(config.stream), address(config.address), registers(config.registers),
+          frame_timeout(config.frame_timeout), priority(config.priority) {}
+
+    /// serve requests forever in a task of its own
+    /// @note the stream must be initialized
+    bool init();
+
+    uint32_t frames() const { return frame_count; }   ///< requests answered
+    uint32_t errors() const { return error_count; }   ///< frames dropped for a bad CRC or a missing tail
+
+private:
+    /// length of the request at the start of frame, 0 if more bytes are needed to tell or the
+    /// function is unknown
+    static size_t request_length(const uint8_t* frame, size_t len);
+
+    static constexpr size_t stack_size = 160;  ///< the frames are members
+
+    static void task_function(void* self);
+    [[noreturn]] void run();
+    void reply(size_t len);
+
+    drivers::UARTStream& stream;
+    uint8_t address;
+    Registers registers;
+    TickType_t frame_timeout;
+    UBaseType_t priority;
+
+    uint8_t rx[max_frame] = {};
+    uint8_t tx[max_frame] = {};
+    uint32_t frame_count = 0;
+    uint32_t error_count = 0;
+    TaskHandle_t task = nullptr;
+    StaticTask_t task_buffer = {};
+    StackType_t stack[stack_size] = {};
+};
+
+#endif // PROJECT_NET_MODBUS_RTU_SLAVE_HPP
@@ -0,0 +1,133 @@
+#include "net/modbus/tcp_server.hpp"
+#include "net/interrupt.hpp"
+#include "socket.h"
+
+using namespace Project::net::modbus;
+
+bool TCPServer::init() {
+    if (n_connections == 0 or first_socket + n_connections > _WIZCHIP_SOCK_NUM_) {
+        return false;
+    }
+    task = xTaskCreateStatic(task_function, "modbus tcp", stack_size, this, priority, stack, &task_buffer);
+    return task != nullptr;
+}
+
+void TCPServer::task_function(void* self) {
+    static_cast<TCPServer*>(self)->serve();
+}
+
+void TCPServer::serve() {
+    // SENDOK too, the next request of a connection waits for the previous response
+    uint8_t mask = 0;
+    for (size_t i = 0; i < n_connections; ++i) {
+        auto& conn = connections[i];
+        conn = {};
+        conn.sn = first_socket + i;
+        setSn_IMR(conn.sn, Sn_IR_CON | Sn_IR_RECV | Sn_IR_DISCON | Sn_IR_TIMEOUT | Sn_IR_SENDOK);
+        mask |= 1u << conn.sn;
+    }
+
+    Project::net::notify_on_interrupt(xTaskGetCurrentTaskHandle(), mask);
+
+    for (;;) {
+        bool busy = false;
+        for (size_t i = 0; i < n_connections; ++i) {
+            busy |= poll(connections[i]);
+        }
+        if (not busy) {
+            ulTaskNotifyTake(pdTRUE, idle_poll);
+        }
+    }
+}
+
+bool TCPServer::poll(Connection& conn) {
+    auto sn = conn.sn;
+
+    auto ir = getSn_IR(sn);
+    if (ir != 0) {
+        setSn_IR(sn, ir);
+    }
+    if (ir & (Sn_IR_SENDOK | Sn_IR_DISCON | Sn_IR_TIMEOUT)) {
+        conn.sending = false;
+    }
+
+    switch (getSn_SR(sn)) {
+        case SOCK_CLOSED:
+            conn.sending = false;
+            ::socket(sn, Sn_MR_TCP, port, 0);
+            return true;
+
+        case SOCK_INIT:
+            ::listen(sn);
+            return true;
+
+        case SOCK_CLOSE_WAIT:
+            ::disconnect(sn);
+            return true;
+
+        case SOCK_ESTABLISHED:
+            break;
+
+        default:
+            return false;
+    }
+
+    auto now = xTaskGetTickCount();
+    if (ir & Sn_IR_CON) {
+        conn.sending = false;
+        conn.last_activity = now;
+    }
+    if (conn.sending) {
+        return false;
+    }
+
+    // a request that stops halfway holds the connection as long as one that never comes
+    auto expire = [&] {
+        if (now - conn.last_activity < idle_timeout) {
+            return false;
+        }
+        ::disconnect(sn);
+        return true;
+    };
+
+    size_t available = getSn_RX_RSR(sn);
+    if (available < header_size) {
+        return expire();
+    }
+
+    // peek at the header in the socket RX memory, the offset wraps around by itself
+    uint32_t address = (uint32_t(getSn_RX_RD(sn)) << 8) + (WIZCHIP_RXBUF_BLOCK(sn) << 3);
+    WIZCHIP_READ_BUF(address, frame, header_size);
+    uint16_t protocol = uint16_t(frame[2] << 8 | frame[3]);
+    uint16_t length = uint16_t(frame[4] << 8 | frame[5]);  // unit identifier and PDU
+    if (protocol != 0 or length < 2 or length > max_pdu + 1) {
+        // the framing of the stream is lost
+        statistics.errors++;
+        ::disconnect(sn);
+        return true;
+    }
+    size_t len = header_size - 1 + length;
+    if (available < len) {
+        return expire();
+    }
+    // the request is only taken once the largest response fits, it is answered right away
+    if (getSn_TX_FSR(sn) < max_adu) {
+        return false;
+    }
+
+    wiz_recv_data(sn, frame, len);
+    setSn_CR(sn, Sn_CR_RECV);
+    while (getSn_CR(sn)) {}
+    conn.last_activity = now;
+
+    size_t n = registers.handle(frame + header_size, length - 1, frame + header_size);
+    frame[4] = uint8_t((n + 1) >> 8);
+    frame[5] = uint8_t(n + 1);
+
+    wiz_send_data(sn, frame, header_size + n);
+    setSn_CR(sn, Sn_CR_SEND);
+    while (getSn_CR(sn)) {}
+    conn.sending = true;
+    statistics.transactions++;
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef PROJECT_NET_MODBUS_TCP_SERVER_HPP
+#define PROJECT_NET_MODBUS_TCP_SERVER_HPP
+
+#include "net/modbus/registers.hpp"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Project::net::modbus {
+    class TCPServer;
+}
+
+/// Modbus TCP server on W5500 TCP sockets.
+/// The MBAP header is read where it lies in the socket RX memory without consuming it, so an
+/// ADU that has not fully arrived waits in the W5500 and a connection needs no buffer of its
+/// own. A complete ADU is then received into the one frame buffer of the server and answered
+/// in place: the response PDU overwrites the request PDU behind the same header, only the
+/// length field changes.
+///
+/// Several sockets listen on the same port and one task of the server steps them in turn,
+/// sleeping until the W5500 INT pin signals a socket event, like http::Server. Every unit identifier is
+/// answered, the register map is the whole device.
+/// @note the registers may be shared with an RTUSlave running in another task
+class Project::net::modbus::TCPServer {
+public:
+    static constexpr size_t header_size = 7;  ///< MBAP: transaction, protocol, length, unit
+    static constexpr size_t max_adu = header_size + max_pdu - 1;
+    static constexpr TickType_t idle_poll = pdMS_TO_TICKS(100); ///< fallback in case an edge was missed
+
+    struct Connection {
+        uint8_t sn;
+        bool sending;             ///< a response is on its way, wait for SENDOK before the next
+        TickType_t last_activity;
+    };
+
+    struct Config {
+        uint16_t port = 502;
+        uint8_t socket = 6;       ///< W5500 socket of the first connection, the others follow
+        Connection* connections;
+        size_t n_connections = 1;
+        Registers registers;      ///< usually a constexpr RegisterMap
+        TickType_t idle_timeout = pdMS_TO_TICKS(60000); ///< close a connection idle for this long
+        UBaseType_t priority = tskIDLE_PRIORITY + 2;
+    };
+
+    struct Stats {
+        uint32_t transactions;
+        uint32_t errors;          ///< connections closed for a malformed header
+    };
+
+    explicit TCPServer(Config config)
+        : port(config.port), first_socket(config.socket), connections(config.connections),
+          n_connections(config.n_connections), registers(config.registers), idle_timeout(config.idle_timeout),
+          priority(config.priority) {}
+
+    /// serve requests forever in a task of its own
+    /// @return false if the sockets are out of range
+    bool init();
+
+    /// advance the state machine of a connection once
+    /// @return false if there was nothing to do
+    bool poll(Connection& conn);
+
+    const Stats& stats() const { return statistics; }
+
+private:
+    static constexpr size_t stack_size = 192;  ///< the frame is a member
+
+    static void task_function(void* self);
+    [[noreturn]] void serve();
+
+    uint16_t port;
+    uint8_t first_socket;
+    Connection* connections;
+    size_t n_connections;
+    Registers registers;
+    TickType_t idle_timeout;
+    UBaseType_t priority;
+
+    uint8_t frame[max_adu] = {};
+    Stats statistics = {};
+    TaskHandle_t task = nullptr;
+    StaticTask_t task_buffer = {};
+    StackType_t stack[stack_size] = {};
+};
+
+#endif // PROJECT_NET_MODBUS_TCP_SERVER_HPP
@@ -0,0 +1,63 @@
+#ifndef PROJECT_UTILS_ARENA_HPP
+#define PROJECT_UTILS_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace Project::utils {
+    template <size_t N> class Arena;
+}
+
+/// Bump allocator over a fixed buffer.
+/// Allocations are never freed individually, the whole arena is reset at once, e.g. after
+/// a request has been answered.
+/// @note not thread safe, meant to be owned by a single connection
+template <size_t N>
+class Project::utils::Arena {
+public:
+    static constexpr size_t alignment = alignof(std::max_align_t);
+
+    /// @return nullptr if the arena is exhausted
+    void* allocate(size_t size, size_t align = alignment) {
+        size_t start = (used + align - 1) & ~(align - 1);
+        if (start + size > N) {
+            return nullptr;
+        }
+        used = start + size;
+        if (used > peak) peak = used;
+        return buffer + start;
+    }
+
+    template <typename T>
+    T* allocate_array(size_t n) {
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    /// copy a string into the arena
+    /// @return empty view if the arena is exhausted
+    std::string_view copy(std::string_view str) {
+        auto dest = allocate_array<char>(str.size());
+        if (dest == nullptr) {
+            return {};
+        }
+        ::memcpy(dest, str.data(), str.size());
+        return {dest, str.size()};
+    }
+
+    void reset() { used = 0; }
+
+    size_t size() const { return used; }
+    size_t capacity() const { return N; }
+
+    /// largest number of bytes ever in use
+    size_t high_water() const { return peak; }
+
+private:
+    alignas(alignment) uint8_t buffer[N] = {};
+    size_t used = 0;
+    size_t peak = 0;
+};
+
+#endif // PROJECT_UTILS_ARENA_HPP
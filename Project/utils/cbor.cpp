@@ -0,0 +1,244 @@
+#include "utils/cbor.hpp"
+#include <cmath>
+
+using namespace Project::utils;
+
+/// initial byte and argument of the item at pos
+/// @param indefinite set for the indefinite length forms of strings, arrays and maps
+static cbor::Status read_head(const uint8_t* buf, size_t len, size_t& pos, uint8_t& major, uint64_t& arg, bool& indefinite) {
+    if (pos >= len) {
+        return cbor::Status::Incomplete;
+    }
+    uint8_t initial = buf[pos++];
+    major = initial >> 5;
+    uint8_t info = initial & 0x1F;
+    indefinite = false;
+    arg = info;
+    if (info < 24) {
+        return cbor::Status::Complete;
+    }
+    if (info == 31) {
+        // break is only valid inside an indefinite item, which checks for it before
+        if (major < 2 or major == 6 or major == 7) {
+            return cbor::Status::Invalid;
+        }
+        indefinite = true;
+        return cbor::Status::Complete;
+    }
+    if (info > 27) {
+        return cbor::Status::Invalid;
+    }
+    size_t n = size_t(1) << (info - 24);
+    if (len - pos < n) {
+        return cbor::Status::Incomplete;
+    }
+    arg = 0;
+    for (size_t i = 0; i < n; ++i) {
+        arg = arg << 8 | buf[pos++];
+    }
+    return cbor::Status::Complete;
+}
+
+static cbor::Status skip_item(const uint8_t* buf, size_t len, size_t& pos, size_t depth) {
+    if (depth == cbor::max_depth) {
+        return cbor::Status::Invalid;
+    }
+    uint8_t major;
+    uint64_t arg;
+    bool indefinite;
+    if (auto status = read_head(buf, len, pos, major, arg, indefinite); status != cbor::Status::Complete) {
+        return status;
+    }
+
+    switch (major) {
+        case 2:
+        case 3:
+            if (indefinite) {
+                // chunks of the same major type up to the break
+                for (;;) {
+                    if (pos == len) {
+                        return cbor::Status::Incomplete;
+                    }
+                    if (buf[pos] == 0xFF) {
+                        ++pos;
+                        return cbor::Status::Complete;
+                    }
+                    if (buf[pos] >> 5 != major or (buf[pos] & 0x1F) == 31) {
+                        return cbor::Status::Invalid;
+                    }
+                    if (auto status = skip_item(buf, len, pos, depth + 1); status != cbor::Status::Complete) {
+                        return status;
+                    }
+                }
+            }
+            if (len - pos < arg) {
+                return cbor::Status::Incomplete;
+            }
+            pos += arg;
+            return cbor::Status::Complete;
+
+        case 4:
+        case 5: {
+            uint64_t items = major == 5 ? arg * 2 : arg;
+            for (uint64_t i = 0; indefinite or i < items; ++i) {
+                if (indefinite) {
+                    if (pos == len) {
+                        return cbor::Status::Incomplete;
+                    }
+                    if (buf[pos] == 0xFF) {
+                        ++pos;
+                        return cbor::Status::Complete;
+                    }
+                }
+                if (auto status = skip_item(buf, len, pos, depth + 1); status != cbor::Status::Complete) {
+                    return status;
+                }
+            }
+            return cbor::Status::Complete;
+        }
+
+        case 6:
+            return skip_item(buf, len, pos, depth + 1);
+
+        default:
+            return cbor::Status::Complete;
+    }
+}
+
+cbor::Status cbor::item_length(const uint8_t* buf, size_t len, size_t& res) {
+    size_t pos = 0;
+    auto status = skip_item(buf, len, pos, 0);
+    if (status == Status::Complete) {
+        res = pos;
+    }
+    return status;
+}
+
+bool cbor::Reader::head(uint8_t& major, uint64_t& arg, bool& indefinite) {
+    return read_head(data, len, pos, major, arg, indefinite) == Status::Complete;
+}
+
+bool cbor::Reader::skip() {
+    return skip_item(data, len, pos, 0) == Status::Complete;
+}
+
+bool cbor::Reader::container(uint8_t major, size_t& n, bool& indefinite) {
+    uint8_t type;
+    uint64_t arg;
+    // tags are transparent, e.g. the self-described CBOR tag of a frame
+    while (pos < len and data[pos] >> 5 == 6) {
+        if (not head(type, arg, indefinite)) {
+            return false;
+        }
+    }
+    // every entry takes a byte at least, which bounds a definite length
+    if (not head(type, arg, indefinite) or type != major or (not indefinite and arg > len - pos)) {
+        return false;
+    }
+    n = arg;
+    return true;
+}
+
+bool cbor::Reader::more(bool indefinite, size_t i, size_t n) {
+    if (not indefinite) {
+        return i < n;
+    }
+    if (pos >= len) {
+        cut = true;
+        return false;
+    }
+    if (data[pos] == 0xFF) {
+        ++pos;
+        return false;
+    }
+    return true;
+}
+
+bool cbor::Reader::null() {
+    // null and undefined
+    if (pos < len and (data[pos] == 0xF6 or data[pos] == 0xF7)) {
+        ++pos;
+        return true;
+    }
+    return false;
+}
+
+bool cbor::Reader::integer(int64_t& res) {
+    uint8_t major;
+    uint64_t arg;
+    bool indefinite;
+    if (not head(major, arg, indefinite) or major > 1 or arg > uint64_t(INT64_MAX)) {
+        return false;
+    }
+    res = major == 0 ? int64_t(arg) : -1 - int64_t(arg);
+    return true;
+}
+
+static float half_to_float(uint16_t half) {
+    // RFC 8949 appendix D
+    int exponent = half >> 10 & 0x1F;
+    int mantissa = half & 0x3FF;
+    float value;
+    if (exponent == 0) {
+        value = std::ldexp(float(mantissa), -24);
+    } else if (exponent != 31) {
+        value = std::ldexp(float(mantissa + 1024), exponent - 25);
+    } else {
+        value = mantissa == 0 ? std::numeric_limits<float>::infinity() : std::numeric_limits<float>::quiet_NaN();
+    }
+    return half & 0x8000 ? -value : value;
+}
+
+bool cbor::Reader::floating(double& res) {
+    if (pos < len and data[pos] >> 5 < 2) {
+        // integers are taken as floats, they are what a sender writes for whole numbers
+        int64_t num;
+        if (not integer(num)) {
+            return false;
+        }
+        res = double(num);
+        return true;
+    }
+
+    uint8_t major;
+    uint64_t arg;
+    bool indefinite;
+    auto info = pos < len ? data[pos] & 0x1F : 0;
+    if (not head(major, arg, indefinite) or major != 7) {
+        return false;
+    }
+    if (info == 25) {
+        res = half_to_float(uint16_t(arg));
+    } else if (info == 26) {
+        uint32_t bits = uint32_t(arg);
+        float num;
+        ::memcpy(&num, &bits, sizeof(num));
+        res = num;
+    } else if (info == 27) {
+        ::memcpy(&res, &arg, sizeof(res));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool cbor::Reader::boolean(bool& res) {
+    if (pos < len and (data[pos] == 0xF4 or data[pos] == 0xF5)) {
+        res = data[pos++] == 0xF5;
+        return true;
+    }
+    return false;
+}
+
+bool cbor::Reader::text(std::string_view& res) {
+    uint8_t major;
+    uint64_t arg;
+    bool indefinite;
+    // a string in pieces has no single slice
+    if (not head(major, arg, indefinite) or (major != 3 and major != 2) or indefinite or len - pos < arg) {
+        return false;
+    }
+    res = {reinterpret_cast<const char*>(data + pos), size_t(arg)};
+    pos += arg;
+    return true;
+}
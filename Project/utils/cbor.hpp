@@ -0,0 +1,368 @@
+#ifndef PROJECT_UTILS_CBOR_HPP
+#define PROJECT_UTILS_CBOR_HPP
+
+#include "utils/json.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace Project::utils::cbor {
+    template <typename Sink> class Writer;
+    class Reader;
+    template <size_t N> class Frames;
+
+    enum class Status {
+        Complete,   ///< a whole data item is in the buffer
+        Incomplete, ///< more bytes are needed
+        Invalid,    ///< malformed, or nested deeper than max_depth
+    };
+
+    static constexpr size_t max_depth = 8;
+
+    /// tag 55799, self-described CBOR, which starts every item of a Frames stream
+    static constexpr uint8_t magic[] = {0xD9, 0xD9, 0xF7};
+
+    /// length of the data item at the start of buf
+    Status item_length(const uint8_t* buf, size_t len, size_t& res);
+}
+
+/// Streaming CBOR (RFC 8949) writer, the binary counterpart of json::Writer.
+/// Structs described with JSON_SCHEMA are written as maps keyed by the same member names,
+/// so a JSON document and its CBOR encoding carry the same data. Integers take 1 to 9 bytes
+/// depending on their value and floats are copied bit for bit, there is no text formatting.
+template <typename Sink>
+class Project::utils::cbor::Writer {
+public:
+    explicit Writer(Sink& sink) : sink(sink) {}
+
+    /// a map or array of n entries, a map entry being a key and a value
+    Writer& begin_map(size_t n) { return head(5, n); }
+    Writer& begin_array(size_t n) { return head(4, n); }
+
+    /// a map or array whose length is not known up front, closed with end()
+    Writer& begin_map() { return put(0xBF); }
+    Writer& begin_array() { return put(0x9F); }
+    Writer& end() { return put(0xFF); }
+
+    /// mark the item that follows as CBOR, the start of every item of a Frames stream
+    Writer& self_describe() { sink.write({reinterpret_cast<const char*>(magic), sizeof(magic)}); return *this; }
+
+    Writer& key(std::string_view name) { return value(name); }
+
+    Writer& value(std::string_view str) { head(3, str.size()); sink.write(str); return *this; }
+    Writer& value(const char* str) { return value(std::string_view(str)); }
+
+    Writer& bytes(const void* data, size_t len) {
+        head(2, len);
+        sink.write({static_cast<const char*>(data), len});
+        return *this;
+    }
+
+    Writer& value(long long num) { return num < 0 ? head(1, uint64_t(-(num + 1))) : head(0, uint64_t(num)); }
+    Writer& value(unsigned long long num) { return head(0, num); }
+    Writer& value(long num) { return value((long long) num); }
+    Writer& value(unsigned long num) { return value((unsigned long long) num); }
+    Writer& value(int num) { return value((long long) num); }
+    Writer& value(unsigned int num) { return value((unsigned long long) num); }
+    Writer& value(bool b) { return put(b ? 0xF5 : 0xF4); }
+    Writer& value(std::nullptr_t) { return put(0xF6); }
+
+    Writer& value(float num) {
+        uint32_t bits;
+        ::memcpy(&bits, &num, sizeof(bits));
+        return head(7, bits, 0xFA);
+    }
+
+    /// single precision when it holds the value exactly
+    Writer& value(double num) {
+        if (double(float(num)) == num) {
+            return value(float(num));
+        }
+        uint64_t bits;
+        ::memcpy(&bits, &num, sizeof(bits));
+        return head(7, bits, 0xFB);
+    }
+
+    template <typename T, typename = std::enable_if_t<json::has_schema<T>::value>>
+    Writer& value(const T& object) {
+        constexpr auto n = std::tuple_size_v<std::decay_t<decltype(json::Schema<T>::members)>>;
+        begin_map(n);
+        std::apply([&](const auto&... members) { (member(members.name, object.*members.ptr), ...); }, json::Schema<T>::members);
+        return *this;
+    }
+
+    template <typename T, size_t N, typename = std::enable_if_t<not std::is_same_v<T, char>>>
+    Writer& value(const T (&items)[N]) {
+        begin_array(N);
+        for (auto& item : items) {
+            value(item);
+        }
+        return *this;
+    }
+
+    template <typename T>
+    Writer& member(std::string_view name, const T& val) { return key(name).value(val); }
+
+private:
+    Writer& put(uint8_t byte) {
+        sink.write({reinterpret_cast<const char*>(&byte), 1});
+        return *this;
+    }
+
+    /// initial byte and argument in the shortest form, or in the form of initial if it is given
+    Writer& head(uint8_t major, uint64_t arg, uint8_t initial = 0) {
+        uint8_t buf[9];
+        size_t n;
+        if (initial == 0xFA) {
+            buf[0] = initial;
+            n = 4;
+        } else if (initial == 0xFB) {
+            buf[0] = initial;
+            n = 8;
+        } else if (arg < 24) {
+            buf[0] = uint8_t(major << 5 | arg);
+            n = 0;
+        } else {
+            n = arg <= 0xFF ? 1 : arg <= 0xFFFF ? 2 : arg <= 0xFFFFFFFF ? 4 : 8;
+            buf[0] = uint8_t(major << 5 | (n == 1 ? 24 : n == 2 ? 25 : n == 4 ? 26 : 27));
+        }
+        for (size_t i = n; i > 0; --i, arg >>= 8) {
+            buf[i] = uint8_t(arg);
+        }
+        sink.write({reinterpret_cast<const char*>(buf), n + 1});
+        return *this;
+    }
+
+    Sink& sink;
+};
+
+/// CBOR decoder that fills a struct described with JSON_SCHEMA.
+/// The whole item must be in the buffer, see item_length(). String members are slices of
+/// the buffer, CBOR strings carry their length and need no unescaping, so the buffer stays
+/// const. Unknown members and null values are skipped.
+/// @note the buffer must outlive the struct
+class Project::utils::cbor::Reader {
+public:
+    Reader(const void* data, size_t len) : data(static_cast<const uint8_t*>(data)), len(len) {}
+    explicit Reader(std::string_view data) : Reader(data.data(), data.size()) {}
+
+    /// decode the next item into value
+    /// @return false if it is malformed or does not fit value
+    template <typename T>
+    bool read(T& value);
+
+    /// @return false if the next item is malformed
+    bool skip();
+
+    /// bytes consumed so far
+    size_t size() const { return pos; }
+
+private:
+    bool head(uint8_t& major, uint64_t& arg, bool& indefinite);
+    bool container(uint8_t major, size_t& n, bool& indefinite);
+    /// @return false after the last entry, consuming the break of an indefinite container
+    bool more(bool indefinite, size_t i, size_t n);
+    bool null();
+    bool integer(int64_t& res);
+    bool floating(double& res);
+    bool boolean(bool& res);
+    bool text(std::string_view& res);
+
+    const uint8_t* data;
+    size_t len;
+    size_t pos = 0;
+    bool cut = false;  ///< an indefinite container ran past the end of the buffer
+};
+
+/// CBOR sequence over a byte stream, e.g. a UART or USB CDC link.
+/// Every message is one data item prefixed with the self-described CBOR tag, so a receiver
+/// that starts mid-stream or loses bytes skips to the next tag and lines up again. Bytes
+/// are appended as they arrive, in pieces of any size, and complete items are handed out
+/// in order.
+///
+/// An item cut short reads on into the items after it, so an item is only handed out if it
+/// ends where the next tag starts or where the bytes end so far, and not if a tagged item
+/// within it is whole already: that one follows a truncated item and is taken instead. An
+/// item that ends where the bytes end so far waits for more while a tagged item within it
+/// is still incomplete.
+/// @note an item must therefore not end with a tagged item of its own
+/// @code
+/// // sender
+/// cbor::Writer(sink).self_describe().value(report);
+/// // receiver
+/// frames.append(buf, stream.read(buf, sizeof(buf), timeout));
+/// for (auto item = frames.next(); not item.empty(); item = frames.next()) {
+///     cbor::Reader(item).read(report);
+/// }
+/// @endcode
+template <size_t N>
+class Project::utils::cbor::Frames {
+public:
+    /// @return number of bytes taken, less than len if the buffer is full
+    size_t append(const void* buf, size_t n) {
+        compact();
+        if (n > N - len) {
+            n = N - len;
+        }
+        ::memcpy(buffer + len, buf, n);
+        len += n;
+        return n;
+    }
+
+    /// next complete item, tag included, empty if there is none yet
+    /// @note the view is valid until the next call to append() or next()
+    std::string_view next() {
+        compact();
+        for (;;) {
+            // everything up to the next tag is noise
+            size_t start = 0;
+            while (start < len and not starts_with_magic(start)) {
+                ++start;
+            }
+            if (start > 0) {
+                discard(start);
+            }
+            if (len < sizeof(magic)) {
+                return {};
+            }
+
+            size_t n;
+            auto status = item_length(buffer, len, n);
+            if (status == Status::Complete and ends_at_tag(n)) {
+                auto inner = tagged_within(n);
+                if (inner == Status::Invalid) {
+                    consumed = n;
+                    return {reinterpret_cast<const char*>(buffer), n};
+                }
+                // the bytes that follow tell whether this one was truncated
+                if (inner == Status::Incomplete and n == len and len < N) {
+                    return {};
+                }
+            } else if (status == Status::Incomplete and len < N and tagged_within(len) != Status::Complete) {
+                return {};
+            }
+            // malformed, truncated, or larger than the buffer, resume after this tag
+            discard(1);
+        }
+    }
+
+    /// bytes thrown away while looking for the start of an item
+    uint32_t dropped() const { return drops; }
+
+private:
+    bool starts_with_magic(size_t at) const {
+        size_t n = len - at < sizeof(magic) ? len - at : sizeof(magic);
+        return ::memcmp(buffer + at, magic, n) == 0;
+    }
+
+    bool ends_at_tag(size_t end) const {
+        return end == len or starts_with_magic(end);
+    }
+
+    /// the tagged items after the start and before end: Complete if one of them is complete
+    /// and ends at a tag, else Incomplete if one needs more bytes, Invalid if there are none
+    Status tagged_within(size_t end) const {
+        auto res = Status::Invalid;
+        for (size_t at = 1; at + sizeof(magic) <= end; ++at) {
+            if (not starts_with_magic(at)) {
+                continue;
+            }
+            size_t n;
+            auto status = item_length(buffer + at, len - at, n);
+            if (status == Status::Complete and ends_at_tag(at + n)) {
+                return Status::Complete;
+            }
+            if (status == Status::Incomplete) {
+                res = Status::Incomplete;
+            }
+        }
+        return res;
+    }
+
+    void compact() {
+        if (consumed > 0) {
+            len -= consumed;
+            ::memmove(buffer, buffer + consumed, len);
+            consumed = 0;
+        }
+    }
+
+    void discard(size_t n) {
+        len -= n;
+        ::memmove(buffer, buffer + n, len);
+        drops += n;
+    }
+
+    uint8_t buffer[N] = {};
+    size_t len = 0;
+    size_t consumed = 0;  ///< bytes of the item handed out by the last next()
+    uint32_t drops = 0;
+};
+
+template <typename T>
+bool Project::utils::cbor::Reader::read(T& value) {
+    if (null()) {
+        return true;
+    }
+
+    if constexpr (json::has_schema<T>::value) {
+        size_t n;
+        bool indefinite;
+        if (not container(5, n, indefinite)) {
+            return false;
+        }
+        for (size_t i = 0; more(indefinite, i, n); ++i) {
+            std::string_view key;
+            if (not text(key)) {
+                return false;
+            }
+            bool found = false;
+            bool ok = true;
+            std::apply([&](const auto&... members) {
+                ((not found and key == members.name ? (found = true, ok = read(value.*members.ptr)) : false), ...);
+            }, json::Schema<T>::members);
+            if (not ok or (not found and not skip())) {
+                return false;
+            }
+        }
+        return not cut;
+    } else if constexpr (std::is_array_v<T>) {
+        size_t n;
+        bool indefinite;
+        if (not container(4, n, indefinite) or (not indefinite and n > std::extent_v<T>)) {
+            return false;
+        }
+        for (size_t i = 0; more(indefinite, i, n); ++i) {
+            if (i == std::extent_v<T> or not read(value[i])) {
+                return false;
+            }
+        }
+        return not cut;
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return boolean(value);
+    } else if constexpr (std::is_integral_v<T>) {
+        static_assert(sizeof(T) < sizeof(int64_t) or std::is_signed_v<T>, "Integers are decoded as int64_t");
+        int64_t num;
+        if (not integer(num) or num < int64_t(std::numeric_limits<T>::min()) or num > int64_t(std::numeric_limits<T>::max())) {
+            return false;
+        }
+        value = T(num);
+        return true;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        double num;
+        if (not floating(num)) {
+            return false;
+        }
+        value = T(num);
+        return true;
+    } else {
+        static_assert(std::is_same_v<T, std::string_view>, "Unsupported member type");
+        return text(value);
+    }
+}
+
+#endif // PROJECT_UTILS_CBOR_HPP
@@ -0,0 +1,89 @@
+#include "utils/format.hpp"
+#include "utils/json.hpp"
+#include <cstring>
+
+using namespace Project::utils;
+
+static const char lower_digits[] = "0123456789abcdef";
+static const char upper_digits[] = "0123456789ABCDEF";
+
+void fmt::Buffer::write(std::string_view str) {
+    if (size == 0) {
+        return;
+    }
+    size_t n = str.size() < size - 1 - len ? str.size() : size - 1 - len;
+    ::memcpy(data + len, str.data(), n);
+    len += n;
+    data[len] = '\0';
+}
+
+template <typename T>
+static size_t digits(T value, bool hex, bool upper, char* buf) {
+    const char* table = upper ? upper_digits : lower_digits;
+    char text[20];
+    size_t n = 0;
+    if (hex) {
+        do { text[n++] = table[value & 0xF]; value >>= 4; } while (value);
+    } else {
+        do { text[n++] = table[value % 10]; value /= 10; } while (value);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        buf[i] = text[n - 1 - i];
+    }
+    return n;
+}
+
+size_t fmt::to_chars(uint32_t value, bool hex, bool upper, char* buf) {
+    return digits(value, hex, upper, buf);
+}
+
+size_t fmt::to_chars(uint64_t value, bool hex, bool upper, char* buf) {
+    // most 64-bit values are small, they do without the 64-bit division routine
+    if (value <= UINT32_MAX) {
+        return digits(uint32_t(value), hex, upper, buf);
+    }
+    return digits(value, hex, upper, buf);
+}
+
+size_t fmt::to_chars_fixed(double value, uint8_t precision, char* buf) {
+    if (value != value) {
+        ::memcpy(buf, "nan", 3);
+        return 3;
+    }
+    size_t n = 0;
+    if (value < 0) {
+        buf[n++] = '-';
+        value = -value;
+    }
+    if (value - value != 0) {
+        ::memcpy(buf + n, "inf", 3);
+        return n + 3;
+    }
+
+    uint32_t scale = 1;
+    for (uint8_t i = 0; i < precision; ++i) {
+        scale *= 10;
+    }
+    // the scaled value must fit an integer, beyond that fixed notation has no point
+    if (value * scale >= 1.8e19) {
+        return n + json::format_double(value, buf + n);
+    }
+
+    // whole part and fraction apart, a double holds the product of a large value and the scale
+    // only to 17 digits
+    auto whole = uint64_t(value);
+    auto fraction = uint32_t((value - double(whole)) * scale + 0.5);
+    if (fraction >= scale) {
+        fraction -= scale;
+        whole++;
+    }
+    n += to_chars(whole, false, false, buf + n);
+    if (precision > 0) {
+        buf[n++] = '.';
+        for (uint8_t i = precision; i > 0; --i, fraction /= 10) {
+            buf[n + i - 1] = char('0' + fraction % 10);
+        }
+        n += precision;
+    }
+    return n;
+}
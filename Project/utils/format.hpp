@@ -0,0 +1,306 @@
+#ifndef PROJECT_UTILS_FORMAT_HPP
+#define PROJECT_UTILS_FORMAT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace Project::utils::fmt {
+    enum class Kind : uint8_t {
+        Decimal,  ///< %d %i, any integer
+        Unsigned, ///< %u, unsigned integers
+        Hex,      ///< %x, unsigned integers
+        HexUpper, ///< %X, unsigned integers
+        Char,     ///< %c
+        String,   ///< %s, anything a std::string_view is made of
+        Fixed,    ///< %f, floating point in fixed notation, 6 decimals unless a precision is given
+    };
+
+    struct Conversion {
+        Kind kind = Kind::Decimal;
+        uint8_t width = 0;
+        uint8_t precision = 0;
+        bool has_precision = false;
+        bool left = false;  ///< flag -
+        bool zero = false;  ///< flag 0
+    };
+
+    /// base of the types FMT() makes
+    struct Literal {};
+
+    template <typename T>
+    constexpr bool is_literal = std::is_base_of_v<Literal, T>;
+
+    constexpr uint8_t max_width = 32;
+    constexpr uint8_t max_fixed_precision = 9;
+
+    /// character buffer owned by the caller as a sink, output past its size is cut off and
+    /// it is kept null terminated
+    struct Buffer {
+        char* data;
+        size_t size;
+        size_t len = 0;
+
+        void write(std::string_view str);
+    };
+
+    /// digits of value, buf must hold 20
+    size_t to_chars(uint32_t value, bool hex, bool upper, char* buf);
+    size_t to_chars(uint64_t value, bool hex, bool upper, char* buf);
+
+    /// value with precision decimals like %.*f, which the nano libc printf lacks; the scaled
+    /// value is rounded half up, so ties may differ from printf in the last decimal, and values
+    /// too large for fixed notation are written in exponent notation
+    /// @param buf at least 32 bytes
+    size_t to_chars_fixed(double value, uint8_t precision, char* buf);
+
+    /// conversion spec after a %, i at its first character; on success i is left at its
+    /// conversion character
+    constexpr bool parse_spec(std::string_view str, size_t& i, Conversion& conv) {
+        for (; i < str.size() and (str[i] == '-' or str[i] == '0'); ++i) {
+            conv.left = conv.left or str[i] == '-';
+            conv.zero = conv.zero or str[i] == '0';
+        }
+        // both are checked after every digit and before they are narrowed, so they can't wrap
+        unsigned n = 0;
+        for (; i < str.size() and str[i] >= '0' and str[i] <= '9'; ++i) {
+            n = n * 10 + unsigned(str[i] - '0');
+            if (n > max_width) {
+                return false;
+            }
+        }
+        conv.width = uint8_t(n);
+        if (i < str.size() and str[i] == '.') {
+            conv.has_precision = true;
+            for (n = 0, ++i; i < str.size() and str[i] >= '0' and str[i] <= '9'; ++i) {
+                n = n * 10 + unsigned(str[i] - '0');
+                if (n > UINT8_MAX) {
+                    return false;
+                }
+            }
+            conv.precision = uint8_t(n);
+        }
+        // the argument type is known, length modifiers are accepted for familiarity
+        for (; i < str.size() and (str[i] == 'h' or str[i] == 'l' or str[i] == 'z' or str[i] == 'j' or str[i] == 't'); ++i) {}
+        if (i == str.size()) {
+            return false;
+        }
+
+        switch (str[i]) {
+            case 'd': case 'i': conv.kind = Kind::Decimal; break;
+            case 'u': conv.kind = Kind::Unsigned; break;
+            case 'x': conv.kind = Kind::Hex; break;
+            case 'X': conv.kind = Kind::HexUpper; break;
+            case 'c': conv.kind = Kind::Char; break;
+            case 's': conv.kind = Kind::String; break;
+            case 'f': conv.kind = Kind::Fixed; break;
+            default: return false;
+        }
+        // a precision limits strings and sets the decimals of %f, nothing else takes one
+        if (conv.kind == Kind::Fixed) {
+            conv.precision = conv.has_precision ? conv.precision : 6;
+            return conv.precision <= max_fixed_precision;
+        }
+        return conv.kind == Kind::String or not conv.has_precision;
+    }
+
+    struct Counts {
+        size_t args;
+        size_t text;  ///< literal characters, %% counted once
+        bool ok;
+    };
+
+    constexpr Counts count(std::string_view str) {
+        Counts res = {0, 0, true};
+        for (size_t i = 0; i < str.size() and res.ok; ++i) {
+            if (str[i] != '%') {
+                res.text++;
+            } else if (i + 1 < str.size() and str[i + 1] == '%') {
+                res.text++;
+                ++i;
+            } else {
+                Conversion conv = {};
+                ++i;
+                res.ok = parse_spec(str, i, conv);
+                res.args++;
+            }
+        }
+        return res;
+    }
+
+    /// format string split at compile time into the literal text and one conversion per argument
+    template <size_t Args, size_t Text>
+    struct Parsed {
+        char text[Text + 1] = {};         ///< literals back to back, %% as %
+        uint16_t ends[Args + 1] = {};     ///< end of the literal before argument i, the last one ends the text
+        Conversion conversions[Args + 1] = {};
+    };
+
+    template <size_t Args, size_t Text>
+    constexpr Parsed<Args, Text> parse(std::string_view str) {
+        Parsed<Args, Text> res = {};
+        size_t arg = 0, len = 0;
+        for (size_t i = 0; i < str.size() and arg <= Args and len <= Text; ++i) {
+            if (str[i] != '%') {
+                res.text[len++] = str[i];
+            } else if (i + 1 < str.size() and str[i + 1] == '%') {
+                res.text[len++] = '%';
+                ++i;
+            } else {
+                ++i;
+                parse_spec(str, i, res.conversions[arg]);
+                res.ends[arg++] = uint16_t(len);
+            }
+        }
+        res.ends[Args] = uint16_t(len);
+        return res;
+    }
+
+    /// whether an argument of type T may be written by a conversion
+    template <typename T>
+    constexpr bool accepts(Kind kind) {
+        using U = std::remove_cv_t<std::remove_reference_t<T>>;
+        constexpr bool integer = std::is_integral_v<U> and not std::is_same_v<U, bool>;
+        switch (kind) {
+            case Kind::Decimal: return integer;
+            case Kind::Unsigned:
+            case Kind::Hex:
+            case Kind::HexUpper: return integer and std::is_unsigned_v<U>;
+            case Kind::Char: return std::is_same_v<U, char>;
+            case Kind::String: return std::is_convertible_v<const T&, std::string_view>;
+            case Kind::Fixed: return std::is_floating_point_v<U>;
+        }
+        return false;
+    }
+
+    /// parsed format of a FMT() string, in flash
+    template <typename Format>
+    struct Compiled {
+        static constexpr std::string_view str = Format::value();
+        static constexpr Counts counts = count(str);
+        static_assert(counts.ok, "Invalid format string");
+        static constexpr Parsed<counts.args, counts.text> parsed = parse<counts.args, counts.text>(str);
+    };
+
+    template <typename Sink>
+    void pad(Sink& sink, size_t n, char ch) {
+        static constexpr char spaces[max_width + 1] = "                                ";
+        static constexpr char zeros[max_width + 1] = "00000000000000000000000000000000";
+        if (n > 0) {
+            sink.write(std::string_view(ch == '0' ? zeros : spaces, n));
+        }
+    }
+
+    /// one argument, the conversion chosen at compile time
+    template <typename Sink, typename T>
+    void put(Sink& sink, const Conversion& conv, const T& value) {
+        char buf[32];
+        std::string_view str;
+        if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            str = value;
+            if (conv.has_precision and str.size() > conv.precision) {
+                str = str.substr(0, conv.precision);
+            }
+        } else if constexpr (std::is_floating_point_v<T>) {
+            str = {buf, to_chars_fixed(double(value), conv.precision, buf)};
+        } else if (conv.kind == Kind::Char) {
+            buf[0] = char(value);
+            str = {buf, 1};
+        } else {
+            // values that fit go through 32-bit division, which the Cortex-M3 has in hardware
+            using Wide = std::conditional_t<(sizeof(T) > 4), uint64_t, uint32_t>;
+            bool negative = false;
+            if constexpr (std::is_signed_v<T>) {
+                negative = value < 0;
+            }
+            Wide magnitude = negative ? Wide(0) - Wide(value) : Wide(value);
+            bool hex = conv.kind == Kind::Hex or conv.kind == Kind::HexUpper;
+            buf[0] = '-';
+            str = {buf, negative + to_chars(magnitude, hex, conv.kind == Kind::HexUpper, buf + negative)};
+        }
+
+        size_t fill = str.size() < conv.width ? conv.width - str.size() : 0;
+        if (conv.left) {
+            sink.write(str);
+            return pad(sink, fill, ' ');
+        }
+        // zeros go between the sign and the digits
+        if (conv.zero and conv.kind != Kind::String and conv.kind != Kind::Char) {
+            if (not str.empty() and str[0] == '-') {
+                sink.write(str.substr(0, 1));
+                str.remove_prefix(1);
+            }
+            pad(sink, fill, '0');
+        } else {
+            pad(sink, fill, ' ');
+        }
+        sink.write(str);
+    }
+
+    template <typename C, size_t I, typename Sink, typename T>
+    void piece(Sink& sink, const T& value) {
+        constexpr auto& parsed = C::parsed;
+        constexpr size_t begin = I == 0 ? 0 : parsed.ends[I - 1];
+        static_assert(accepts<T>(parsed.conversions[I].kind), "Argument does not match its conversion");
+        if constexpr (parsed.ends[I] > begin) {
+            sink.write(std::string_view(parsed.text + begin, parsed.ends[I] - begin));
+        }
+        put(sink, parsed.conversions[I], value);
+    }
+
+    template <typename C, typename Sink, size_t... I, typename... Args>
+    void write_pieces(Sink& sink, std::index_sequence<I...>, const Args&... args) {
+        constexpr auto& parsed = C::parsed;
+        constexpr size_t n = sizeof...(Args);
+        (piece<C, I>(sink, args), ...);
+        constexpr size_t begin = n == 0 ? 0 : parsed.ends[n == 0 ? 0 : n - 1];
+        if constexpr (parsed.ends[n] > begin) {
+            sink.write(std::string_view(parsed.text + begin, parsed.ends[n] - begin));
+        }
+    }
+
+    /// write to a sink, anything with a `write(std::string_view)` method
+    /// @code
+    /// fmt::write(oled, FMT("t: %3d.%02u\n"), whole, hundredths);
+    /// @endcode
+    template <typename Sink, typename Format, typename... Args>
+    auto write(Sink& sink, Format, const Args&... args) -> std::enable_if_t<is_literal<Format>> {
+        using C = Compiled<Format>;
+        static_assert(sizeof...(Args) == C::counts.args, "Wrong number of arguments");
+        write_pieces<C>(sink, std::index_sequence_for<Args...>{}, args...);
+    }
+
+    /// write into a buffer owned by the caller, cut off and null terminated like snprintf
+    /// @return length written, without the terminator
+    template <typename Format, typename... Args>
+    auto format(char* buf, size_t size, Format str, const Args&... args) -> std::enable_if_t<is_literal<Format>, size_t> {
+        Buffer sink = {buf, size};
+        if (size > 0) {
+            buf[0] = '\0';
+        }
+        write(sink, str, args...);
+        return sink.len;
+    }
+
+    template <size_t N, typename Format, typename... Args>
+    auto format(char (&buf)[N], Format str, const Args&... args) -> std::enable_if_t<is_literal<Format>, size_t> {
+        return format(buf, N, str, args...);
+    }
+}
+
+/// format string checked and split at compile time, for fmt::write and fmt::format
+/// @code
+/// char line[24];
+/// fmt::format(line, FMT("h: %u/%u"), free, total);
+/// @endcode
+#define FMT(str) \
+    ([] { \
+        struct Format : Project::utils::fmt::Literal { \
+            static constexpr std::string_view value() { return str; } \
+        }; \
+        return Format{}; \
+    }())
+
+#endif // PROJECT_UTILS_FORMAT_HPP
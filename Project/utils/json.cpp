@@ -0,0 +1,527 @@
+#include "utils/json.hpp"
+#include <cstring>
+
+using namespace Project::utils;
+
+static size_t skip_space(std::string_view str, size_t pos) {
+    while (pos < str.size() and (str[pos] == ' ' or str[pos] == '\t' or str[pos] == '\r' or str[pos] == '\n')) {
+        ++pos;
+    }
+    return pos;
+}
+
+static size_t string_length(std::string_view str) {
+    for (size_t i = 1; i < str.size(); ++i) {
+        if (str[i] == '\\') {
+            ++i;
+        } else if (str[i] == '"') {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+size_t json::value_length(std::string_view str) {
+    if (str.empty()) {
+        return 0;
+    }
+    if (str[0] == '"') {
+        return string_length(str);
+    }
+    if (str[0] == '{' or str[0] == '[') {
+        // nesting is tracked with a counter, strings are skipped whole so brackets inside them are ignored
+        size_t level = 0;
+        for (size_t i = 0; i < str.size(); ++i) {
+            char ch = str[i];
+            if (ch == '"') {
+                auto n = string_length(str.substr(i));
+                if (n == 0) return 0;
+                i += n - 1;
+            } else if (ch == '{' or ch == '[') {
+                ++level;
+            } else if ((ch == '}' or ch == ']') and --level == 0) {
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+    // number, true, false or null
+    size_t i = 0;
+    while (i < str.size() and str[i] != ',' and str[i] != '}' and str[i] != ']' and str[i] != ' ' and
+           str[i] != '\t' and str[i] != '\r' and str[i] != '\n') {
+        ++i;
+    }
+    return i;
+}
+
+std::string_view json::find(std::string_view object, std::string_view key) {
+    size_t pos = skip_space(object, 0);
+    if (pos == object.size() or object[pos] != '{') {
+        return {};
+    }
+    ++pos;
+
+    for (;;) {
+        pos = skip_space(object, pos);
+        if (pos == object.size() or object[pos] != '"') {
+            return {};
+        }
+        auto name_len = string_length(object.substr(pos));
+        if (name_len == 0) {
+            return {};
+        }
+        auto name = object.substr(pos + 1, name_len - 2);
+
+        pos = skip_space(object, pos + name_len);
+        if (pos == object.size() or object[pos] != ':') {
+            return {};
+        }
+        pos = skip_space(object, pos + 1);
+        auto len = value_length(object.substr(pos));
+        if (len == 0) {
+            return {};
+        }
+        if (name == key) {
+            return object.substr(pos, len);
+        }
+
+        pos = skip_space(object, pos + len);
+        if (pos == object.size() or object[pos] != ',') {
+            return {};
+        }
+        ++pos;
+    }
+}
+
+bool json::to_int(std::string_view raw, int& res) {
+    int64_t value;
+    if (not to_int64(raw, value) or value < INT32_MIN or value > INT32_MAX) {
+        return false;
+    }
+    res = int(value);
+    return true;
+}
+
+bool json::to_int64(std::string_view raw, int64_t& res) {
+    if (raw.empty()) {
+        return false;
+    }
+    bool negative = raw[0] == '-';
+    if (negative) raw.remove_prefix(1);
+    if (raw.empty()) {
+        return false;
+    }
+
+    // the magnitude of INT64_MIN is one more than INT64_MAX
+    uint64_t limit = negative ? uint64_t(INT64_MAX) + 1 : uint64_t(INT64_MAX);
+    uint64_t value = 0;
+    for (char ch : raw) {
+        if (ch < '0' or ch > '9') {
+            return false;
+        }
+        unsigned digit = ch - '0';
+        if (value > (limit - digit) / 10) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+    res = negative ? int64_t(0 - value) : int64_t(value);
+    return true;
+}
+
+static double scale(double num, int exp10) {
+    static constexpr double powers[] = {1e1, 1e2, 1e4, 1e8, 1e16, 1e32, 1e64, 1e128, 1e256};
+    bool down = exp10 < 0;
+    unsigned n = down ? -exp10 : exp10;
+    for (size_t i = 0; n > 0 and i < sizeof(powers) / sizeof(powers[0]); ++i, n >>= 1) {
+        if (n & 1) {
+            num = down ? num / powers[i] : num * powers[i];
+        }
+    }
+    return n > 0 ? (down ? 0.0 : num * 1e256 * 1e256) : num;
+}
+
+bool json::to_double(std::string_view raw, double& res) {
+    size_t i = 0;
+    bool negative = i < raw.size() and raw[i] == '-';
+    if (negative) ++i;
+
+    // 18 digits fit an int64_t, further ones only move the exponent
+    int64_t mantissa = 0;
+    int digits = 0;
+    int exp10 = 0;
+    bool any = false;
+    for (; i < raw.size() and raw[i] >= '0' and raw[i] <= '9'; ++i, any = true) {
+        if (digits < 18) {
+            mantissa = mantissa * 10 + (raw[i] - '0');
+            digits += mantissa > 0;
+        } else {
+            ++exp10;
+        }
+    }
+    if (i < raw.size() and raw[i] == '.') {
+        for (++i; i < raw.size() and raw[i] >= '0' and raw[i] <= '9'; ++i, any = true) {
+            if (digits < 18) {
+                mantissa = mantissa * 10 + (raw[i] - '0');
+                digits += mantissa > 0;
+                --exp10;
+            }
+        }
+    }
+    if (not any) {
+        return false;
+    }
+    if (i < raw.size() and (raw[i] == 'e' or raw[i] == 'E')) {
+        ++i;
+        bool negative_exp = i < raw.size() and raw[i] == '-';
+        if (i < raw.size() and (raw[i] == '-' or raw[i] == '+')) ++i;
+        int exp = 0;
+        size_t start = i;
+        for (; i < raw.size() and raw[i] >= '0' and raw[i] <= '9' and i - start < 4; ++i) {
+            exp = exp * 10 + (raw[i] - '0');
+        }
+        if (i == start) {
+            return false;
+        }
+        exp10 += negative_exp ? -exp : exp;
+    }
+    if (i != raw.size()) {
+        return false;
+    }
+    double value = scale(double(mantissa), exp10);
+    res = negative ? -value : value;
+    return true;
+}
+
+size_t json::format_double(double num, char* buf) {
+    if (num != num or num - num != 0) {
+        ::memcpy(buf, "null", 4);
+        return 4;
+    }
+    size_t n = 0;
+    if (num < 0) {
+        buf[n++] = '-';
+        num = -num;
+    }
+    if (num == 0) {
+        buf[n++] = '0';
+        return n;
+    }
+
+    // six digits as an integer, num = digits * 10^exp10
+    int exp10 = 0;
+    while (num >= 1e16) { num /= 1e16; exp10 += 16; }
+    while (num < 1e-10) { num *= 1e16; exp10 -= 16; }
+    while (num >= 1e6) { num /= 10; ++exp10; }
+    while (num < 1e5) { num *= 10; --exp10; }
+    auto digits = uint32_t(num + 0.5);
+    if (digits == 1000000) {
+        digits = 100000;
+        ++exp10;
+    }
+
+    char text[6];
+    int len = 6;
+    for (int i = 5; i >= 0; --i, digits /= 10) {
+        text[i] = char('0' + digits % 10);
+    }
+    while (len > 1 and text[len - 1] == '0') {
+        --len;
+    }
+
+    // digits before the decimal point, the range %g writes without an exponent
+    int point = exp10 + 6;
+    if (point > 0 and point <= 6) {
+        for (int i = 0; i < point; ++i) {
+            buf[n++] = i < len ? text[i] : '0';
+        }
+        if (len > point) {
+            buf[n++] = '.';
+            for (int i = point; i < len; ++i) buf[n++] = text[i];
+        }
+    } else if (point <= 0 and point > -4) {
+        buf[n++] = '0';
+        buf[n++] = '.';
+        for (int i = point; i < 0; ++i) buf[n++] = '0';
+        for (int i = 0; i < len; ++i) buf[n++] = text[i];
+    } else {
+        buf[n++] = text[0];
+        if (len > 1) {
+            buf[n++] = '.';
+            for (int i = 1; i < len; ++i) buf[n++] = text[i];
+        }
+        buf[n++] = 'e';
+        int exp = point - 1;
+        if (exp < 0) {
+            buf[n++] = '-';
+            exp = -exp;
+        }
+        if (exp >= 100) buf[n++] = char('0' + exp / 100);
+        if (exp >= 10) buf[n++] = char('0' + exp / 10 % 10);
+        buf[n++] = char('0' + exp % 10);
+    }
+    return n;
+}
+
+bool json::to_bool(std::string_view raw, bool& res) {
+    if (raw == "true" or raw == "false") {
+        res = raw == "true";
+        return true;
+    }
+    return false;
+}
+
+static int hex_value(char ch) {
+    if (ch >= '0' and ch <= '9') return ch - '0';
+    if (ch >= 'a' and ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' and ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+bool json::unescape(std::string_view raw, char* dest, size_t& len) {
+    if (raw.size() < 2 or raw.front() != '"' or raw.back() != '"') {
+        return false;
+    }
+    raw = raw.substr(1, raw.size() - 2);
+
+    len = 0;
+    for (size_t i = 0; i < raw.size(); ++i) {
+        char ch = raw[i];
+        if (ch != '\\') {
+            dest[len++] = ch;
+            continue;
+        }
+        if (++i == raw.size()) {
+            return false;
+        }
+        switch (raw[i]) {
+            case '"':  dest[len++] = '"'; break;
+            case '\\': dest[len++] = '\\'; break;
+            case '/':  dest[len++] = '/'; break;
+            case 'b':  dest[len++] = '\b'; break;
+            case 'f':  dest[len++] = '\f'; break;
+            case 'n':  dest[len++] = '\n'; break;
+            case 'r':  dest[len++] = '\r'; break;
+            case 't':  dest[len++] = '\t'; break;
+            case 'u': {
+                // code points are written as UTF-8, surrogate pairs are not combined
+                if (i + 4 >= raw.size()) {
+                    return false;
+                }
+                uint32_t cp = 0;
+                for (size_t k = 1; k <= 4; ++k) {
+                    int h = hex_value(raw[i + k]);
+                    if (h < 0) return false;
+                    cp = cp << 4 | h;
+                }
+                i += 4;
+                if (cp < 0x80) {
+                    dest[len++] = char(cp);
+                } else if (cp < 0x800) {
+                    dest[len++] = char(0xC0 | cp >> 6);
+                    dest[len++] = char(0x80 | (cp & 0x3F));
+                } else {
+                    dest[len++] = char(0xE0 | cp >> 12);
+                    dest[len++] = char(0x80 | (cp >> 6 & 0x3F));
+                    dest[len++] = char(0x80 | (cp & 0x3F));
+                }
+                break;
+            }
+            default: return false;
+        }
+    }
+    return true;
+}
+
+/// content of the string token of n bytes at pos, unescaped in place if it has escapes
+static bool string_token(char* buf, size_t pos, size_t n, std::string_view& res) {
+    std::string_view raw(buf + pos, n);
+    if (raw.find('\\') == std::string_view::npos) {
+        res = raw.substr(1, n - 2);
+        return true;
+    }
+    size_t len;
+    if (not json::unescape(raw, buf + pos + 1, len)) {
+        return false;
+    }
+    res = {buf + pos + 1, len};
+    return true;
+}
+
+static bool is_delimiter(char ch) {
+    return ch == ',' or ch == '}' or ch == ']' or ch == ':' or ch == ' ' or ch == '\t' or ch == '\r' or ch == '\n';
+}
+
+json::Parser::Status json::Parser::feed(char* buf, size_t len, bool last) {
+    if (status != Status::Incomplete) {
+        return status;
+    }
+
+    std::string_view input(buf, len);
+    for (;;) {
+        pos = skip_space(input, pos);
+        if (pos == len) {
+            return last ? fail() : status;
+        }
+
+        char ch = buf[pos];
+        auto top = depth > 0 ? &frames[depth - 1] : nullptr;
+        switch (expect) {
+            case Expect::Value:
+                if (ch == ']' and top and not top->object and top->first) {
+                    ++pos;
+                    if (close()) {
+                        return status;
+                    }
+                } else if (not value(buf, len, last)) {
+                    return status;
+                }
+                break;
+
+            case Expect::Key: {
+                if (ch == '}' and top->first) {
+                    ++pos;
+                    if (close()) {
+                        return status;
+                    }
+                    break;
+                }
+                if (ch != '"') {
+                    return fail();
+                }
+                auto n = string_length(input.substr(pos));
+                if (n == 0) {
+                    return last ? fail() : status;
+                }
+                std::string_view key;
+                if (not string_token(buf, pos, n, key)) {
+                    return fail();
+                }
+                pending = {};
+                auto& parent = top->target;
+                if (parent.binding and not parent.binding->child(parent.ptr, key, 0, pending)) {
+                    return fail();
+                }
+                pos += n;
+                expect = Expect::Colon;
+                break;
+            }
+
+            case Expect::Colon:
+                if (ch != ':') {
+                    return fail();
+                }
+                ++pos;
+                expect = Expect::Value;
+                break;
+
+            case Expect::Next:
+                if (ch == (top->object ? '}' : ']')) {
+                    ++pos;
+                    if (close()) {
+                        return status;
+                    }
+                    break;
+                }
+                if (ch != ',') {
+                    return fail();
+                }
+                ++pos;
+                top->first = false;
+                if (top->object) {
+                    expect = Expect::Key;
+                    break;
+                }
+                pending = {};
+                if (top->target.binding and not top->target.binding->child(top->target.ptr, {}, ++top->index, pending)) {
+                    return fail();
+                }
+                expect = Expect::Value;
+                break;
+        }
+    }
+}
+
+bool json::Parser::value(char* buf, size_t len, bool last) {
+    std::string_view input(buf, len);
+    auto target = pending;
+    auto binding = target.binding;
+    char ch = buf[pos];
+
+    if (ch == '{' or ch == '[') {
+        bool object = ch == '{';
+        if ((binding and binding->kind != (object ? Binding::Kind::Object : Binding::Kind::Array)) or depth == max_depth) {
+            fail();
+            return false;
+        }
+        frames[depth++] = {target, 0, object, true};
+        ++pos;
+        pending = {};
+        expect = object ? Expect::Key : Expect::Value;
+        if (not object and binding and not binding->child(target.ptr, {}, 0, pending)) {
+            fail();
+            return false;
+        }
+        return true;
+    }
+
+    std::string_view token;
+    auto kind = Binding::Kind::String;
+    if (ch == '"') {
+        auto n = string_length(input.substr(pos));
+        if (n == 0) {
+            if (last) fail();
+            return false;
+        }
+        if (not string_token(buf, pos, n, token)) {
+            fail();
+            return false;
+        }
+        pos += n;
+    } else {
+        // a number is only known to be complete once its delimiter arrived
+        size_t end = pos;
+        while (end < len and not is_delimiter(buf[end])) {
+            ++end;
+        }
+        if (end == len and not last) {
+            return false;
+        }
+        token = input.substr(pos, end - pos);
+        if (token == "null") {
+            binding = nullptr;
+        } else if (token == "true" or token == "false") {
+            kind = Binding::Kind::Bool;
+        } else if (token.empty() or not (token[0] == '-' or (token[0] >= '0' and token[0] <= '9'))) {
+            fail();
+            return false;
+        } else {
+            kind = Binding::Kind::Integer;
+        }
+        pos = end;
+    }
+
+    // a float member takes integers as well
+    if (binding and kind == Binding::Kind::Integer and binding->kind == Binding::Kind::Number) {
+        kind = Binding::Kind::Number;
+    }
+    if (binding and (binding->kind != kind or not binding->set(target.ptr, token))) {
+        fail();
+        return false;
+    }
+    return not end_value();
+}
+
+bool json::Parser::close() {
+    --depth;
+    return end_value();
+}
+
+bool json::Parser::end_value() {
+    if (depth == 0) {
+        status = Status::Complete;
+        return true;
+    }
+    expect = Expect::Next;
+    return false;
+}
@@ -0,0 +1,381 @@
+#ifndef PROJECT_UTILS_JSON_HPP
+#define PROJECT_UTILS_JSON_HPP
+
+#include "utils/arena.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace Project::utils::json {
+    template <typename Sink> class Writer;
+    class Parser;
+
+    /// members of a struct as JSON sees them, specialized with JSON_SCHEMA
+    template <typename T> struct Schema {};
+
+    template <typename T, typename M>
+    struct Member {
+        std::string_view name;
+        M T::* ptr;
+    };
+
+    template <typename T, typename M>
+    constexpr Member<T, M> member(std::string_view name, M T::* ptr) { return {name, ptr}; }
+
+    template <typename T, typename = void>
+    struct has_schema : std::false_type {};
+
+    template <typename T>
+    struct has_schema<T, std::void_t<decltype(Schema<T>::members)>> : std::true_type {};
+
+    /// raw text of the value of a top-level key of an object
+    /// @return empty view if the key is not found or the text is malformed
+    std::string_view find(std::string_view object, std::string_view key);
+
+    /// length of the value at the start of str, 0 if it is malformed
+    size_t value_length(std::string_view str);
+
+    bool to_int(std::string_view raw, int& res);
+    bool to_bool(std::string_view raw, bool& res);
+
+    /// decimal or exponent notation, not correctly rounded past 15 significant digits
+    bool to_double(std::string_view raw, double& res);
+
+    /// format num with 6 significant digits like %g, which the nano libc printf lacks
+    /// @param buf at least 16 bytes
+    /// @return length written, "null" for nan and infinity which JSON has no notation for
+    size_t format_double(double num, char* buf);
+
+    /// unescape a raw string value into dest, which must hold at least raw.size() bytes
+    /// @return false if raw is not a string
+    bool unescape(std::string_view raw, char* dest, size_t& len);
+
+    /// unescape a raw string value, a string without escapes is returned as a slice of raw
+    /// @return false if raw is not a string or the arena is exhausted
+    template <size_t N>
+    bool to_string(std::string_view raw, Arena<N>& arena, std::string_view& res) {
+        if (raw.size() < 2 or raw.front() != '"' or raw.back() != '"') {
+            return false;
+        }
+        if (raw.find('\\') == std::string_view::npos) {
+            res = raw.substr(1, raw.size() - 2);
+            return true;
+        }
+        auto dest = arena.template allocate_array<char>(raw.size());
+        size_t len = 0;
+        if (dest == nullptr or not unescape(raw, dest, len)) {
+            return false;
+        }
+        res = {dest, len};
+        return true;
+    }
+
+    /// where the parser stores a value, generated for every supported type
+    struct Binding {
+        enum class Kind : uint8_t { Object, Array, String, Integer, Number, Bool };
+
+        struct Target {
+            void* ptr;
+            const Binding* binding;  ///< nullptr for a value that is skipped
+        };
+
+        Kind kind;
+        /// member of an object by key, or element of an array by index
+        /// @return false if the element is past the end of the array
+        bool (*child)(void* ptr, std::string_view key, size_t index, Target& res);
+        /// scalar from its token: the unescaped content of a string, a number, true or false
+        bool (*set)(void* ptr, std::string_view token);
+
+        template <typename T>
+        static constexpr Binding of();
+
+        template <typename T>
+        static Target target(T& value);
+    };
+
+    bool to_int64(std::string_view raw, int64_t& res);
+}
+
+/// describe the members of a struct for the json Writer and Parser
+/// @code
+/// struct Foo { int num; std::string_view text; };
+/// JSON_SCHEMA(Foo, JSON_MEMBER("num", num), JSON_MEMBER("text", text));
+/// @endcode
+/// @note used at global scope, like APP
+#define JSON_SCHEMA(type, ...) \
+    template <> struct Project::utils::json::Schema<type> { \
+        using Type = type; \
+        static constexpr auto members = std::make_tuple(__VA_ARGS__); \
+    }
+
+#define JSON_MEMBER(name, field) Project::utils::json::member(name, &Type::field)
+
+/// Streaming JSON writer.
+/// Tokens go straight to the sink as they are written, so the document is never held in
+/// memory as a whole. The sink only needs a `write(std::string_view)` method.
+template <typename Sink>
+class Project::utils::json::Writer {
+public:
+    static constexpr size_t max_depth = 16;
+
+    explicit Writer(Sink& sink) : sink(sink) {}
+
+    Writer& begin_object() { return open('{'); }
+    Writer& end_object() { return close('}'); }
+    Writer& begin_array() { return open('['); }
+    Writer& end_array() { return close(']'); }
+
+    Writer& key(std::string_view name) {
+        separator();
+        string(name);
+        sink.write(":");
+        after_key = true;
+        return *this;
+    }
+
+    Writer& value(std::string_view str) {
+        separator();
+        string(str);
+        return *this;
+    }
+
+    Writer& value(const char* str) { return value(std::string_view(str)); }
+
+    Writer& value(long long num) { return integer(num < 0 ? 0ull - (unsigned long long) num : num, num < 0); }
+    Writer& value(unsigned long long num) { return integer(num, false); }
+    Writer& value(long num) { return value((long long) num); }
+    Writer& value(unsigned long num) { return value((unsigned long long) num); }
+    Writer& value(int num) { return value((long long) num); }
+    Writer& value(unsigned int num) { return value((unsigned long long) num); }
+    Writer& value(bool b) { separator(); sink.write(b ? "true" : "false"); return *this; }
+    Writer& value(std::nullptr_t) { separator(); sink.write("null"); return *this; }
+
+    Writer& value(double num) {
+        char buf[16];
+        separator();
+        sink.write({buf, format_double(num, buf)});
+        return *this;
+    }
+
+    /// struct described with JSON_SCHEMA, written as an object member by member
+    template <typename T, typename = std::enable_if_t<has_schema<T>::value>>
+    Writer& value(const T& object) {
+        begin_object();
+        std::apply([&](const auto&... members) { (member(members.name, object.*members.ptr), ...); }, Schema<T>::members);
+        return end_object();
+    }
+
+    template <typename T, size_t N, typename = std::enable_if_t<not std::is_same_v<T, char>>>
+    Writer& value(const T (&items)[N]) {
+        begin_array();
+        for (auto& item : items) {
+            value(item);
+        }
+        return end_array();
+    }
+
+    /// write text that is already valid JSON
+    Writer& raw(std::string_view text) { separator(); sink.write(text); return *this; }
+
+    template <typename T>
+    Writer& member(std::string_view name, const T& val) { return key(name).value(val); }
+
+private:
+    Writer& integer(unsigned long long num, bool negative) {
+        char buf[21];
+        size_t pos = sizeof(buf);
+        // 64-bit division is a library call on the M3, it is only used for the upper digits
+        while (num > UINT32_MAX) {
+            buf[--pos] = char('0' + num % 10);
+            num /= 10;
+        }
+        for (auto low = uint32_t(num); pos == sizeof(buf) or low > 0; low /= 10) {
+            buf[--pos] = char('0' + low % 10);
+        }
+        if (negative) {
+            buf[--pos] = '-';
+        }
+        separator();
+        sink.write({buf + pos, sizeof(buf) - pos});
+        return *this;
+    }
+
+    Writer& open(char ch) {
+        separator();
+        sink.write({&ch, 1});
+        if (depth < max_depth) first |= 1u << ++depth;
+        return *this;
+    }
+
+    Writer& close(char ch) {
+        if (depth > 0) first &= ~(1u << depth--);
+        sink.write({&ch, 1});
+        return *this;
+    }
+
+    void separator() {
+        if (after_key) {
+            after_key = false;
+        } else if (first & (1u << depth)) {
+            first &= ~(1u << depth);
+        } else if (depth > 0) {
+            sink.write(",");
+        }
+    }
+
+    void string(std::string_view str) {
+        static constexpr char hex[] = "0123456789abcdef";
+        sink.write("\"");
+        size_t start = 0;
+        for (size_t i = 0; i < str.size(); ++i) {
+            auto ch = uint8_t(str[i]);
+            if (ch >= 0x20 and ch != '"' and ch != '\\') {
+                continue;
+            }
+            sink.write(str.substr(start, i - start));
+            start = i + 1;
+            switch (ch) {
+                case '"':  sink.write("\\\""); break;
+                case '\\': sink.write("\\\\"); break;
+                case '\n': sink.write("\\n"); break;
+                case '\r': sink.write("\\r"); break;
+                case '\t': sink.write("\\t"); break;
+                default: {
+                    char esc[] = {'\\', 'u', '0', '0', hex[ch >> 4], hex[ch & 0xF]};
+                    sink.write({esc, sizeof(esc)});
+                }
+            }
+        }
+        sink.write(str.substr(start));
+        sink.write("\"");
+    }
+
+    Sink& sink;
+    uint32_t first = 1;  ///< one bit per nesting level, set until the first element is written
+    size_t depth = 0;
+    bool after_key = false;
+};
+
+/// Incremental JSON parser that fills a struct described with JSON_SCHEMA.
+/// Tokens are read one by one and stored straight into the member they belong to, so
+/// there is no document tree, and string members are std::string_view slices of the input.
+/// Escaped strings are unescaped in place, which is why the input is not const.
+///
+/// The input may arrive in pieces: feed() is called again with the same buffer each time
+/// more bytes were appended to it, and resumes at the token it stopped at. Unknown members
+/// are skipped, a value of the wrong type makes the document invalid.
+/// @code
+/// Foo foo = {};
+/// json::Parser parser(foo);
+/// while (parser.feed(buf, len) == json::Parser::Status::Incomplete) {
+///     len += receive(buf + len, sizeof(buf) - len);
+/// }
+/// @endcode
+/// @note the buffer must outlive the struct, and must not move while a document is parsed
+class Project::utils::json::Parser {
+public:
+    static constexpr size_t max_depth = 8;
+
+    enum class Status {
+        Complete,   ///< the document is parsed and the struct is filled
+        Incomplete, ///< more bytes are needed
+        Invalid,    ///< malformed document, or a value that does not fit its member
+    };
+
+    template <typename T>
+    explicit Parser(T& root) : pending(Binding::target(root)) {}
+
+    /// parse the bytes appended to buf since the last call
+    /// @param last no more bytes follow, a number at the end of buf is complete
+    Status feed(char* buf, size_t len, bool last = false);
+
+    /// number of bytes taken by the document once it is complete
+    size_t size() const { return pos; }
+
+private:
+    enum class Expect : uint8_t { Value, Key, Colon, Next };
+
+    struct Frame {
+        Binding::Target target;
+        uint16_t index;
+        bool object;
+        bool first;
+    };
+
+    /// @return false to stop: the document is complete or invalid, or the token is cut off
+    bool value(char* buf, size_t len, bool last);
+    /// @return true if the document is complete
+    bool close();
+    bool end_value();
+    Status fail() { return status = Status::Invalid; }
+
+    Binding::Target pending;  ///< where the next value goes
+    Frame frames[max_depth] = {};
+    size_t depth = 0;
+    size_t pos = 0;
+    Expect expect = Expect::Value;
+    Status status = Status::Incomplete;
+};
+
+template <typename T>
+constexpr Project::utils::json::Binding Project::utils::json::Binding::of() {
+    if constexpr (has_schema<T>::value) {
+        return {Kind::Object, [](void* ptr, std::string_view key, size_t, Target& res) {
+            res = {};
+            std::apply([&](const auto&... members) {
+                ((key == members.name ? (res = target(static_cast<T*>(ptr)->*members.ptr), true) : false) or ...);
+            }, Schema<T>::members);
+            return true;
+        }, nullptr};
+    } else if constexpr (std::is_array_v<T>) {
+        return {Kind::Array, [](void* ptr, std::string_view, size_t index, Target& res) {
+            if (index >= std::extent_v<T>) {
+                return false;
+            }
+            res = target((*static_cast<T*>(ptr))[index]);
+            return true;
+        }, nullptr};
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return {Kind::Bool, nullptr, [](void* ptr, std::string_view token) {
+            *static_cast<bool*>(ptr) = token == "true";
+            return true;
+        }};
+    } else if constexpr (std::is_integral_v<T>) {
+        static_assert(sizeof(T) < sizeof(int64_t) or std::is_signed_v<T>, "Integers are parsed as int64_t");
+        return {Kind::Integer, nullptr, [](void* ptr, std::string_view token) {
+            int64_t value;
+            if (not to_int64(token, value) or value < int64_t(std::numeric_limits<T>::min()) or
+                value > int64_t(std::numeric_limits<T>::max())) {
+                return false;
+            }
+            *static_cast<T*>(ptr) = T(value);
+            return true;
+        }};
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return {Kind::Number, nullptr, [](void* ptr, std::string_view token) {
+            double value;
+            if (not to_double(token, value)) {
+                return false;
+            }
+            *static_cast<T*>(ptr) = T(value);
+            return true;
+        }};
+    } else {
+        static_assert(std::is_same_v<T, std::string_view>, "Unsupported member type");
+        return {Kind::String, nullptr, [](void* ptr, std::string_view token) {
+            *static_cast<std::string_view*>(ptr) = token;
+            return true;
+        }};
+    }
+}
+
+template <typename T>
+Project::utils::json::Binding::Target Project::utils::json::Binding::target(T& value) {
+    static constexpr Binding binding = of<T>();
+    return {&value, &binding};
+}
+
+#endif // PROJECT_UTILS_JSON_HPP
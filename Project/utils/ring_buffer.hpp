@@ -0,0 +1,138 @@
+#ifndef PROJECT_UTILS_RING_BUFFER_HPP
+#define PROJECT_UTILS_RING_BUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Project::utils {
+    template <typename T, size_t N> class RingBuffer;
+}
+
+/// Lock-free single-producer/single-consumer ring.
+/// One side may run in an ISR and the other in a task without a critical section:
+/// the producer only writes head, the consumer only writes tail, and each index is
+/// published after the data it covers. Cortex-M3 is single core and keeps the order of
+/// its loads and stores, so a compiler fence is the only barrier needed.
+/// @note indices run freely and are masked on access, which requires a power of two capacity
+template <typename T, size_t N>
+class Project::utils::RingBuffer {
+    static_assert(N > 0 and (N & (N - 1)) == 0, "Capacity must be a power of two");
+    static constexpr size_t mask = N - 1;
+
+public:
+    /// contiguous region of the buffer, e.g. for a DMA transfer
+    struct Span {
+        T* data;
+        size_t len;
+    };
+
+    static constexpr size_t capacity() { return N; }
+
+    size_t size() const { return head - tail; }
+    size_t free() const { return N - size(); }
+    bool empty() const { return head == tail; }
+    bool full() const { return size() == N; }
+
+    /// producer side
+    bool push(const T& item) {
+        size_t h = head;
+        if (h - acquire(tail) == N) {
+            return false;
+        }
+        buffer[h & mask] = item;
+        publish_head(h + 1);
+        return true;
+    }
+
+    /// producer side
+    /// @return number of items pushed
+    size_t push_n(const T* src, size_t n) {
+        size_t h = head;
+        n = min(n, N - (h - acquire(tail)));
+        for (size_t i = 0; i < n; ++i) {
+            buffer[(h + i) & mask] = src[i];
+        }
+        publish_head(h + n);
+        return n;
+    }
+
+    /// producer side: free region that can be filled in place, see commit
+    Span write_span() {
+        size_t h = head;
+        size_t offset = h & mask;
+        return {&buffer[offset], min(N - (h - acquire(tail)), N - offset)};
+    }
+
+    /// producer side: publish n items written through write_span
+    void commit(size_t n) {
+        publish_head(head + n);
+    }
+
+    /// consumer side
+    bool pop(T& item) {
+        size_t t = tail;
+        if (acquire(head) == t) {
+            return false;
+        }
+        item = buffer[t & mask];
+        publish_tail(t + 1);
+        return true;
+    }
+
+    /// consumer side
+    /// @return number of items popped
+    size_t pop_n(T* dst, size_t n) {
+        size_t t = tail;
+        n = min(n, acquire(head) - t);
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = buffer[(t + i) & mask];
+        }
+        publish_tail(t + n);
+        return n;
+    }
+
+    /// consumer side: oldest items that can be read in place, see consume
+    Span read_span() {
+        size_t t = tail;
+        size_t offset = t & mask;
+        return {&buffer[offset], min(acquire(head) - t, N - offset)};
+    }
+
+    /// consumer side: release n items read through read_span
+    void consume(size_t n) {
+        publish_tail(tail + n);
+    }
+
+    /// drop everything, only valid while neither side is running
+    void clear() {
+        head = 0;
+        tail = 0;
+    }
+
+private:
+    static size_t min(size_t a, size_t b) { return a < b ? a : b; }
+
+    /// read the index owned by the other side before touching the data it covers
+    static size_t acquire(const volatile size_t& index) {
+        size_t value = index;
+        std::atomic_signal_fence(std::memory_order_acquire);
+        return value;
+    }
+
+    void publish_head(size_t h) {
+        std::atomic_signal_fence(std::memory_order_release);
+        head = h;
+    }
+
+    void publish_tail(size_t t) {
+        std::atomic_signal_fence(std::memory_order_release);
+        tail = t;
+    }
+
+    T buffer[N] = {};
+    volatile size_t head = 0;
+    volatile size_t tail = 0;
+};
+
+#endif // PROJECT_UTILS_RING_BUFFER_HPP
@@ -131,6 +131,18 @@ __weak void CDC_ReceiveCplt_Callback(const uint8_t *pbuf, uint32_t len) {
   UNUSED(pbuf);
   UNUSED(len);
 }
+
+/* Returns the buffer armed for the first OUT packet after enumeration */
+__weak uint8_t* CDC_ReceiveStream_Init(void) {
+  return UserRxBufferFS;
+}
+
+/* Takes a filled OUT buffer and returns the buffer to arm next, or NULL to NAK the host
+   until CDC_ReceiveResume_FS is called */
+__weak uint8_t* CDC_ReceiveStream_Callback(uint8_t *pbuf, uint32_t len) {
+  CDC_ReceiveCplt_Callback(pbuf, len);
+  return pbuf;
+}
 /* USER CODE END PRIVATE_FUNCTIONS_DECLARATION */
 
 /**
@@ -155,7 +167,7 @@ static int8_t CDC_Init_FS(void)
   /* USER CODE BEGIN 3 */
   /* Set Application Buffers */
   USBD_CDC_SetTxBuffer(&hUsbDeviceFS, UserTxBufferFS, 0);
-  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS);
+  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, CDC_ReceiveStream_Init());
   return (USBD_OK);
   /* USER CODE END 3 */
 }
@@ -262,9 +274,11 @@ static int8_t CDC_Control_FS(uint8_t cmd, uint8_t* pbuf, uint16_t length)
 static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
 {
   /* USER CODE BEGIN 6 */
-  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, &Buf[0]);
-  USBD_CDC_ReceivePacket(&hUsbDeviceFS);
-  CDC_ReceiveCplt_Callback(Buf, *Len);
+  uint8_t *next = CDC_ReceiveStream_Callback(Buf, *Len);
+  if (next != NULL) {
+    USBD_CDC_SetRxBuffer(&hUsbDeviceFS, next);
+    USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+  }
   return (USBD_OK);
   /* USER CODE END 6 */
 }
@@ -295,6 +309,20 @@ uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len)
 }
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_IMPLEMENTATION */
+/**
+  * @brief  CDC_ReceiveResume_FS
+  *         Re-arm the OUT endpoint after CDC_ReceiveStream_Callback returned NULL
+  * @param  Buf: Buffer for the next OUT packet
+  * @retval USBD_OK if all operations are OK else USBD_FAIL
+  */
+uint8_t CDC_ReceiveResume_FS(uint8_t* Buf)
+{
+  if (hUsbDeviceFS.pClassData == NULL) {
+    return USBD_FAIL;
+  }
+  USBD_CDC_SetRxBuffer(&hUsbDeviceFS, Buf);
+  return USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+}
 
 /* USER CODE END PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
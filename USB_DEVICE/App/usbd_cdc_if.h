@@ -93,6 +93,8 @@
 extern USBD_CDC_ItfTypeDef USBD_Interface_fops_FS;
 
 /* USER CODE BEGIN EXPORTED_VARIABLES */
+extern USBD_HandleTypeDef hUsbDeviceFS;
+extern uint8_t UserRxBufferFS[APP_RX_DATA_SIZE];
 
 /* USER CODE END EXPORTED_VARIABLES */
 
@@ -108,6 +110,7 @@ extern USBD_CDC_ItfTypeDef USBD_Interface_fops_FS;
 uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len);
 
 /* USER CODE BEGIN EXPORTED_FUNCTIONS */
+uint8_t CDC_ReceiveResume_FS(uint8_t* Buf);
 
 /* USER CODE END EXPORTED_FUNCTIONS */
 
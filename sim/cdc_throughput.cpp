@@ -0,0 +1,330 @@
+// The USB CDC transmit path of the firmware through a simulated full-speed device controller.
+// The ST device library core and CDC class, usbd_cdc_if.c and drivers/cdc.cpp are built as
+// they are; the USBD_LL layer under them is played here in simulated time.
+//
+// The bus carries 1 ms frames of 19 bulk IN transactions of up to 64 bytes, the most a
+// full-speed host schedules for one endpoint, i.e. 1216 bytes/ms. An IN token takes the packet
+// the endpoint holds in packet memory or is NAKed. An ACKed packet raises the correct-transfer
+// interrupt, which is served after some latency and loads the next packet of the transfer, or
+// ends the transfer with the DataIn callback of the class. The endpoint holds one packet, or
+// two when it is double-buffered.
+//
+// A telemetry task offers a 48-byte line every 25 us, more than the bus carries, and the host
+// checks that it receives exactly the bytes that were accepted, in order. Every path runs with
+// a quiet CPU, which serves the interrupt in 6 us, and a busy one, where one interrupt in four
+// also waits up to 150 us behind others:
+//   - the single-shot CDC_Transmit_FS, dropping a line when it returns USBD_BUSY
+//   - the single-shot CDC_Transmit_FS, spinning until it is accepted
+//   - drivers::CDC with endpoint 0x81 single-buffered
+//   - drivers::CDC with endpoint 0x81 double-buffered, as usbd_conf.c sets it up
+//
+//   cdc_throughput [milliseconds]
+
+#include "drivers/cdc.hpp"
+#include "usbd_cdc_if.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+using namespace Project;
+
+static constexpr size_t packet_size = CDC_DATA_FS_MAX_PACKET_SIZE;
+static constexpr double slot = 1000.0 / 19;  ///< us per bulk transaction
+static constexpr size_t line_size = 48;
+static constexpr double line_period = 25;    ///< us between two lines of the task
+
+USBD_HandleTypeDef hUsbDeviceFS;
+static PCD_HandleTypeDef hpcd;
+
+enum class Path { Drop, Spin, Ring };
+
+struct Run {
+    const char* name;
+    Path path;
+    bool double_buffered;
+    bool busy_cpu;
+};
+
+struct Result {
+    uint64_t offered, accepted, delivered;
+    uint64_t packets, short_packets, naks, transfers;
+    double blocked;   ///< us the task spent waiting to hand a line over
+    uint64_t errors;  ///< delivered bytes that differ from the accepted ones
+};
+
+/// bulk IN endpoint 1 of the device controller
+static struct {
+    bool double_buffered;
+    const uint8_t* data;
+    size_t len;
+    size_t loaded;        ///< bytes of the transfer moved to packet memory
+    size_t packets;       ///< packets of the transfer, a zero-length one counts
+    size_t queued;        ///< packets moved to packet memory
+    size_t acked;         ///< packets the host took
+    bool active;
+    uint8_t memory[2][packet_size];
+    size_t size[2];
+    bool full[2];
+    int read;             ///< buffer the host takes next
+    int write;            ///< buffer loaded next
+} ep;
+
+static std::deque<double> interrupts;  ///< when each pending correct-transfer interrupt is served
+static Result result;
+
+/// copy packets of the transfer into free packet memory, as the PCD does
+static void load() {
+    int buffers = ep.double_buffered ? 2 : 1;
+    while (ep.active and not ep.full[ep.write] and ep.queued < ep.packets) {
+        size_t n = std::min(packet_size, ep.len - ep.loaded);
+        ::memcpy(ep.memory[ep.write], ep.data + ep.loaded, n);
+        ep.size[ep.write] = n;
+        ep.full[ep.write] = true;
+        ep.loaded += n;
+        ep.queued++;
+        ep.write = (ep.write + 1) % buffers;
+    }
+}
+
+extern "C" {
+    USBD_StatusTypeDef USBD_LL_Init(USBD_HandleTypeDef* pdev) {
+        hpcd.pData = pdev;
+        pdev->pData = &hpcd;
+        return USBD_OK;
+    }
+
+    USBD_StatusTypeDef USBD_LL_DeInit(USBD_HandleTypeDef*) { return USBD_OK; }
+    USBD_StatusTypeDef USBD_LL_Start(USBD_HandleTypeDef*) { return USBD_OK; }
+    USBD_StatusTypeDef USBD_LL_Stop(USBD_HandleTypeDef*) { return USBD_OK; }
+    USBD_StatusTypeDef USBD_LL_CloseEP(USBD_HandleTypeDef*, uint8_t) { return USBD_OK; }
+    USBD_StatusTypeDef USBD_LL_FlushEP(USBD_HandleTypeDef*, uint8_t) { return USBD_OK; }
+    USBD_StatusTypeDef USBD_LL_StallEP(USBD_HandleTypeDef*, uint8_t) { return USBD_OK; }
+    USBD_StatusTypeDef USBD_LL_ClearStallEP(USBD_HandleTypeDef*, uint8_t) { return USBD_OK; }
+    uint8_t USBD_LL_IsStallEP(USBD_HandleTypeDef*, uint8_t) { return 0; }
+    USBD_StatusTypeDef USBD_LL_SetUSBAddress(USBD_HandleTypeDef*, uint8_t) { return USBD_OK; }
+    uint32_t USBD_LL_GetRxDataSize(USBD_HandleTypeDef*, uint8_t) { return 0; }
+
+    USBD_StatusTypeDef USBD_LL_OpenEP(USBD_HandleTypeDef*, uint8_t ep_addr, uint8_t, uint16_t ep_mps) {
+        auto& pep = ep_addr & 0x80 ? hpcd.IN_ep[ep_addr & 0x7] : hpcd.OUT_ep[ep_addr & 0x7];
+        pep.num = ep_addr & 0x7;
+        pep.is_in = (ep_addr & 0x80) != 0;
+        pep.maxpacket = ep_mps;
+        return USBD_OK;
+    }
+
+    // OUT traffic is not simulated, the endpoint just stays armed
+    USBD_StatusTypeDef USBD_LL_PrepareReceive(USBD_HandleTypeDef*, uint8_t ep_addr, uint8_t* pbuf, uint16_t size) {
+        hpcd.OUT_ep[ep_addr & 0x7].xfer_buff = pbuf;
+        hpcd.OUT_ep[ep_addr & 0x7].xfer_len = size;
+        return USBD_OK;
+    }
+
+    // control transfers complete at once, only the bulk IN endpoint goes over the bus model
+    USBD_StatusTypeDef USBD_LL_Transmit(USBD_HandleTypeDef*, uint8_t ep_addr, uint8_t* pbuf, uint16_t size) {
+        hpcd.IN_ep[ep_addr & 0x7].xfer_buff = pbuf;
+        hpcd.IN_ep[ep_addr & 0x7].xfer_len = size;
+        if ((ep_addr & 0x7F) != (CDC_IN_EP & 0x7F)) {
+            return USBD_OK;
+        }
+        ep.data = pbuf;
+        ep.len = size;
+        ep.loaded = 0;
+        ep.packets = size == 0 ? 1 : (size + packet_size - 1) / packet_size;
+        ep.queued = 0;
+        ep.acked = 0;
+        ep.active = true;
+        load();
+        return USBD_OK;
+    }
+
+    void* USBD_static_malloc(uint32_t) {
+        static uint32_t mem[(sizeof(USBD_CDC_HandleTypeDef) / 4) + 1];
+        return mem;
+    }
+
+    void USBD_static_free(void*) {}
+}
+
+/// reset, SET_ADDRESS and SET_CONFIGURATION, the class opens its endpoints
+static void enumerate() {
+    ::memset(&hUsbDeviceFS, 0, sizeof(hUsbDeviceFS));
+    USBD_Init(&hUsbDeviceFS, nullptr, DEVICE_FS);
+    USBD_RegisterClass(&hUsbDeviceFS, &USBD_CDC);
+    USBD_CDC_RegisterInterface(&hUsbDeviceFS, &USBD_Interface_fops_FS);
+    USBD_Start(&hUsbDeviceFS);
+    USBD_LL_SetSpeed(&hUsbDeviceFS, USBD_SPEED_FULL);
+    USBD_LL_Reset(&hUsbDeviceFS);
+    uint8_t set_address[8] = {0x00, 0x05, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00};
+    USBD_LL_SetupStage(&hUsbDeviceFS, set_address);
+    uint8_t set_configuration[8] = {0x00, 0x09, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00};
+    USBD_LL_SetupStage(&hUsbDeviceFS, set_configuration);
+}
+
+/// xorshift
+static uint32_t next(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static Result simulate(const Run& run, double duration) {
+    ep = {};
+    ep.double_buffered = run.double_buffered;
+    interrupts.clear();
+    result = {};
+
+    drivers::CDC cdc({.husbd=hUsbDeviceFS});
+    if (run.path == Path::Ring) {
+        cdc.init();
+    }
+    enumerate();
+    if (hUsbDeviceFS.dev_state != USBD_STATE_CONFIGURED) {
+        std::printf("%s: the device did not get configured\n", run.name);
+        std::exit(1);
+    }
+
+    std::vector<uint8_t> accepted;  ///< every byte the firmware took, in order
+    size_t checked = 0;
+    uint8_t lines[2][line_size];    ///< the single-shot path needs the line until it is sent
+    int line = 0;
+    bool pending = false;           ///< the spinning task holds a line
+    double pending_since = 0;
+    uint32_t seq = 0, random = 0x2545F491;
+
+    auto make_line = [&](uint8_t* buf, double now) {
+        int n = std::snprintf(reinterpret_cast<char*>(buf), line_size, "seq %08u t %10.1f us", seq++, now);
+        std::memset(buf + n, '.', line_size - 1 - n);
+        buf[line_size - 1] = '\n';
+        result.offered += line_size;
+    };
+    auto single_shot = [&](const uint8_t* buf) {
+        if (CDC_Transmit_FS(const_cast<uint8_t*>(buf), line_size) != USBD_OK) {
+            return false;
+        }
+        accepted.insert(accepted.end(), buf, buf + line_size);
+        result.accepted += line_size;
+        return true;
+    };
+
+    double next_slot = 0, next_line = 0;
+    for (;;) {
+        double next_interrupt = interrupts.empty() ? duration : interrupts.front();
+        double now = std::min({next_interrupt, next_slot, next_line});
+        if (now >= duration) {
+            break;
+        }
+
+        if (now == next_interrupt) {
+            // the PCD ISR: the packet went out, load the next one or end the transfer
+            interrupts.pop_front();
+            ep.acked++;
+            if (ep.acked == ep.packets) {
+                ep.active = false;
+                result.transfers++;
+                USBD_LL_DataInStage(&hUsbDeviceFS, CDC_IN_EP & 0x7F, const_cast<uint8_t*>(ep.data));
+            } else {
+                load();
+            }
+            // a task spinning on CDC_Transmit_FS gets through once the transfer ended
+            if (pending and single_shot(lines[line])) {
+                pending = false;
+                result.blocked += now - pending_since;
+                next_line = std::max(next_line, now);
+            }
+        } else if (now == next_slot) {
+            // an IN token from the host
+            next_slot += slot;
+            if (not ep.full[ep.read]) {
+                result.naks++;
+                continue;
+            }
+            size_t n = ep.size[ep.read];
+            for (size_t i = 0; i < n; ++i, ++checked) {
+                if (checked >= accepted.size() or accepted[checked] != ep.memory[ep.read][i]) {
+                    result.errors++;
+                }
+            }
+            ep.full[ep.read] = false;
+            ep.read = (ep.read + 1) % (ep.double_buffered ? 2 : 1);
+            result.delivered += n;
+            result.packets++;
+            result.short_packets += n < packet_size;
+
+            double latency = 6;
+            if (run.busy_cpu and next(random) % 4 == 0) {
+                latency += next(random) % 150;
+            }
+            // one interrupt line, served in order
+            double served = now + slot + latency;
+            interrupts.push_back(interrupts.empty() ? served : std::max(served, interrupts.back()));
+        } else {
+            // the telemetry task
+            next_line += line_period;
+            if (pending) {
+                continue;
+            }
+            if (run.path == Path::Ring) {
+                uint8_t buf[line_size];
+                make_line(buf, now);
+                size_t n = cdc.write(buf, line_size);
+                accepted.insert(accepted.end(), buf, buf + n);
+                result.accepted += n;
+                continue;
+            }
+            // the other buffer may still be on its way out
+            line ^= 1;
+            make_line(lines[line], now);
+            if (not single_shot(lines[line])) {
+                if (run.path == Path::Spin) {
+                    pending = true;
+                    pending_since = now;
+                } else {
+                    line ^= 1;
+                }
+            }
+        }
+    }
+    if (run.path == Path::Ring and cdc.tx_dropped() != result.offered - result.accepted) {
+        result.errors++;
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    double duration = (argc > 1 ? std::atof(argv[1]) : 1000) * 1000;
+
+    // the single-shot runs go first, drivers::CDC keeps the instance it was initialised as
+    const Run runs[] = {
+        {"CDC_Transmit_FS, drop", Path::Drop, true, false},
+        {"CDC_Transmit_FS, drop", Path::Drop, true, true},
+        {"CDC_Transmit_FS, spin", Path::Spin, true, false},
+        {"CDC_Transmit_FS, spin", Path::Spin, true, true},
+        {"drivers::CDC", Path::Ring, false, false},
+        {"drivers::CDC", Path::Ring, false, true},
+        {"drivers::CDC", Path::Ring, true, false},
+        {"drivers::CDC", Path::Ring, true, true},
+    };
+
+    double capacity = duration / 1000 * 19 * packet_size;
+    std::printf("%.0f ms, %zu-byte lines offered every %.0f us (%.0f KB/s), bus capacity %.0f KB/s\n\n",
+        duration / 1000, line_size, line_period, line_size / line_period * 1000, capacity / duration * 1000);
+    std::printf("%-22s %-7s %-5s %8s %5s %9s %8s %6s %8s %8s %8s %6s\n",
+        "path", "ep 0x81", "cpu", "KB/s", "bus", "transfers", "packets", "short", "NAKs", "dropped", "blocked", "errors");
+
+    uint64_t errors = 0;
+    for (auto& run : runs) {
+        auto r = simulate(run, duration);
+        errors += r.errors;
+        std::printf("%-22s %-7s %-5s %8.1f %4.0f%% %9llu %8llu %6llu %8llu %7.1f%% %7.1f%% %6llu\n",
+            run.name, run.double_buffered ? "double" : "single", run.busy_cpu ? "busy" : "quiet",
+            r.delivered / duration * 1000, 100 * r.delivered / capacity,
+            (unsigned long long) r.transfers, (unsigned long long) r.packets, (unsigned long long) r.short_packets,
+            (unsigned long long) r.naks, 100.0 * (r.offered - r.accepted) / r.offered, 100 * r.blocked / duration,
+            (unsigned long long) r.errors);
+    }
+    return errors == 0 ? 0 : 1;
+}
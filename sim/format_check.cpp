@@ -0,0 +1,123 @@
+// fmt::format against the host's snprintf, for the conversions both have: integers of every
+// width at their edges, hex, chars, strings cut by a precision, fixed point, widths and the
+// - and 0 flags, and a line cut off by a small buffer. The format strings carry the length
+// modifiers printf needs, fmt takes the width from the argument type. Values of %f stay clear
+// of ties, which fmt rounds half up and printf to even. Last, format strings fmt has to refuse
+// at compile time are run through its constexpr parser: widths past max_width and precisions
+// past 255, whose digits used to wrap around the uint8_t they are kept in.
+//
+//   format_check
+
+#include "utils/format.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+using namespace Project::utils;
+
+static int cases = 0;
+static int failures = 0;
+
+template <typename Format, typename... Args>
+static void compare(Format format, const char* spec, const Args&... args) {
+    char expected[320], res[320];
+    std::snprintf(expected, sizeof(expected), spec, args...);
+    fmt::format(res, format, args...);
+    cases++;
+    if (std::strcmp(expected, res) != 0) {
+        std::printf("\"%s\": printf \"%s\", fmt \"%s\"\n", spec, expected, res);
+        failures++;
+    }
+}
+
+#define CHECK(spec, ...) compare(FMT(spec), spec, __VA_ARGS__)
+
+#define INTS(spec) \
+    CHECK(spec, 0); CHECK(spec, 1); CHECK(spec, -1); CHECK(spec, 42); CHECK(spec, -42); \
+    CHECK(spec, INT32_MIN); CHECK(spec, INT32_MAX)
+
+#define UNSIGNED(spec) \
+    CHECK(spec, 0u); CHECK(spec, 1u); CHECK(spec, 0xABCDu); CHECK(spec, UINT32_MAX)
+
+#define FIXED(spec) \
+    CHECK(spec, 0.0); CHECK(spec, 3.14159265); CHECK(spec, -2.718281828); CHECK(spec, 123456.789012); \
+    CHECK(spec, -0.000123456); CHECK(spec, 1e-7); CHECK(spec, 4294967296.3)
+
+static void check_integers() {
+    INTS("%d"); INTS("%i"); INTS("%5d"); INTS("%-5d"); INTS("%05d"); INTS("%1d");
+    INTS("%32d"); INTS("%-32d"); INTS("%032d"); INTS("[%3d]");
+    UNSIGNED("%u"); UNSIGNED("%x"); UNSIGNED("%X"); UNSIGNED("%08x"); UNSIGNED("%-8X|"); UNSIGNED("%12u");
+
+    CHECK("%hhd %hhd %hhu", int8_t(INT8_MIN), int8_t(INT8_MAX), uint8_t(UINT8_MAX));
+    CHECK("%hd %hd %hu %hx", int16_t(INT16_MIN), int16_t(INT16_MAX), uint16_t(UINT16_MAX), uint16_t(0xBEEF));
+    CHECK("%ld %lu %lx", long(INT32_MIN), 3000000000ul, 0xDEADBEEFul);
+    CHECK("%lld %lld %llu", (long long) INT64_MIN, (long long) INT64_MAX, (unsigned long long) UINT64_MAX);
+    CHECK("%llx %llX %020llu", (unsigned long long) UINT64_MAX, 0x123456789ABCDEFull, 4294967296ull);
+    CHECK("%-24lld|%024lld", (long long) INT64_MIN, (long long) INT64_MIN);
+}
+
+static void check_text() {
+    static char long_text[300];
+    std::memset(long_text, 'a', sizeof(long_text) - 1);
+    for (const char* str : {"", "a", "hello", "bluepill-01", static_cast<const char*>(long_text)}) {
+        CHECK("%s", str); CHECK("%10s", str); CHECK("%-10s|", str); CHECK("%.3s", str); CHECK("%.0s|", str);
+        CHECK("%10.3s", str); CHECK("%-10.3s|", str); CHECK("%32.25s", str); CHECK("%.255s", str);
+    }
+    for (char ch : {'a', 'Z', ' ', '%'}) {
+        CHECK("%c", ch); CHECK("%5c", ch); CHECK("%-5c|", ch); CHECK("[%c%c]", ch, ch);
+    }
+    CHECK("100%% %s%%", "done");
+}
+
+static void check_fixed() {
+    FIXED("%f"); FIXED("%.0f"); FIXED("%.1f"); FIXED("%.3f"); FIXED("%.9f");
+    FIXED("%12.2f"); FIXED("%-12.2f|"); FIXED("%012.2f"); FIXED("%32.4f");
+}
+
+// the lines of the apps, and a line cut off by buffers of every size up to its length
+static void check_lines() {
+    CHECK("h: %lu/%lu t: %lu\n", 1412ul, 3072ul, 5ul);
+    CHECK("id %08lx len %-5lu|", 0x1A2Bul, 812ul);
+    CHECK("Restart in %u s\n", 5u);
+
+    const char line[] = "t: %3d.%02u %s";
+    for (size_t size = 0; size <= sizeof(line) + 8; ++size) {
+        char expected[64] = "unchanged", res[64] = "unchanged";
+        std::snprintf(expected, size, line, -7, 5u, "ok");
+        fmt::format(res, size, FMT("t: %3d.%02u %s"), -7, 5u, "ok");
+        cases++;
+        if (std::strcmp(expected, res) != 0) {
+            std::printf("\"%s\" in %zu bytes: printf \"%s\", fmt \"%s\"\n", line, size, expected, res);
+            failures++;
+        }
+    }
+}
+
+static void check_refused() {
+    struct Case {
+        const char* spec;
+        bool ok;
+    };
+    const Case specs[] = {
+        {"%32d", true}, {"%33d", false}, {"%260d", false}, {"%0260d", false}, {"%4294967300d", false},
+        {"%.255s", true}, {"%.256s", false}, {"%.259s", false}, {"%32.259s", false}, {"%.4294967299s", false},
+        {"%.9f", true}, {"%.10f", false}, {"%.265f", false}, {"%.3d", false}, {"%q", false}, {"%5", false},
+    };
+    for (auto& c : specs) {
+        cases++;
+        if (fmt::count(c.spec).ok != c.ok) {
+            std::printf("\"%s\" is %s, expected %s\n", c.spec, c.ok ? "refused" : "taken", c.ok ? "taken" : "refused");
+            failures++;
+        }
+    }
+}
+
+int main() {
+    check_integers();
+    check_text();
+    check_fixed();
+    check_lines();
+    check_refused();
+    std::printf("%d cases, %d differ from printf\n", cases, failures);
+    return failures ? 1 : 0;
+}
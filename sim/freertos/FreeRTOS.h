@@ -0,0 +1,23 @@
+#ifndef PROJECT_SIM_FREERTOS_H
+#define PROJECT_SIM_FREERTOS_H
+
+// Host stand-in for the FreeRTOS types and macros used by firmware code that is built into
+// the simulator. A tick is a millisecond.
+
+#include <cstddef>
+#include <cstdint>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t StackType_t;
+
+#define configTICK_RATE_HZ 1000
+#define pdMS_TO_TICKS(ms) ((TickType_t) (ms))
+#define portMAX_DELAY ((TickType_t) 0xFFFFFFFF)
+#define pdFALSE 0
+#define pdTRUE 1
+#define tskIDLE_PRIORITY 0
+#define portYIELD_FROM_ISR(woken) ((void) (woken))
+
+#endif // PROJECT_SIM_FREERTOS_H
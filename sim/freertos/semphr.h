@@ -0,0 +1,55 @@
+#ifndef PROJECT_SIM_SEMPHR_H
+#define PROJECT_SIM_SEMPHR_H
+
+// Host stand-in for binary semaphores and mutexes, both a flag behind a condition variable.
+// A give from an interrupt is a give from the thread that plays the interrupt.
+
+#include "FreeRTOS.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+typedef struct {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool given;
+} StaticSemaphore_t;
+
+typedef StaticSemaphore_t* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* buffer) {
+    buffer->given = false;
+    return buffer;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* buffer) {
+    buffer->given = true;
+    return buffer;
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(sem->mutex);
+    if (not sem->cv.wait_for(lock, std::chrono::milliseconds(ticks), [sem] { return sem->given; })) {
+        return pdFALSE;
+    }
+    sem->given = false;
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    {
+        std::lock_guard<std::mutex> lock(sem->mutex);
+        sem->given = true;
+    }
+    sem->cv.notify_one();
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* woken) {
+    if (woken) {
+        *woken = pdFALSE;
+    }
+    return xSemaphoreGive(sem);
+}
+
+#endif // PROJECT_SIM_SEMPHR_H
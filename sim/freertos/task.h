@@ -0,0 +1,64 @@
+#ifndef PROJECT_SIM_TASK_H
+#define PROJECT_SIM_TASK_H
+
+// Host stand-in for the task API. There is no scheduler: no task is ever created, a host
+// thread calls the step function of the code under test instead, and a notification wait
+// just sleeps. A critical section locks one recursive mutex, which is what masking the
+// interrupts amounts to between the threads of a simulation.
+
+#include "FreeRTOS.h"
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+typedef struct { void* unused; } StaticTask_t;
+
+#define taskSCHEDULER_RUNNING 2
+
+inline BaseType_t xTaskGetSchedulerState() {
+    return taskSCHEDULER_RUNNING;
+}
+
+inline std::recursive_mutex& critical_section() {
+    static std::recursive_mutex mutex;
+    return mutex;
+}
+
+inline void taskENTER_CRITICAL() {
+    critical_section().lock();
+}
+
+inline void taskEXIT_CRITICAL() {
+    critical_section().unlock();
+}
+
+inline UBaseType_t taskENTER_CRITICAL_FROM_ISR() {
+    critical_section().lock();
+    return 0;
+}
+
+inline void taskEXIT_CRITICAL_FROM_ISR(UBaseType_t) {
+    critical_section().unlock();
+}
+
+inline TickType_t xTaskGetTickCount() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return TickType_t(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+}
+
+inline TaskHandle_t xTaskCreateStatic(TaskFunction_t, const char*, uint32_t, void*, UBaseType_t, StackType_t*, StaticTask_t*) {
+    return nullptr;
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return nullptr;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+    return 0;
+}
+
+#endif // PROJECT_SIM_TASK_H
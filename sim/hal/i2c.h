@@ -0,0 +1,63 @@
+#ifndef PROJECT_SIM_I2C_H
+#define PROJECT_SIM_I2C_H
+
+// Host stand-in for the parts of the STM32 HAL and the Cortex-M3 core that the I2C display
+// driver uses, next to the DMA handles and register macros of spi.h. The registers are plain
+// memory and the flags are read through sim_i2c_flag, which the simulation defines: it plays
+// the bus, taking the byte the driver left in DR when the driver waits for the next flag.
+
+#include "spi.h"
+
+typedef struct {
+    volatile uint32_t CR1;
+    volatile uint32_t CR2;
+    volatile uint32_t DR;
+    volatile uint32_t SR1;
+    volatile uint32_t SR2;
+} I2C_TypeDef;
+
+typedef struct {
+    I2C_TypeDef* Instance;
+    DMA_HandleTypeDef* hdmatx;
+} I2C_HandleTypeDef;
+
+typedef struct {
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+inline CoreDebug_Type sim_core_debug;
+inline DWT_Type sim_dwt;
+
+#define CoreDebug (&sim_core_debug)
+#define DWT (&sim_dwt)
+#define CoreDebug_DEMCR_TRCENA_Msk (1U << 24)
+#define DWT_CTRL_CYCCNTENA_Msk (1U << 0)
+
+#define I2C_CR1_PE (1U << 0)
+#define I2C_CR1_START (1U << 8)
+#define I2C_CR1_STOP (1U << 9)
+#define I2C_CR2_DMAEN (1U << 11)
+#define I2C_FLAG_SB (1U << 0)
+#define I2C_FLAG_ADDR (1U << 1)
+#define I2C_FLAG_BTF (1U << 2)
+#define I2C_FLAG_TXE (1U << 7)
+#define I2C_FLAG_AF (1U << 10)
+
+#define __HAL_I2C_ENABLE(h) SET_BIT((h)->Instance->CR1, I2C_CR1_PE)
+#define __HAL_I2C_GET_FLAG(h, flag) sim_i2c_flag(h, flag)
+#define __HAL_I2C_CLEAR_FLAG(h, flag) CLEAR_BIT((h)->Instance->SR1, flag)
+#define __HAL_I2C_CLEAR_ADDRFLAG(h) ((void) (h)->Instance->SR2)
+
+bool sim_i2c_flag(I2C_HandleTypeDef* hi2c, uint32_t flag);
+
+/// interrupts are never masked on the host
+inline uint32_t __get_PRIMASK() {
+    return 0;
+}
+
+#endif // PROJECT_SIM_I2C_H
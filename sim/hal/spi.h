@@ -0,0 +1,80 @@
+#ifndef PROJECT_SIM_SPI_H
+#define PROJECT_SIM_SPI_H
+
+// Host stand-in for the parts of the STM32 HAL that the SPI drivers use. The SPI, DMA and
+// GPIO registers are plain memory and the HAL calls are defined by the simulation, which
+// plays the peripherals behind them.
+
+#include <cstdint>
+
+typedef struct {
+    volatile uint32_t CR1;
+    volatile uint32_t CR2;
+    volatile uint32_t SR;
+    volatile uint32_t DR;
+} SPI_TypeDef;
+
+typedef struct {
+    volatile uint32_t CCR;
+    volatile uint32_t CNDTR;
+    volatile uint32_t CPAR;
+    volatile uint32_t CMAR;
+} DMA_Channel_TypeDef;
+
+typedef struct {
+    volatile uint32_t ISR;
+    volatile uint32_t IFCR;
+} DMA_TypeDef;
+
+typedef struct {
+    volatile uint32_t ODR;
+} GPIO_TypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+    DMA_Channel_TypeDef* Instance;
+    DMA_TypeDef* DmaBaseAddress;
+    uint32_t ChannelIndex;
+    void (*XferCpltCallback)(struct __DMA_HandleTypeDef* hdma);
+    void (*XferHalfCpltCallback)(struct __DMA_HandleTypeDef* hdma);
+    void (*XferErrorCallback)(struct __DMA_HandleTypeDef* hdma);
+    void (*XferAbortCallback)(struct __DMA_HandleTypeDef* hdma);
+} DMA_HandleTypeDef;
+
+typedef struct {
+    SPI_TypeDef* Instance;
+    DMA_HandleTypeDef* hdmatx;
+    DMA_HandleTypeDef* hdmarx;
+} SPI_HandleTypeDef;
+
+typedef enum { HAL_OK, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT } HAL_StatusTypeDef;
+typedef enum { GPIO_PIN_RESET, GPIO_PIN_SET } GPIO_PinState;
+
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+
+#define DMA_CCR_EN (1U << 0)
+#define DMA_CCR_TCIE (1U << 1)
+#define DMA_CCR_HTIE (1U << 2)
+#define DMA_CCR_TEIE (1U << 3)
+#define DMA_CCR_MINC (1U << 7)
+#define DMA_ISR_GIF1 (1U << 0)
+
+#define SPI_CR1_SPE (1U << 6)
+#define SPI_CR2_RXDMAEN (1U << 0)
+#define SPI_CR2_TXDMAEN (1U << 1)
+#define SPI_FLAG_OVR (1U << 6)
+#define SPI_FLAG_BSY (1U << 7)
+
+#define SET_BIT(REG, BIT) ((REG) |= (BIT))
+#define CLEAR_BIT(REG, BIT) ((REG) &= ~(BIT))
+#define MODIFY_REG(REG, CLEARMASK, SETMASK) ((REG) = (((REG) & (~(CLEARMASK))) | (SETMASK)))
+
+#define __HAL_SPI_ENABLE(h) SET_BIT((h)->Instance->CR1, SPI_CR1_SPE)
+#define __HAL_SPI_CLEAR_OVRFLAG(h) CLEAR_BIT((h)->Instance->SR, SPI_FLAG_OVR)
+#define __HAL_SPI_GET_FLAG(h, flag) (((h)->Instance->SR & (flag)) == (flag))
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef* hspi, uint8_t* data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef* hspi, uint8_t* data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef* hspi, uint8_t* tx, uint8_t* rx, uint16_t size, uint32_t timeout);
+void HAL_GPIO_WritePin(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state);
+
+#endif // PROJECT_SIM_SPI_H
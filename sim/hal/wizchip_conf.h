@@ -0,0 +1,16 @@
+#ifndef PROJECT_SIM_WIZCHIP_CONF_H
+#define PROJECT_SIM_WIZCHIP_CONF_H
+
+// Host stand-in for the callback registration of the wizchip io library, for targets that
+// drive a bus layer without the io library; the simulation defines these.
+
+#include <cstdint>
+
+extern "C" {
+    void reg_wizchip_cris_cbfunc(void (*enter)(void), void (*exit)(void));
+    void reg_wizchip_cs_cbfunc(void (*select)(void), void (*deselect)(void));
+    void reg_wizchip_spi_cbfunc(uint8_t (*read_byte)(void), void (*write_byte)(uint8_t byte));
+    void reg_wizchip_spiburst_cbfunc(void (*read_burst)(uint8_t* buf, uint16_t len), void (*write_burst)(uint8_t* buf, uint16_t len));
+}
+
+#endif // PROJECT_SIM_WIZCHIP_CONF_H
@@ -0,0 +1,306 @@
+// The allocation-free HTTP server served through the W5500 model, with keep-alive HTTP
+// clients on the host side. The firmware side is net/http/server.cpp itself with the /foo,
+// /headers and /queries handlers of the http_lite app from apps/http_lite_handlers.cpp,
+// stepped by a host thread.
+//
+// malloc and operator new are counted on that thread, so the summary shows the heap the
+// server took while answering, which should be none, next to the receive buffer and arena
+// high-water marks the server keeps itself.
+//
+// The server listens on 1 to 8 sockets. A client may think between its requests and keeps its
+// connection meanwhile, the way a slow client holds a socket that the other clients then wait
+// for; run with more clients than sockets and some think time for the scaling curve.
+//
+//   http_lite [sockets] [clients] [requests per client] [think time us]
+//
+// Requests/s with 8 clients of 500 requests each, on the sockets of the first row:
+//   sockets       1      2      3      4      5      6      7      8
+//   think 0   22801  25475  28585  24292  25063  22219  19462  20188
+//   think 1ms   902   1776   2513   3478   4282   5014   5607   6578
+// Without think time the server task is the bottleneck and more sockets don't help; with it the
+// throughput grows with the sockets, each one holding a client that is thinking.
+
+#include "wizchip_port.hpp"
+#include "apps/http_lite_handlers.hpp"
+#include "net/interrupt.hpp"
+#include "net/http/server.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <new>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace Project;
+using namespace Project::net::http;
+
+static constexpr uint16_t port = 5001;
+static constexpr uint16_t port_offset = 10000;
+static constexpr uint8_t max_sockets = 8;
+static constexpr uint8_t first_socket = 0;
+
+static sim::W5500 chip({.port_offset=port_offset});
+static std::atomic<bool> running{true};
+
+// heap use of the firmware thread
+static thread_local bool counted = false;
+static size_t allocations = 0;
+static size_t heap_in_use = 0;
+static size_t heap_high_water = 0;
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t n, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+static void* track(void* ptr) {
+    if (counted and ptr) {
+        allocations++;
+        heap_in_use += ::malloc_usable_size(ptr);
+        heap_high_water = std::max(heap_high_water, heap_in_use);
+    }
+    return ptr;
+}
+
+static void untrack(void* ptr) {
+    if (counted and ptr) {
+        heap_in_use -= std::min(heap_in_use, ::malloc_usable_size(ptr));
+    }
+}
+
+extern "C" void* malloc(size_t size) {
+    return track(__libc_malloc(size));
+}
+
+extern "C" void* calloc(size_t n, size_t size) {
+    return track(__libc_calloc(n, size));
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    untrack(ptr);
+    return track(__libc_realloc(ptr, size));
+}
+
+extern "C" void free(void* ptr) {
+    untrack(ptr);
+    __libc_free(ptr);
+}
+
+void* operator new(size_t size) {
+    if (auto ptr = ::malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    ::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    ::free(ptr);
+}
+
+// the handlers of the http_lite app, the board-specific routes of apps/http_lite.cpp left out
+static constexpr RouteTable routes({
+    {"POST", "/foo", apps::http_lite::foo},
+    {"GET", "/headers", apps::http_lite::headers},
+    {"GET", "/queries", apps::http_lite::queries},
+});
+
+static Server::Connection connections[max_sockets];
+static size_t n_sockets = 2;
+
+static Server server({
+    .port=port,
+    .socket=first_socket,
+    .connections=connections,
+    .n_connections=max_sockets,
+    .routes=routes,
+});
+
+// the model has no INT pin, the server is stepped by its host thread anyway
+bool Project::net::notify_on_interrupt(TaskHandle_t, uint8_t) {
+    return false;
+}
+
+// init() would start the task of the server, this thread steps the connections instead
+static void firmware() {
+    for (uint8_t i = 0; i < n_sockets; ++i) {
+        connections[i] = {};
+        connections[i].sn = first_socket + i;
+    }
+    // the sockets open and listen first, the model opens its host listener meanwhile
+    for (int i = 0; i < 2; ++i) {
+        for (size_t sn = 0; sn < n_sockets; ++sn) {
+            server.poll(connections[sn]);
+        }
+    }
+    counted = true;
+    while (running) {
+        bool busy = false;
+        for (size_t sn = 0; sn < n_sockets; ++sn) {
+            busy |= server.poll(connections[sn]);
+        }
+        if (not busy) {
+            std::this_thread::yield();
+        }
+    }
+    counted = false;
+}
+
+struct Expected {
+    std::string request;
+    std::string body;
+};
+
+/// the three routes in turn, with the responses they must give
+static std::vector<Expected> requests() {
+    std::string foo = R"({"num":22,"text":"hello"})";
+    return {
+        {"POST /foo?add=3 HTTP/1.1\r\nHost: sim\r\nAuthentication: Bearer 1234\r\nContent-Type: application/json\r\n"
+         "Content-Length: " + std::to_string(foo.size()) + "\r\n\r\n" + foo,
+         R"({"num":25,"text":"hello: Bearer 1234"})"},
+        {"GET /headers HTTP/1.1\r\nHost: sim\r\nX-Trace: 42\r\n\r\n",
+         R"({"Host":"sim","X-Trace":"42"})"},
+        {"GET /queries?a=1&b=two%20words HTTP/1.1\r\nHost: sim\r\n\r\n",
+         R"({"a":"1","b":"two words"})"},
+    };
+}
+
+/// @return status and body of one response, status 0 if the connection broke
+static int response(int fd, std::string& buffer, std::string& body, bool& close) {
+    size_t end;
+    while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+        char chunk[1024];
+        auto n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            return 0;
+        }
+        buffer.append(chunk, n);
+    }
+    int status = std::atoi(buffer.c_str() + 9);
+    auto length_at = buffer.find("Content-Length: ");
+    size_t length = length_at < end ? std::strtoul(buffer.c_str() + length_at + 16, nullptr, 10) : 0;
+    while (buffer.size() < end + 4 + length) {
+        char chunk[1024];
+        auto n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            return 0;
+        }
+        buffer.append(chunk, n);
+    }
+    close = buffer.find("Connection: close") < end;
+    body = buffer.substr(end + 4, length);
+    buffer.erase(0, end + 4 + length);
+    return status;
+}
+
+static void client(int count, int think_us, std::vector<double>& latencies, int& errors) {
+    auto expected = requests();
+    int fd = -1;
+    std::string buffer, body;
+    for (int i = 0; i < count; ++i) {
+        if (fd < 0) {
+            fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = ::inet_addr("127.0.0.1");
+            addr.sin_port = htons(port + port_offset);
+            while (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            buffer.clear();
+        }
+
+        auto& e = expected[i % expected.size()];
+        auto start = std::chrono::steady_clock::now();
+        ::send(fd, e.request.data(), e.request.size(), 0);
+        bool close = false;
+        int status = response(fd, buffer, body, close);
+        if (status == 0) {
+            ++errors;
+            ::close(fd);
+            fd = -1;
+            continue;
+        }
+        if (status != 200 or body != e.body) {
+            ++errors;
+        }
+        latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        // the server closes a connection after max_requests, the client reconnects like a browser
+        if (close) {
+            ::close(fd);
+            fd = -1;
+        }
+        if (think_us > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(think_us));
+        }
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+int main(int argc, char** argv) {
+    n_sockets = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : n_sockets;
+    int clients = argc > 2 ? std::atoi(argv[2]) : int(n_sockets);
+    int count = argc > 3 ? std::atoi(argv[3]) : 3000;
+    int think_us = argc > 4 ? std::atoi(argv[4]) : 0;
+    if (n_sockets < 1 or n_sockets > max_sockets) {
+        std::printf("1 to %u sockets\n", unsigned(max_sockets));
+        return 1;
+    }
+
+    sim::attach(chip);
+    std::thread firmware_thread(firmware);
+    std::vector<std::vector<double>> results(clients);
+    std::vector<int> errors(clients);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < clients; ++i) {
+        threads.emplace_back(client, count, think_us, std::ref(results[i]), std::ref(errors[i]));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    running = false;
+    firmware_thread.join();
+
+    std::vector<double> all;
+    for (auto& r : results) {
+        all.insert(all.end(), r.begin(), r.end());
+    }
+    if (all.empty()) {
+        std::printf("no request completed\n");
+        return 1;
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&](double p) { return all[std::min(all.size() - 1, size_t(p * all.size()))]; };
+    int bad = 0;
+    for (int e : errors) {
+        bad += e;
+    }
+
+    auto& stats = server.stats();
+    std::printf("%zu requests from %d clients on %zu sockets in %.2f s, %d bad responses\n", all.size(), clients, n_sockets, seconds, bad);
+    std::printf("throughput  %.0f requests/s\n", all.size() / seconds);
+    std::printf("latency us  p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n", percentile(0.5), percentile(0.9), percentile(0.99), all.back());
+    std::printf("heap        %zu allocations, %zu bytes high-water\n", allocations, heap_high_water);
+    std::printf("server      %u requests, %u errors, rx high-water %zu of %zu, arena high-water %zu\n",
+        unsigned(stats.requests), unsigned(stats.errors), stats.rx_high_water, Server::rx_buffer_size, stats.arena_high_water);
+    return bad == 0 and allocations == 0 ? 0 : 1;
+}
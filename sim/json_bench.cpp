@@ -0,0 +1,385 @@
+// Throughput and heap use of the schema-driven json Writer and Parser against the
+// std::string way of building and reading documents, which is what etl::json does with
+// JSON_DEFINE types: the result of serialize is a string, string members are std::string.
+// The cbor encoding of the same struct is measured last, MB/s are of the json document.
+// Before anything is timed, the values the Parser fills in are checked: escapes, numbers at the
+// edges of their members, nested objects and arrays, skipped members, and the same document
+// fed in pieces of every size. What cbor::Reader decodes is checked the same way, and so are the
+// items a cbor::Frames stream hands out around junk and a truncated item.
+//
+//   json_bench [iterations]
+
+#include "utils/json.hpp"
+#include "utils/cbor.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+using namespace Project::utils;
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* ptr = std::malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+struct Channel {
+    int id;
+    int value;
+    bool valid;
+};
+
+struct Report {
+    std::string_view device;
+    uint32_t uptime;
+    Channel channels[4];
+};
+
+JSON_SCHEMA(Channel, JSON_MEMBER("id", id), JSON_MEMBER("value", value), JSON_MEMBER("valid", valid));
+JSON_SCHEMA(Report, JSON_MEMBER("device", device), JSON_MEMBER("uptime", uptime), JSON_MEMBER("channels", channels));
+
+// the same document held the way the allocating serializer wants it
+struct OwnedReport {
+    std::string device;
+    uint32_t uptime;
+    Channel channels[4];
+};
+
+static std::string serialize(const OwnedReport& report) {
+    std::string res = "{\"device\":\"" + report.device + "\",\"uptime\":" + std::to_string(report.uptime) + ",\"channels\":[";
+    for (size_t i = 0; i < 4; ++i) {
+        auto& ch = report.channels[i];
+        res += std::string(i ? "," : "") + "{\"id\":" + std::to_string(ch.id) + ",\"value\":" + std::to_string(ch.value) +
+            ",\"valid\":" + (ch.valid ? "true" : "false") + "}";
+    }
+    return res + "]}";
+}
+
+static bool deserialize(std::string_view text, OwnedReport& report) {
+    int uptime;
+    if (not json::to_int(json::find(text, "uptime"), uptime)) {
+        return false;
+    }
+    report.uptime = uptime;
+    auto device = json::find(text, "device");
+    report.device = std::string(device.substr(1, device.size() - 2));
+    auto channels = std::string(json::find(text, "channels"));
+    for (size_t i = 0, pos = 1; i < 4; ++i) {
+        auto len = json::value_length(std::string_view(channels).substr(pos));
+        auto object = channels.substr(pos, len);
+        json::to_int(json::find(object, "id"), report.channels[i].id);
+        json::to_int(json::find(object, "value"), report.channels[i].value);
+        json::to_bool(json::find(object, "valid"), report.channels[i].valid);
+        pos += len + 1;
+    }
+    return true;
+}
+
+// a sink that keeps nothing, like a socket that is always ready
+struct Counter {
+    size_t bytes = 0;
+    void write(std::string_view str) { bytes += str.size(); }
+};
+
+// a sink that keeps the document, like a socket tx buffer
+struct Buffer {
+    char data[512];
+    size_t len = 0;
+    void write(std::string_view str) { len += str.copy(data + len, sizeof(data) - len); }
+};
+
+// members of every kind the Parser fills in, for the checks
+namespace {
+    struct Point {
+        int x;
+        int y;
+    };
+
+    struct Sample {
+        std::string_view text;
+        std::string_view plain;
+        int64_t big;
+        int8_t small;
+        uint32_t max;
+        double ratio;
+        bool flag;
+        Point points[2];
+        Channel channel;
+    };
+}
+
+JSON_SCHEMA(Point, JSON_MEMBER("x", x), JSON_MEMBER("y", y));
+JSON_SCHEMA(Sample, JSON_MEMBER("text", text), JSON_MEMBER("plain", plain), JSON_MEMBER("big", big),
+    JSON_MEMBER("small", small), JSON_MEMBER("max", max), JSON_MEMBER("ratio", ratio), JSON_MEMBER("flag", flag),
+    JSON_MEMBER("points", points), JSON_MEMBER("channel", channel));
+
+static const char sample[] = R"( {"text": "a\"b\\c\/d\n\t\u0041\u00e9\u20ac",
+    "skipped": {"a": [1, {"b": "}"}], "c": "\"]", "d": -0.5e+3},
+    "plain" : "no escapes", "big": -9223372036854775807, "small": -128, "max": 4294967295,
+    "ratio": -1.5e-3, "flag": true, "points": [{"x": 1, "y": -2}, {"y": 4, "x": 3}],
+    "channel": {"id": 7, "value": -35, "valid": false}} )";
+
+static int failures = 0;
+
+static bool same(const Report& a, const Report& b) {
+    bool res = a.device == b.device and a.uptime == b.uptime;
+    for (size_t i = 0; i < 4; ++i) {
+        res = res and a.channels[i].id == b.channels[i].id and a.channels[i].value == b.channels[i].value and
+            a.channels[i].valid == b.channels[i].valid;
+    }
+    return res;
+}
+
+static void check(bool ok, const char* what) {
+    if (not ok) {
+        std::printf("check failed: %s\n", what);
+        failures++;
+    }
+}
+
+static void check_sample(const Sample& res, const char* how) {
+    char what[96];
+    auto expect = [&](bool ok, const char* member) {
+        std::snprintf(what, sizeof(what), "%s, %s", member, how);
+        check(ok, what);
+    };
+    expect(res.text == "a\"b\\c/d\n\tA\xC3\xA9\xE2\x82\xAC", "escapes");
+    expect(res.plain == "no escapes", "string without escapes");
+    expect(res.big == -9223372036854775807, "int64");
+    expect(res.small == -128, "int8 minimum");
+    expect(res.max == 4294967295u, "uint32 maximum");
+    expect(std::fabs(res.ratio + 1.5e-3) < 1e-12, "double with exponent");
+    expect(res.flag, "bool");
+    expect(res.points[0].x == 1 and res.points[0].y == -2 and res.points[1].x == 3 and res.points[1].y == 4,
+        "array of objects, members in any order");
+    expect(res.channel.id == 7 and res.channel.value == -35 and not res.channel.valid, "nested object");
+}
+
+static json::Parser::Status parse(const char* text, Sample& res) {
+    char buf[512];
+    size_t len = std::strlen(text);
+    std::memcpy(buf, text, len);
+    return json::Parser(res).feed(buf, len, true);
+}
+
+static void check_parser(const Report& report) {
+    char buf[sizeof(sample)];
+    size_t len = sizeof(sample) - 1;
+
+    // strings are slices of buf, so each document is checked before buf is reused
+    std::memcpy(buf, sample, len);
+    Sample res = {};
+    check(json::Parser(res).feed(buf, len) == json::Parser::Status::Complete, "sample parses");
+    check_sample(res, "in one piece");
+
+    for (size_t piece = 1; piece < 40; ++piece) {
+        std::memcpy(buf, sample, len);
+        res = {};
+        json::Parser parser(res);
+        auto status = json::Parser::Status::Incomplete;
+        for (size_t n = piece; status == json::Parser::Status::Incomplete and n < len + piece; n += piece) {
+            status = parser.feed(buf, n < len ? n : len);
+        }
+        char how[32];
+        std::snprintf(how, sizeof(how), "in pieces of %zu", piece);
+        int before = failures;
+        check(status == json::Parser::Status::Complete and parser.size() < len, how);
+        check_sample(res, how);
+        if (failures > before) {
+            break;
+        }
+    }
+
+    // values that don't fit their member, and malformed documents
+    Sample other = {};
+    check(parse(R"({"small": 128})", other) == json::Parser::Status::Invalid, "int8 overflow is invalid");
+    check(parse(R"({"big": 9223372036854775808})", other) == json::Parser::Status::Invalid, "int64 overflow is invalid");
+    check(parse(R"({"big": -9223372036854775808})", other) == json::Parser::Status::Complete and
+        other.big == INT64_MIN, "int64 minimum");
+    check(parse(R"({"max": -1})", other) == json::Parser::Status::Invalid, "negative uint32 is invalid");
+    check(parse(R"({"flag": 1})", other) == json::Parser::Status::Invalid, "number for a bool is invalid");
+    check(parse(R"({"text": "\x"})", other) == json::Parser::Status::Invalid, "unknown escape is invalid");
+    check(parse(R"({"points": [{"x": 1}, {"x": 2}, {"x": 3}]})", other) != json::Parser::Status::Complete,
+        "array past its end is not taken");
+    check(parse(R"({"plain": "a",})", other) == json::Parser::Status::Invalid, "trailing comma is invalid");
+
+    // what the Writer writes, the Parser reads back the same
+    Buffer out;
+    json::Writer<Buffer>(out).value(report);
+    Report back = {};
+    check(json::Parser(back).feed(out.data, out.len) == json::Parser::Status::Complete, "report parses");
+    check(same(back, report), "report reads back as written");
+}
+
+static void check_reader(const Report& report) {
+    Buffer out;
+    cbor::Writer<Buffer>(out).value(report);
+    Report back = {};
+    check(cbor::Reader(out.data, out.len).read(back), "report decodes");
+    check(same(back, report), "report decodes as written");
+    back = {};
+    check(not cbor::Reader(out.data, out.len - 1).read(back), "report cut short does not decode");
+
+    // the sample as the Parser reads it, written and decoded again
+    Sample sample = {"a\"b\\c/d\n\tA\xC3\xA9\xE2\x82\xAC", "no escapes", -9223372036854775807, -128, 4294967295u,
+        -1.5e-3, true, {{1, -2}, {3, 4}}, {7, -35, false}};
+    out = {};
+    cbor::Writer<Buffer>(out).value(sample);
+    Sample res = {};
+    check(out.len < sizeof(out.data) and cbor::Reader(out.data, out.len).read(res), "sample decodes");
+    check_sample(res, "from cbor");
+
+    // values that don't fit their member
+    auto rejects = [](auto member, auto value) {
+        Buffer out;
+        cbor::Writer<Buffer>(out).begin_map(1).key(member).value(value);
+        Sample res = {};
+        return not cbor::Reader(out.data, out.len).read(res);
+    };
+    check(rejects("small", 128), "int8 overflow does not decode");
+    check(rejects("max", -1), "negative uint32 does not decode");
+    check(rejects("flag", 1), "number for a bool does not decode");
+    check(rejects("text", 1), "number for a string does not decode");
+}
+
+// junk, a frame, the first 5 bytes of a frame and another frame, in pieces of every size:
+// the frames on either side of the truncated one come out, with nothing in between
+static void check_frames(Report report) {
+    Buffer stream;
+    stream.write("\x01\xD9junk\xD9\xD9");
+    size_t junk = stream.len;
+    report.uptime = 1;
+    cbor::Writer<Buffer>(stream).self_describe().value(report);
+    size_t start = stream.len;
+    report.uptime = 2;
+    cbor::Writer<Buffer>(stream).self_describe().value(report);
+    stream.len = start + 5;
+    report.uptime = 3;
+    cbor::Writer<Buffer>(stream).self_describe().value(report);
+
+    for (size_t piece = 1; piece <= stream.len; ++piece) {
+        cbor::Frames<256> frames;
+        uint32_t uptimes[4] = {};
+        size_t n = 0;
+        bool decoded = true;
+        for (size_t at = 0; at < stream.len;) {
+            at += frames.append(stream.data + at, piece < stream.len - at ? piece : stream.len - at);
+            for (auto item = frames.next(); not item.empty(); item = frames.next()) {
+                Report back = {};
+                decoded = cbor::Reader(item).read(back) and decoded;
+                if (n < 4) {
+                    uptimes[n] = back.uptime;
+                }
+                n++;
+            }
+        }
+        char what[64];
+        std::snprintf(what, sizeof(what), "frames around a truncated one, in pieces of %zu", piece);
+        int before = failures;
+        check(decoded and n == 2 and uptimes[0] == 1 and uptimes[1] == 3 and frames.dropped() == junk + 5, what);
+        if (failures > before) {
+            std::printf("  %zu frames, uptimes %u %u, %u bytes dropped\n", n, uptimes[0], uptimes[1], frames.dropped());
+            break;
+        }
+    }
+}
+
+template <typename F>
+static void run(const char* name, int iterations, size_t bytes, F&& f) {
+    auto before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        f(i);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-28s %8.1f MB/s  %6.2f allocations per document\n",
+        name, double(bytes) * iterations / seconds / 1e6, double(allocations - before) / iterations);
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+    Report report = {"bluepill-01", 123456, {{0, 1200, true}, {1, -35, true}, {2, 0, false}, {3, 65535, true}}};
+    OwnedReport owned = {"bluepill-01", 123456, {{0, 1200, true}, {1, -35, true}, {2, 0, false}, {3, 65535, true}}};
+
+    check_parser(report);
+    check_reader(report);
+    check_frames(report);
+    if (failures) {
+        return 1;
+    }
+
+    Counter counter;
+    json::Writer<Counter>(counter).value(report);
+    auto text = serialize(owned);
+    if (counter.bytes != text.size()) {
+        std::printf("documents differ: %zu and %zu bytes\n", counter.bytes, text.size());
+        return 1;
+    }
+
+    volatile size_t sink = 0;
+    run("serialize std::string", iterations, text.size(), [&](int i) {
+        owned.uptime = i;
+        sink = sink + serialize(owned).size();
+    });
+    run("serialize json::Writer", iterations, text.size(), [&](int i) {
+        report.uptime = i;
+        Buffer out;
+        json::Writer<Buffer>(out).value(report);
+        sink = sink + out.data[out.len - 1];
+    });
+
+    run("parse std::string", iterations, text.size(), [&](int) {
+        OwnedReport res;
+        sink = sink + deserialize(text, res);
+    });
+
+    // the parser unescapes in place, so every round works on a fresh copy of the input
+    char buf[256];
+    run("parse json::Parser", iterations, text.size(), [&](int) {
+        text.copy(buf, text.size());
+        Report res = {};
+        json::Parser parser(res);
+        sink = sink + (parser.feed(buf, text.size()) == json::Parser::Status::Complete);
+    });
+
+    // the same document arriving in 16 byte pieces, as from a UART
+    run("parse json::Parser, chunked", iterations, text.size(), [&](int) {
+        text.copy(buf, text.size());
+        Report res = {};
+        json::Parser parser(res);
+        for (size_t len = 16; parser.feed(buf, len < text.size() ? len : text.size()) == json::Parser::Status::Incomplete; len += 16) {}
+        sink = sink + parser.size();
+    });
+
+    Counter cbor_size;
+    cbor::Writer<Counter>(cbor_size).value(report);
+    std::printf("%zu bytes as json, %zu as cbor\n", text.size(), cbor_size.bytes);
+
+    run("serialize cbor::Writer", iterations, text.size(), [&](int i) {
+        report.uptime = i;
+        Buffer out;
+        cbor::Writer<Buffer>(out).value(report);
+        sink = sink + out.data[out.len - 1];
+    });
+
+    // cbor strings need no unescaping, the input is read as it is
+    Buffer encoded;
+    cbor::Writer<Buffer>(encoded).value(report);
+    run("parse cbor::Reader", iterations, text.size(), [&](int) {
+        Report res = {};
+        sink = sink + cbor::Reader(encoded.data, encoded.len).read(res);
+    });
+    return 0;
+}
@@ -0,0 +1,36 @@
+#ifndef PROJECT_SIM_FREERTOS_CONFIG_H
+#define PROJECT_SIM_FREERTOS_CONFIG_H
+
+// Host configuration of the FreeRTOS kernel sources, for simulations that run kernel objects
+// such as queues rather than the stand-ins in sim/freertos. The scheduler is never started; the
+// settings that shape queue.c and tasks.c follow Core/Inc/FreeRTOSConfig.h.
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define configUSE_PREEMPTION                     1
+#define configSUPPORT_STATIC_ALLOCATION          1
+#define configSUPPORT_DYNAMIC_ALLOCATION         0
+#define configUSE_IDLE_HOOK                      0
+#define configUSE_TICK_HOOK                      0
+#define configCPU_CLOCK_HZ                       72000000
+#define configTICK_RATE_HZ                       ((TickType_t)1000)
+#define configMAX_PRIORITIES                     ( 56 )
+#define configMINIMAL_STACK_SIZE                 ((uint16_t)128)
+#define configMAX_TASK_NAME_LEN                  ( 16 )
+#define configUSE_TRACE_FACILITY                 1
+#define configUSE_16_BIT_TICKS                   0
+#define configUSE_MUTEXES                        1
+#define configQUEUE_REGISTRY_SIZE                8
+#define configUSE_RECURSIVE_MUTEXES              1
+#define configUSE_COUNTING_SEMAPHORES            1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
+#define configUSE_CO_ROUTINES                    0
+#define configUSE_TIMERS                         0
+
+#define INCLUDE_vTaskSuspend                1
+#define INCLUDE_xTaskGetSchedulerState      1
+
+#define configASSERT( x ) if ((x) == 0) { abort(); }
+
+#endif // PROJECT_SIM_FREERTOS_CONFIG_H
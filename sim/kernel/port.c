@@ -0,0 +1,26 @@
+// The port functions tasks.c refers to. The scheduler of a simulation never starts, so there is
+// no stack to prepare and nothing to switch to.
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+StackType_t* pxPortInitialiseStack(StackType_t* pxTopOfStack, TaskFunction_t pxCode, void* pvParameters) {
+    (void) pxCode;
+    (void) pvParameters;
+    return pxTopOfStack;
+}
+
+BaseType_t xPortStartScheduler(void) {
+    return pdFALSE;
+}
+
+void vPortEndScheduler(void) {
+}
+
+void vApplicationGetIdleTaskMemory(StaticTask_t** ppxIdleTaskTCBBuffer, StackType_t** ppxIdleTaskStackBuffer, uint32_t* pulIdleTaskStackSize) {
+    static StaticTask_t tcb;
+    static StackType_t stack[configMINIMAL_STACK_SIZE];
+    *ppxIdleTaskTCBBuffer = &tcb;
+    *ppxIdleTaskStackBuffer = stack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
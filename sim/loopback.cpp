@@ -0,0 +1,175 @@
+// TCP echo served through the W5500 model, with a load generator on the host side.
+// The firmware side talks to the model only through SPI frames, the way the io library
+// does, so the numbers reflect the register traffic of a socket loop as well as the latency.
+//
+//   loopback [connections] [requests per connection] [payload bytes]
+
+#include "w5500.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace Project::sim;
+
+static constexpr uint16_t port = 5000;
+static constexpr uint16_t port_offset = 10000;
+static constexpr uint8_t n_sockets = 4;
+
+static W5500 chip({.port_offset=port_offset});
+static std::atomic<bool> running{true};
+
+static void frame(uint16_t offset, uint8_t block, bool write, uint8_t* data, size_t len) {
+    uint8_t head[3] = {uint8_t(offset >> 8), uint8_t(offset), uint8_t(block << 3 | (write ? 0x04 : 0))};
+    chip.select();
+    chip.transfer(head, nullptr, 3);
+    chip.transfer(write ? data : nullptr, write ? nullptr : data, len);
+    chip.deselect();
+}
+
+static uint8_t reg(uint8_t sn, uint16_t offset) {
+    uint8_t value;
+    frame(offset, 1 + 4 * sn, false, &value, 1);
+    return value;
+}
+
+static uint16_t reg16(uint8_t sn, uint16_t offset) {
+    uint8_t value[2];
+    frame(offset, 1 + 4 * sn, false, value, 2);
+    return uint16_t(value[0] << 8 | value[1]);
+}
+
+static void set_reg(uint8_t sn, uint16_t offset, uint8_t value) {
+    frame(offset, 1 + 4 * sn, true, &value, 1);
+}
+
+static void set_reg16(uint8_t sn, uint16_t offset, uint16_t value) {
+    uint8_t data[2] = {uint8_t(value >> 8), uint8_t(value)};
+    frame(offset, 1 + 4 * sn, true, data, 2);
+}
+
+// socket loop of the firmware: the same state machine as the http server, echoing instead
+static void firmware() {
+    uint8_t buf[2048];
+    while (running) {
+        bool busy = false;
+        for (uint8_t sn = 0; sn < n_sockets; ++sn) {
+            switch (reg(sn, 0x03)) {
+                case 0x00:  // CLOSED
+                    set_reg(sn, 0x00, 0x01);
+                    set_reg16(sn, 0x04, port);
+                    set_reg(sn, 0x01, 0x01);
+                    busy = true;
+                    continue;
+                case 0x13:  // INIT
+                    set_reg(sn, 0x01, 0x02);
+                    busy = true;
+                    continue;
+                case 0x1C:  // CLOSE_WAIT
+                    set_reg(sn, 0x01, 0x08);
+                    busy = true;
+                    continue;
+                case 0x17:  // ESTABLISHED
+                    break;
+                default:
+                    continue;
+            }
+
+            uint16_t len = reg16(sn, 0x26);
+            if (len == 0) {
+                continue;
+            }
+            len = std::min<uint16_t>(len, sizeof(buf));
+            uint16_t rd = reg16(sn, 0x28);
+            frame(rd, 3 + 4 * sn, false, buf, len);
+            set_reg16(sn, 0x28, rd + len);
+            set_reg(sn, 0x01, 0x40);
+
+            while (reg16(sn, 0x20) < len) {}
+            uint16_t wr = reg16(sn, 0x24);
+            frame(wr, 2 + 4 * sn, true, buf, len);
+            set_reg16(sn, 0x24, wr + len);
+            set_reg(sn, 0x01, 0x20);
+            busy = true;
+        }
+        if (not busy) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+static void client(int requests, size_t payload, std::vector<double>& latencies) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = ::inet_addr("127.0.0.1");
+    addr.sin_port = htons(port + port_offset);
+    while (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::vector<char> out(payload, 'x'), in(payload);
+    for (int i = 0; i < requests; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        ::send(fd, out.data(), payload, 0);
+        for (size_t got = 0; got < payload;) {
+            auto n = ::recv(fd, in.data() + got, payload - got, 0);
+            if (n <= 0) {
+                ::close(fd);
+                return;
+            }
+            got += n;
+        }
+        latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    ::close(fd);
+}
+
+int main(int argc, char** argv) {
+    int connections = argc > 1 ? std::atoi(argv[1]) : n_sockets;
+    int requests = argc > 2 ? std::atoi(argv[2]) : 1000;
+    size_t payload = argc > 3 ? std::atoi(argv[3]) : 64;
+
+    std::thread chip_thread(firmware);
+    std::vector<std::vector<double>> results(connections);
+    std::vector<std::thread> clients;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < connections; ++i) {
+        clients.emplace_back(client, requests, payload, std::ref(results[i]));
+    }
+    for (auto& t : clients) {
+        t.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    running = false;
+    chip_thread.join();
+
+    std::vector<double> all;
+    for (auto& r : results) {
+        all.insert(all.end(), r.begin(), r.end());
+    }
+    if (all.empty()) {
+        std::printf("no request completed\n");
+        return 1;
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&](double p) { return all[std::min(all.size() - 1, size_t(p * all.size()))]; };
+
+    auto& stats = chip.stats();
+    std::printf("%zu requests of %zu bytes over %d connections in %.2f s\n", all.size(), payload, connections, seconds);
+    std::printf("throughput  %.0f req/s, %.1f KB/s each way\n", all.size() / seconds, all.size() * payload / seconds / 1024);
+    std::printf("latency us  p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n", percentile(0.5), percentile(0.9), percentile(0.99), all.back());
+    std::printf("spi         %llu frames, %.1f bytes per payload byte\n",
+        (unsigned long long) stats.frames, double(stats.spi_bytes) / double(stats.rx_bytes + stats.tx_bytes));
+    return 0;
+}
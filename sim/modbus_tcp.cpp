@@ -0,0 +1,191 @@
+// Modbus TCP served through the W5500 model, with Modbus clients on the host side.
+// The firmware side is net/modbus/tcp_server.cpp itself, talking to the model through the
+// wizchip io library, see wizchip_port.cpp. Last, a client sends only the first bytes of a
+// request and the server must close the connection once it has been idle for idle_timeout.
+//
+//   modbus_tcp [connections] [transactions per connection] [registers]
+
+#include "wizchip_port.hpp"
+#include "net/interrupt.hpp"
+#include "net/modbus/tcp_server.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace Project::sim;
+using namespace Project::net::modbus;
+
+static constexpr uint16_t port = 502;
+static constexpr uint16_t port_offset = 10000;
+static constexpr uint8_t n_sockets = 2;
+static constexpr uint8_t first_socket = 6;
+static constexpr TickType_t idle_timeout = 200;
+
+static W5500 chip({.port_offset=port_offset});
+static std::atomic<bool> running{true};
+
+static uint16_t holding[125];
+static uint16_t inputs[16];
+
+static constexpr RegisterMap registers({
+    holding_registers(0, holding),
+    input_registers(0, inputs),
+});
+
+static TCPServer::Connection connections[n_sockets];
+
+static TCPServer server({
+    .port=port,
+    .socket=first_socket,
+    .connections=connections,
+    .n_connections=n_sockets,
+    .registers=registers,
+    .idle_timeout=idle_timeout,
+});
+
+// the model has no INT pin, the server is stepped by its host thread anyway
+bool Project::net::notify_on_interrupt(TaskHandle_t, uint8_t) {
+    return false;
+}
+
+// init() would start the task of the server, this thread steps the connections instead
+static void firmware() {
+    for (uint8_t i = 0; i < n_sockets; ++i) {
+        connections[i] = {};
+        connections[i].sn = first_socket + i;
+    }
+    while (running) {
+        bool busy = false;
+        for (auto& conn : connections) {
+            busy |= server.poll(conn);
+        }
+        if (not busy) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+static int connect_client() {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = ::inet_addr("127.0.0.1");
+    addr.sin_port = htons(port + port_offset);
+    while (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return fd;
+}
+
+// the header and the function code of a request, then nothing
+// @return ms until the server closed the connection, negative if it did not within 10 idle timeouts
+static double stalled_client() {
+    int fd = connect_client();
+    timeval limit = {.tv_sec=time_t(idle_timeout * 10 / 1000), .tv_usec=0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &limit, sizeof(limit));
+    uint8_t req[8] = {0, 1, 0, 0, 0, 6, 1, 0x03};
+    auto start = std::chrono::steady_clock::now();
+    ::send(fd, req, sizeof(req), 0);
+    uint8_t res[8];
+    auto n = ::recv(fd, res, sizeof(res), 0);
+    ::close(fd);
+    return n == 0 ? std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() : -1;
+}
+
+static void client(int transactions, int count, std::vector<double>& latencies, int& errors) {
+    int fd = connect_client();
+
+    // read holding registers, the transaction identifier counts up
+    uint8_t req[12] = {0, 0, 0, 0, 0, 6, 1, 0x03, 0, 0, 0, uint8_t(count)};
+    size_t res_len = 9 + 2 * count;
+    uint8_t res[260];
+    for (int i = 0; i < transactions; ++i) {
+        req[0] = uint8_t(i >> 8);
+        req[1] = uint8_t(i);
+        auto start = std::chrono::steady_clock::now();
+        ::send(fd, req, sizeof(req), 0);
+        for (size_t got = 0; got < res_len;) {
+            auto n = ::recv(fd, res + got, res_len - got, 0);
+            if (n <= 0) {
+                ::close(fd);
+                return;
+            }
+            got += n;
+        }
+        if (res[0] != req[0] or res[1] != req[1] or res[7] != 0x03 or res[8] != 2 * count) {
+            ++errors;
+        }
+        latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    ::close(fd);
+}
+
+int main(int argc, char** argv) {
+    int connections = argc > 1 ? std::atoi(argv[1]) : n_sockets;
+    int transactions = argc > 2 ? std::atoi(argv[2]) : 5000;
+    int count = argc > 3 ? std::atoi(argv[3]) : 10;
+    if (count < 1 or count > 125) {
+        std::printf("registers must be between 1 and 125\n");
+        return 1;
+    }
+    for (int i = 0; i < 125; ++i) {
+        holding[i] = uint16_t(i);
+    }
+
+    attach(chip);
+    std::thread chip_thread(firmware);
+    std::vector<std::vector<double>> results(connections);
+    std::vector<int> errors(connections);
+    std::vector<std::thread> clients;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < connections; ++i) {
+        clients.emplace_back(client, transactions, count, std::ref(results[i]), std::ref(errors[i]));
+    }
+    for (auto& t : clients) {
+        t.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double stalled = stalled_client();
+    running = false;
+    chip_thread.join();
+
+    std::vector<double> all;
+    for (auto& r : results) {
+        all.insert(all.end(), r.begin(), r.end());
+    }
+    if (all.empty()) {
+        std::printf("no transaction completed\n");
+        return 1;
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&](double p) { return all[std::min(all.size() - 1, size_t(p * all.size()))]; };
+    int bad = 0;
+    for (int e : errors) {
+        bad += e;
+    }
+
+    auto& stats = chip.stats();
+    std::printf("%zu transactions of %d registers over %d connections in %.2f s, %d bad responses\n",
+        all.size(), count, connections, seconds, bad);
+    std::printf("throughput  %.0f transactions/s\n", all.size() / seconds);
+    std::printf("latency us  p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n", percentile(0.5), percentile(0.9), percentile(0.99), all.back());
+    std::printf("spi         %llu frames, %.1f bytes per transaction\n",
+        (unsigned long long) stats.frames, double(stats.spi_bytes) / all.size());
+    if (stalled < 0) {
+        std::printf("half a request kept the connection open past the idle timeout of %u ms\n", unsigned(idle_timeout));
+        return 1;
+    }
+    std::printf("half a request closed after %.0f ms, idle timeout %u ms\n", stalled, unsigned(idle_timeout));
+    return bad ? 1 : 0;
+}
@@ -0,0 +1,140 @@
+// Modbus RTU master on a serial port that measures how fast the slave answers.
+// Every request reads holding registers; the turnaround is the time from the moment the
+// request has left the host to the first byte of the response, which is what the slave adds
+// on top of the wire time of both frames. USB serial adapters buffer received bytes, an FTDI
+// holds them for 16 ms by default, lower its latency timer first:
+//   echo 1 > /sys/bus/usb-serial/devices/ttyUSB0/latency_timer
+//
+//   modbus_turnaround <device> [requests] [registers] [baud] [address]
+
+#include "net/modbus/crc.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace Project::net::modbus;
+using Clock = std::chrono::steady_clock;
+
+static speed_t speed(int baud) {
+    switch (baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        default: return 0;
+    }
+}
+
+static int open_port(const char* device, int baud) {
+    int fd = ::open(device, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        return -1;
+    }
+    termios tio = {};
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, speed(baud));
+    cfsetospeed(&tio, speed(baud));
+    if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+/// read exactly len bytes, the arrival time of the first one goes in first
+static bool read_frame(int fd, uint8_t* buf, size_t len, Clock::time_point& first) {
+    for (size_t n = 0; n < len;) {
+        pollfd p = {fd, POLLIN, 0};
+        if (::poll(&p, 1, 100) <= 0) {
+            return false;
+        }
+        auto now = Clock::now();
+        ssize_t got = ::read(fd, buf + n, len - n);
+        if (got <= 0) {
+            return false;
+        }
+        if (n == 0) {
+            first = now;
+        }
+        n += got;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::printf("usage: %s <device> [requests] [registers] [baud] [address]\n", argv[0]);
+        return 1;
+    }
+    int requests = argc > 2 ? std::atoi(argv[2]) : 1000;
+    int registers = argc > 3 ? std::atoi(argv[3]) : 8;
+    int baud = argc > 4 ? std::atoi(argv[4]) : 115200;
+    int address = argc > 5 ? std::atoi(argv[5]) : 1;
+    if (speed(baud) == 0 or registers < 1 or registers > 125) {
+        std::printf("unsupported baud rate or register count\n");
+        return 1;
+    }
+
+    int fd = open_port(argv[1], baud);
+    if (fd < 0) {
+        std::perror(argv[1]);
+        return 1;
+    }
+
+    uint8_t req[8] = {uint8_t(address), 0x03, 0, 0, 0, uint8_t(registers)};
+    uint16_t crc = crc16(req, 6);
+    req[6] = uint8_t(crc);
+    req[7] = uint8_t(crc >> 8);
+    size_t res_len = 5 + 2 * registers;
+
+    std::vector<double> turnaround;
+    int timeouts = 0, errors = 0;
+    for (int i = 0; i < requests; ++i) {
+        tcflush(fd, TCIFLUSH);
+        if (::write(fd, req, sizeof(req)) != sizeof(req)) {
+            std::perror("write");
+            return 1;
+        }
+        tcdrain(fd);
+        auto sent = Clock::now();
+
+        uint8_t res[256];
+        Clock::time_point first;
+        if (not read_frame(fd, res, res_len, first)) {
+            ++timeouts;
+            continue;
+        }
+        if (res[0] != address or res[1] != 0x03 or crc16(res, res_len) != 0) {
+            ++errors;
+            continue;
+        }
+        turnaround.push_back(std::chrono::duration<double, std::micro>(first - sent).count());
+        // the master has to keep the line quiet for 3.5 characters between frames
+        ::usleep(2000);
+    }
+
+    if (turnaround.empty()) {
+        std::printf("no valid response, %d timeouts, %d errors\n", timeouts, errors);
+        return 1;
+    }
+    std::sort(turnaround.begin(), turnaround.end());
+    auto at = [&](double q) { return turnaround[size_t(q * (turnaround.size() - 1))]; };
+    double char_time = 11e6 / baud;
+    std::printf("%zu responses, %d timeouts, %d errors\n", turnaround.size(), timeouts, errors);
+    std::printf("turnaround us: min %.0f  p50 %.0f  p99 %.0f  max %.0f\n", at(0), at(0.5), at(0.99), at(1));
+    std::printf("wire time us: request %.0f  response %.0f\n", 8 * char_time, res_len * char_time);
+    ::close(fd);
+    return timeouts or errors ? 1 : 0;
+}
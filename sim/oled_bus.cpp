@@ -0,0 +1,248 @@
+// I2C bus time the Oled driver takes per frame, skipping unchanged columns and sending every
+// drawn column as before the skipping. The driver draws and flushes as the compositor does
+// every 50 ms, its register accesses go through the I2C stand-in in hal/i2c.h, and a model of
+// the SSD1306 takes the bytes off the bus into a display RAM of its own. Transfers are polled,
+// the bytes on the bus are the same with DMA.
+//
+// Bus time is derived from Stats.bytes, 9 clocks a byte at the 400 kHz of hi2c2, start and
+// stop conditions left out. Every screen is drawn on two displays, one per mode, and the
+// program fails unless the model saw the bytes the driver counted and both displays end up
+// showing the same pixels.
+//
+// With 1200 passes, bus time per frame that sent something:
+//
+//   screen                               diff       all
+//   status, heap_info and ethernet log   506 us     3075 us
+//   counters, a number on every line     3766 us    24120 us
+//   scroll, every line changes           19858 us   24120 us
+//
+//   oled_bus [passes]
+
+#include "drivers/oled.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Project::drivers;
+
+static constexpr double scl = 400e3;
+static constexpr double pass_ms = 50;
+static constexpr uint8_t address = 0x3C << 1;
+static constexpr size_t max_chars = Oled::width / Oled::char_width;
+
+namespace {
+    /// SSD1306 in page addressing mode, the part of it the driver uses
+    class Display {
+    public:
+        Display() : handle{&regs, &dma} {}
+
+        I2C_HandleTypeDef& hi2c() { return handle; }
+        uint32_t bytes() const { return total; }
+        bool valid() const { return not wrong_address; }
+        bool same(const Display& other) const { return ::memcmp(ram, other.ram, sizeof(ram)) == 0; }
+
+        bool flag(uint32_t flag) {
+            switch (flag) {
+                case I2C_FLAG_SB:
+                    // a start condition, the stop of the last transaction is implied
+                    if (not (regs.CR1 & I2C_CR1_START)) {
+                        return false;
+                    }
+                    CLEAR_BIT(regs.CR1, I2C_CR1_START | I2C_CR1_STOP);
+                    state = State::Control;
+                    pending = false;
+                    return true;
+                case I2C_FLAG_ADDR:
+                    wrong_address = wrong_address or regs.DR != address;
+                    total++;
+                    return true;
+                case I2C_FLAG_TXE:
+                    take();
+                    pending = true;
+                    return true;
+                case I2C_FLAG_BTF:
+                    take();
+                    pending = false;
+                    return true;
+                default:
+                    return false;  // every byte is acknowledged
+            }
+        }
+
+    private:
+        enum class State {Control, Command, Commands, Data};
+
+        /// the byte written to DR since the last flag
+        void take() {
+            if (not pending) {
+                return;
+            }
+            total++;
+            auto byte = uint8_t(regs.DR);
+            switch (state) {
+                case State::Control:
+                    state = byte == 0x80 ? State::Command : byte == 0x40 ? State::Data : State::Commands;
+                    break;
+                case State::Command:
+                    command(byte);
+                    state = State::Control;
+                    break;
+                case State::Commands:
+                    command(byte);
+                    break;
+                case State::Data:
+                    ram[page][column] = byte;
+                    column = (column + 1) % Oled::width;
+                    break;
+            }
+        }
+
+        // the arguments of the setup commands are taken for commands too, the column and
+        // page they set are set again before any data
+        void command(uint8_t byte) {
+            if (byte < 0x10) {
+                column = uint8_t((column & 0xF0) | byte);
+            } else if (byte < 0x20) {
+                column = uint8_t((column & 0x0F) | (byte & 0x0F) << 4) % Oled::width;
+            } else if ((byte & 0xF8) == 0xB0) {
+                page = byte & 0x07;
+            }
+        }
+
+        I2C_TypeDef regs = {};
+        DMA_Channel_TypeDef channel = {};
+        DMA_TypeDef controller = {};
+        DMA_HandleTypeDef dma = {&channel, &controller, 0, nullptr, nullptr, nullptr, nullptr};
+        I2C_HandleTypeDef handle;
+
+        uint8_t ram[Oled::pages][Oled::width] = {};
+        uint8_t page = 0;
+        uint8_t column = 0;
+        State state = State::Control;
+        bool pending = false;
+        bool wrong_address = false;
+        uint32_t total = 0;
+    };
+
+    struct Screen {
+        Display display;
+        Oled oled;
+
+        explicit Screen(bool compare) : oled({.hi2c=display.hi2c(), .dma_threshold=SIZE_MAX}) {
+            oled.compare(compare);
+        }
+    };
+}
+
+static Screen* screens[2];
+
+bool sim_i2c_flag(I2C_HandleTypeDef* hi2c, uint32_t flag) {
+    for (auto screen : screens) {
+        if (&screen->display.hi2c() == hi2c) {
+            return screen->display.flag(flag);
+        }
+    }
+    return false;
+}
+
+/// a region of the compositor: every cell of the line is drawn when its text changed
+static void region(Oled& oled, uint8_t row, const char* text) {
+    oled.setCursor({0, row});
+    size_t len = std::strlen(text);
+    for (size_t i = 0; i < max_chars; ++i) {
+        oled << (i < len ? text[i] : ' ');
+    }
+}
+
+// the default build: heap_info on row 0 every 100 ms, the ethernet log on row 1 now and then
+static void status(Oled& oled, uint32_t pass) {
+    char text[max_chars + 1];
+    if (pass % 2 == 0) {
+        std::snprintf(text, sizeof(text), "h: %u/3072 t: %u", 1400 + (pass / 2 * 37) % 96, 5 + (pass / 40) % 2);
+        region(oled, 0, text);
+    }
+    if (pass % 100 == 0) {
+        std::snprintf(text, sizeof(text), "dhcp 192.168.1.%u", 10 + (pass / 100) % 200);
+        region(oled, 1, text);
+    }
+}
+
+// a counter on every line, every pass
+static void counters(Oled& oled, uint32_t pass) {
+    char text[max_chars + 1];
+    for (uint8_t row = 0; row < Oled::pages; ++row) {
+        std::snprintf(text, sizeof(text), "ch%u %10u", row, pass * (row + 1) * 7);
+        region(oled, row, text);
+    }
+}
+
+// a log scrolling up a line every pass, every line changes completely
+static void scroll(Oled& oled, uint32_t pass) {
+    static const char* const lines[] = {"link up", "dhcp lease renewed", "GET /api/status 200", "modbus: 4 slaves",
+        "can 0x101 tx", "ntp offset -3 ms", "heap low water 812", "GET /metrics 200", "socket 3 closed"};
+    constexpr size_t n = sizeof(lines) / sizeof(lines[0]);
+    for (uint8_t row = 0; row < Oled::pages; ++row) {
+        region(oled, row, lines[(pass + row) % n]);
+    }
+}
+
+struct Result {
+    uint32_t frames;
+    uint32_t bytes;
+};
+
+static Result run(Screen& screen, void (*draw)(Oled&, uint32_t), uint32_t passes) {
+    auto before = screen.oled.stats();
+    for (uint32_t pass = 0; pass < passes; ++pass) {
+        draw(screen.oled, pass);
+        screen.oled.flush();
+    }
+    auto& after = screen.oled.stats();
+    return {after.frames - before.frames, after.bytes - before.bytes};
+}
+
+static void row(const char* name, const char* mode, const Result& res, uint32_t passes) {
+    double bus_us = res.bytes * 9 / scl * 1e6;
+    std::printf("%-9s %-4s %7u %12.1f %13.0f %7.2f%%\n", name, mode, res.frames,
+        res.frames ? double(res.bytes) / res.frames : 0, res.frames ? bus_us / res.frames : 0,
+        bus_us / (passes * pass_ms * 1e3) * 100);
+}
+
+int main(int argc, char** argv) {
+    uint32_t passes = argc > 1 ? uint32_t(std::strtoul(argv[1], nullptr, 10)) : 1200;
+
+    struct Scenario {
+        const char* name;
+        void (*draw)(Oled&, uint32_t);
+    };
+    const Scenario scenarios[] = {{"status", status}, {"counters", counters}, {"scroll", scroll}};
+
+    std::printf("%u passes of %.0f ms, I2C at %.0f kHz\n\n", passes, pass_ms, scl / 1e3);
+    std::printf("screen    mode  frames  bytes/frame  bus us/frame    bus\n");
+    bool ok = true;
+    for (auto& scenario : scenarios) {
+        Screen diff(true), all(false);
+        screens[0] = &diff;
+        screens[1] = &all;
+        diff.oled.init();
+        all.oled.init();
+
+        auto skipped = run(diff, scenario.draw, passes);
+        auto sent = run(all, scenario.draw, passes);
+        row(scenario.name, "diff", skipped, passes);
+        row(scenario.name, "all", sent, passes);
+
+        for (auto screen : screens) {
+            if (screen->display.bytes() != screen->oled.stats().bytes or not screen->display.valid()) {
+                std::printf("  the bus carried %u bytes, the driver counted %u\n",
+                    screen->display.bytes(), screen->oled.stats().bytes);
+                ok = false;
+            }
+        }
+        if (not diff.display.same(all.display)) {
+            std::printf("  the displays differ\n");
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+// What the ISR-to-task handoff costs per item through RingBuffer and through a FreeRTOS queue,
+// the kernel's own queue.c built for the host. The interrupt side pushes a batch with push,
+// push_n or xQueueSendFromISR and the task side drains it with pop, pop_n or xQueueReceive,
+// both played by one thread, for the bytes of a UART or CDC stream and for 16-byte CAN frames.
+//
+// The host port leaves out the BASEPRI writes the Cortex-M3 port adds to every critical
+// section and interrupt-safe call, so the queue figures are a lower bound of its cost there.
+//
+//   ring_buffer_bench [batches]
+
+#include "utils/ring_buffer.hpp"
+#include "FreeRTOS.h"
+#include "queue.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Project::utils;
+
+static constexpr size_t capacity = 64;
+static constexpr size_t batch = 16;
+
+namespace {
+    struct Frame {
+        uint32_t id;
+        uint8_t len;
+        uint8_t data[8];
+    };
+}
+
+template <typename T>
+static T item(uint32_t i) {
+    if constexpr (sizeof(T) == 1) {
+        return T(i);
+    } else {
+        return T{i, 8, {uint8_t(i)}};
+    }
+}
+
+template <typename T>
+static uint32_t sum(const T& item) {
+    if constexpr (sizeof(T) == 1) {
+        return item;
+    } else {
+        return item.id + item.data[0];
+    }
+}
+
+struct Result {
+    double ns;
+    uint32_t check;
+};
+
+template <typename F>
+static Result measure(uint32_t batches, F&& fn) {
+    uint32_t check = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t b = 0; b < batches; ++b) {
+        check += fn(b);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return {ns / (double(batches) * batch), check};
+}
+
+template <typename T>
+static Result ring_single(uint32_t batches) {
+    static RingBuffer<T, capacity> ring;
+    return measure(batches, [](uint32_t b) {
+        for (uint32_t i = 0; i < batch; ++i) {
+            ring.push(item<T>(b * batch + i));
+        }
+        uint32_t check = 0;
+        T out;
+        while (ring.pop(out)) {
+            check += sum(out);
+        }
+        return check;
+    });
+}
+
+template <typename T>
+static Result ring_bulk(uint32_t batches) {
+    static RingBuffer<T, capacity> ring;
+    return measure(batches, [](uint32_t b) {
+        T in[batch], out[batch];
+        for (uint32_t i = 0; i < batch; ++i) {
+            in[i] = item<T>(b * batch + i);
+        }
+        ring.push_n(in, batch);
+        uint32_t check = 0;
+        size_t n = ring.pop_n(out, batch);
+        for (size_t i = 0; i < n; ++i) {
+            check += sum(out[i]);
+        }
+        return check;
+    });
+}
+
+template <typename T>
+static Result queue(uint32_t batches) {
+    static StaticQueue_t buffer;
+    static uint8_t storage[capacity * sizeof(T)];
+    static QueueHandle_t q = xQueueCreateStatic(capacity, sizeof(T), storage, &buffer);
+    return measure(batches, [](uint32_t b) {
+        for (uint32_t i = 0; i < batch; ++i) {
+            T in = item<T>(b * batch + i);
+            BaseType_t woken = pdFALSE;
+            xQueueSendFromISR(q, &in, &woken);
+        }
+        uint32_t check = 0;
+        T out;
+        while (xQueueReceive(q, &out, 0) == pdTRUE) {
+            check += sum(out);
+        }
+        return check;
+    });
+}
+
+template <typename T>
+static bool row(const char* name, uint32_t batches) {
+    auto single = ring_single<T>(batches);
+    auto bulk = ring_bulk<T>(batches);
+    auto kernel = queue<T>(batches);
+    std::printf("%-6s %10.2f %10.2f %14.2f %8.1fx\n", name, single.ns, bulk.ns, kernel.ns, kernel.ns / single.ns);
+    // every path hands over the same items
+    return single.check == kernel.check and bulk.check == kernel.check;
+}
+
+int main(int argc, char** argv) {
+    uint32_t batches = argc > 1 ? uint32_t(std::strtoul(argv[1], nullptr, 10)) : 2000000;
+
+    std::printf("ns per item, batches of %zu through %zu slots\n\n", batch, capacity);
+    std::printf("item   push/pop   push_n/pop_n  xQueueSendFromISR  queue/ring\n");
+    bool ok = row<uint8_t>("byte", batches);
+    ok = row<Frame>("frame", batches) and ok;
+    if (not ok) {
+        std::printf("\nthe paths disagree on the items handed over\n");
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+// Two threads hammer one RingBuffer, the producer with push, push_n and write_span/commit and
+// the consumer with pop, pop_n and read_span/consume, in runs of random length so every
+// combination meets the wrap-around. Items are a running sequence number, the consumer checks
+// that each one comes out exactly once and in order.
+//
+// Copying an item in or out of the ring yields the thread now and then, before the copy, so
+// the other side runs right where an interrupt could land between an index update and the
+// data it covers, even on a single core. A ring that publishes head before writing the item,
+// or tail before reading it, hands over stale or overwritten items and is reported.
+// The ring orders its accesses with compiler fences only, which holds on a host that keeps
+// the order of loads and stores like the Cortex-M3, e.g. x86; reordering by a weaker host is
+// not what this checks.
+//
+//   ring_buffer_stress [items]
+
+#include "utils/ring_buffer.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+
+using namespace Project::utils;
+
+static constexpr size_t capacity = 64;
+static constexpr size_t max_run = capacity + capacity / 2;  ///< longer than the ring on purpose
+static constexpr uint32_t yield_every = 8;                  ///< copies per injected yield, on average
+
+/// xorshift, each thread has its own
+static uint32_t next(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+namespace {
+    /// a sequence number that may give the core away before it is copied
+    struct Item {
+        uint32_t seq = 0;
+
+        Item() = default;
+        Item(uint32_t seq) : seq(seq) {}
+        Item(const Item& other) : seq((preempt(), other.seq)) {}
+
+        Item& operator=(const Item& other) {
+            preempt();
+            seq = other.seq;
+            return *this;
+        }
+
+        operator uint32_t() const { return seq; }
+
+        static void preempt() {
+            static thread_local uint32_t random = 0xC0FFEE ^ uint32_t(std::hash<std::thread::id>()(std::this_thread::get_id()));
+            if (next(random) % yield_every == 0) {
+                std::this_thread::yield();
+            }
+        }
+    };
+}
+
+static RingBuffer<Item, capacity> ring;
+
+static void producer(uint32_t items) {
+    uint32_t random = 0x12345678;
+    uint32_t seq = 0;
+    Item batch[max_run];
+    while (seq < items) {
+        uint32_t r = next(random);
+        size_t n = 1 + r % max_run;
+        if (n > items - seq) {
+            n = items - seq;
+        }
+        if (ring.full()) {
+            // the other side may share the core
+            std::this_thread::yield();
+            continue;
+        }
+        switch (r >> 30) {
+            case 0:
+                seq += ring.push(seq);
+                break;
+            case 1: {
+                for (size_t i = 0; i < n; ++i) {
+                    batch[i] = seq + i;
+                }
+                seq += ring.push_n(batch, n);
+                break;
+            }
+            default: {
+                auto span = ring.write_span();
+                n = n < span.len ? n : span.len;
+                for (size_t i = 0; i < n; ++i) {
+                    span.data[i] = seq + i;
+                }
+                ring.commit(n);
+                seq += n;
+                break;
+            }
+        }
+    }
+}
+
+/// @return number of items that were out of sequence
+static uint32_t consumer(uint32_t items, uint32_t& overfull) {
+    uint32_t random = 0x9E3779B9;
+    uint32_t seq = 0, errors = 0;
+    Item batch[max_run];
+    auto check = [&](uint32_t item) {
+        if (item != seq) {
+            errors++;
+            seq = item;
+        }
+        seq++;
+    };
+    while (seq < items) {
+        if (ring.size() > capacity) {
+            overfull++;
+        }
+        if (ring.empty()) {
+            std::this_thread::yield();
+            continue;
+        }
+        uint32_t r = next(random);
+        size_t n = 1 + r % max_run;
+        switch (r >> 30) {
+            case 0: {
+                Item item;
+                if (ring.pop(item)) {
+                    check(item);
+                }
+                break;
+            }
+            case 1: {
+                n = ring.pop_n(batch, n);
+                for (size_t i = 0; i < n; ++i) {
+                    check(batch[i]);
+                }
+                break;
+            }
+            default: {
+                auto span = ring.read_span();
+                n = n < span.len ? n : span.len;
+                for (size_t i = 0; i < n; ++i) {
+                    check(span.data[i]);
+                }
+                ring.consume(n);
+                break;
+            }
+        }
+    }
+    return errors;
+}
+
+int main(int argc, char** argv) {
+    uint32_t items = argc > 1 ? uint32_t(std::strtoul(argv[1], nullptr, 10)) : 10000000;
+
+    uint32_t errors = 0, overfull = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer_thread([&] { errors = consumer(items, overfull); });
+    std::thread producer_thread(producer, items);
+    producer_thread.join();
+    consumer_thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%u items through a ring of %zu in %.2f s, %.1f M items/s\n",
+        items, capacity, seconds, items / seconds / 1e6);
+    std::printf("%u out of sequence, %u times over capacity, %s\n", errors, overfull, ring.empty() ? "drained" : "NOT drained");
+    return errors == 0 and overfull == 0 and ring.empty() ? 0 : 1;
+}
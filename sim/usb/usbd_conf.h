@@ -0,0 +1,65 @@
+#ifndef PROJECT_SIM_USBD_CONF_H
+#define PROJECT_SIM_USBD_CONF_H
+
+// Host stand-in for USB_DEVICE/Target/usbd_conf.h, with the same device library settings but
+// without the HAL. The PCD handle only keeps what the CDC class reads from it; the USBD_LL
+// functions behind it are defined by the simulation, which plays the USB peripheral.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define USBD_MAX_NUM_INTERFACES     1
+#define USBD_MAX_NUM_CONFIGURATION     1
+#define USBD_MAX_STR_DESC_SIZ     128
+#define USBD_DEBUG_LEVEL     0
+#define USBD_SELF_POWERED     1
+#define MAX_STATIC_ALLOC_SIZE     512
+
+#define DEVICE_FS 		0
+
+#define USBD_malloc         (uint32_t *)USBD_static_malloc
+#define USBD_free           USBD_static_free
+#define USBD_Delay(ms)      ((void) (ms))
+
+#define USBD_UsrLog(...)
+#define USBD_ErrLog(...)
+#define USBD_DbgLog(...)
+
+#ifndef __IO
+#define __IO volatile
+#endif
+#ifndef __weak
+#define __weak __attribute__((weak))
+#endif
+#ifndef UNUSED
+#define UNUSED(x) ((void) (x))
+#endif
+
+typedef struct {
+    uint8_t num;
+    uint8_t is_in;
+    uint16_t maxpacket;
+    uint8_t* xfer_buff;
+    uint32_t xfer_len;
+} PCD_EPTypeDef;
+
+typedef struct {
+    PCD_EPTypeDef IN_ep[8];
+    PCD_EPTypeDef OUT_ep[8];
+    void* pData;
+} PCD_HandleTypeDef;
+
+void *USBD_static_malloc(uint32_t size);
+void USBD_static_free(void *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PROJECT_SIM_USBD_CONF_H
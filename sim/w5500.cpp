@@ -0,0 +1,648 @@
+#include "w5500.hpp"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace Project::sim;
+
+namespace {
+    // control byte
+    constexpr uint8_t rwb = 0x04;
+    constexpr uint8_t om_mask = 0x03;
+
+    // common registers
+    constexpr uint16_t MR = 0x00, IR = 0x15, IMR = 0x16, SIR = 0x17, SIMR = 0x18, RTR = 0x19, RCR = 0x1B,
+        PTIMER = 0x1C, PHYCFGR = 0x2E, VERSIONR = 0x39;
+
+    // socket registers
+    constexpr uint16_t Sn_MR = 0x00, Sn_CR = 0x01, Sn_IR = 0x02, Sn_SR = 0x03, Sn_PORT = 0x04, Sn_DIPR = 0x0C,
+        Sn_DPORT = 0x10, Sn_MSSR = 0x12, Sn_TTL = 0x16, Sn_RXBUF_SIZE = 0x1E, Sn_TXBUF_SIZE = 0x1F,
+        Sn_TX_FSR = 0x20, Sn_TX_RD = 0x22, Sn_TX_WR = 0x24, Sn_RX_RSR = 0x26, Sn_RX_RD = 0x28, Sn_RX_WR = 0x2A,
+        Sn_IMR = 0x2C, Sn_FRAG = 0x2D;
+
+    constexpr uint8_t CR_OPEN = 0x01, CR_LISTEN = 0x02, CR_CONNECT = 0x04, CR_DISCON = 0x08, CR_CLOSE = 0x10,
+        CR_SEND = 0x20, CR_SEND_MAC = 0x21, CR_SEND_KEEP = 0x22, CR_RECV = 0x40;
+
+    constexpr uint8_t IR_CON = 0x01, IR_DISCON = 0x02, IR_RECV = 0x04, IR_TIMEOUT = 0x08, IR_SENDOK = 0x10;
+
+    constexpr uint8_t SOCK_CLOSED = 0x00, SOCK_INIT = 0x13, SOCK_LISTEN = 0x14, SOCK_SYNSENT = 0x15,
+        SOCK_ESTABLISHED = 0x17, SOCK_FIN_WAIT = 0x18, SOCK_CLOSE_WAIT = 0x1C, SOCK_UDP = 0x22;
+
+    constexpr uint8_t MR_TCP = 0x01, MR_UDP = 0x02;
+
+    constexpr size_t udp_header = 8; ///< source IP, port and length in front of each datagram
+
+    void nonblocking(int fd) {
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+}
+
+W5500::W5500(Config config) : port_offset(config.port_offset), host(config.host), auto_poll(config.auto_poll) {
+    for (auto& s : sockets) {
+        s.fd = -1;
+    }
+    reset();
+}
+
+W5500::~W5500() {
+    reset();
+    for (auto& [port, fd] : listeners) {
+        ::close(fd);
+    }
+}
+
+void W5500::reset() {
+    for (auto& s : sockets) {
+        if (s.fd >= 0) {
+            ::close(s.fd);
+        }
+        ::memset(s.reg, 0, sizeof(s.reg));
+        s.fd = -1;
+        s.send_end = 0;
+        s.sending = false;
+        s.reg[Sn_IMR] = 0xFF;
+        s.reg[Sn_TTL] = 0x80;
+        set16(s.reg, Sn_FRAG, 0x4000);
+        s.reg[Sn_RXBUF_SIZE] = 2;
+        s.reg[Sn_TXBUF_SIZE] = 2;
+    }
+    ::memset(common, 0, sizeof(common));
+    set16(common, RTR, 0x07D0);
+    common[RCR] = 0x08;
+    common[PTIMER] = 0x28;
+    common[PHYCFGR] = 0xBF;  // link up, 100 Mbps full duplex
+    common[VERSIONR] = 0x04;
+    phase = Phase::Done;
+}
+
+void W5500::select() {
+    phase = Phase::Address0;
+    statistics.frames++;
+    if (auto_poll) {
+        poll();
+    }
+}
+
+void W5500::deselect() {
+    phase = Phase::Done;
+}
+
+uint8_t W5500::transfer(uint8_t mosi) {
+    statistics.spi_bytes++;
+    switch (phase) {
+        case Phase::Address0:
+            offset = uint16_t(mosi << 8);
+            phase = Phase::Address1;
+            return 0;
+
+        case Phase::Address1:
+            offset |= mosi;
+            phase = Phase::Control;
+            return 0;
+
+        case Phase::Control: {
+            block = mosi >> 3;
+            writing = mosi & rwb;
+            // OM 01, 10 and 11 are fixed length frames of 1, 2 and 4 bytes
+            uint8_t om = mosi & om_mask;
+            remaining = om == 0 ? 0 : om == 3 ? 4 : om;
+            phase = Phase::Data;
+            return 0;
+        }
+
+        case Phase::Data: {
+            uint8_t miso = 0;
+            if (writing) {
+                write(block, offset, mosi);
+            } else {
+                miso = read(block, offset);
+            }
+            offset++;
+            if (remaining > 0 and --remaining == 0) {
+                // a fixed length frame is followed by the next one without a chip select
+                phase = Phase::Address0;
+            }
+            return miso;
+        }
+
+        case Phase::Done:
+            break;
+    }
+    return 0;
+}
+
+void W5500::transfer(const uint8_t* tx, uint8_t* rx, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t miso = transfer(tx ? tx[i] : 0);
+        if (rx) {
+            rx[i] = miso;
+        }
+    }
+}
+
+bool W5500::interrupt() const {
+    if (common[IR] & common[IMR]) {
+        return true;
+    }
+    for (size_t n = 0; n < n_sockets; ++n) {
+        if ((common[SIMR] & (1u << n)) and (sockets[n].reg[Sn_IR] & sockets[n].reg[Sn_IMR])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t W5500::read(uint8_t block, uint16_t offset) {
+    if (block == 0) {
+        if (offset == SIR) {
+            uint8_t sir = 0;
+            for (size_t n = 0; n < n_sockets; ++n) {
+                if (sockets[n].reg[Sn_IR] & sockets[n].reg[Sn_IMR]) {
+                    sir |= 1u << n;
+                }
+            }
+            return sir;
+        }
+        return offset < sizeof(common) ? common[offset] : 0;
+    }
+
+    size_t sn = (block - 1) / 4;
+    auto& s = sockets[sn];
+    switch ((block - 1) % 4) {
+        case 0: return read_socket(s, offset);
+        case 1: return tx_size(s) ? s.tx[offset & (tx_size(s) - 1)] : 0;
+        case 2: return rx_size(s) ? s.rx[offset & (rx_size(s) - 1)] : 0;
+        default: return 0;
+    }
+}
+
+void W5500::write(uint8_t block, uint16_t offset, uint8_t value) {
+    if (block == 0) {
+        switch (offset) {
+            case MR:
+                if (value & 0x80) {
+                    reset();
+                    return;
+                }
+                break;
+            case IR:
+                common[IR] &= ~value;
+                return;
+            case SIR:
+            case VERSIONR:
+                return;
+            case PHYCFGR:
+                // the link status bits are read only
+                common[PHYCFGR] = (value & 0xF8) | (common[PHYCFGR] & 0x07);
+                return;
+        }
+        if (offset < sizeof(common)) {
+            common[offset] = value;
+        }
+        return;
+    }
+
+    size_t sn = (block - 1) / 4;
+    auto& s = sockets[sn];
+    switch ((block - 1) % 4) {
+        case 0:
+            write_socket(s, offset, value);
+            break;
+        case 1:
+            if (tx_size(s)) {
+                s.tx[offset & (tx_size(s) - 1)] = value;
+            }
+            break;
+        case 2:
+            if (rx_size(s)) {
+                s.rx[offset & (rx_size(s) - 1)] = value;
+            }
+            break;
+    }
+}
+
+uint8_t W5500::read_socket(Socket& s, uint16_t offset) {
+    switch (offset) {
+        case Sn_CR:
+            return 0;  // commands complete at once
+        case Sn_TX_FSR:
+        case Sn_TX_FSR + 1: {
+            // room freed by what the host socket took, not by writing Sn_TX_WR
+            uint16_t fsr = uint16_t(tx_size(s) - uint16_t(s.send_end - get16(s.reg, Sn_TX_RD)));
+            return offset == Sn_TX_FSR ? fsr >> 8 : fsr & 0xFF;
+        }
+        case Sn_RX_RSR:
+        case Sn_RX_RSR + 1: {
+            uint16_t rsr = get16(s.reg, Sn_RX_WR) - get16(s.reg, Sn_RX_RD);
+            return offset == Sn_RX_RSR ? rsr >> 8 : rsr & 0xFF;
+        }
+        default:
+            return offset < sizeof(s.reg) ? s.reg[offset] : 0;
+    }
+}
+
+void W5500::write_socket(Socket& s, uint16_t offset, uint8_t value) {
+    switch (offset) {
+        case Sn_CR:
+            return command(s, value);
+        case Sn_IR:
+            s.reg[Sn_IR] &= ~value;
+            return;
+        case Sn_SR:
+        case Sn_TX_FSR: case Sn_TX_FSR + 1:
+        case Sn_TX_RD: case Sn_TX_RD + 1:
+        case Sn_RX_RSR: case Sn_RX_RSR + 1:
+        case Sn_RX_WR: case Sn_RX_WR + 1:
+            return;
+        case Sn_RXBUF_SIZE:
+        case Sn_TXBUF_SIZE:
+            // 0, 1, 2, 4, 8 or 16 KB
+            if (value > 16 or (value & (value - 1))) {
+                return;
+            }
+            break;
+    }
+    if (offset < sizeof(s.reg)) {
+        s.reg[offset] = value;
+    }
+}
+
+void W5500::command(Socket& s, uint8_t cr) {
+    switch (cr) {
+        case CR_OPEN: return open(s);
+        case CR_LISTEN: return listen(s);
+        case CR_CONNECT: return connect(s);
+        case CR_DISCON: return disconnect(s);
+        case CR_CLOSE: return close(s);
+        case CR_SEND:
+        case CR_SEND_MAC:
+            return send(s);
+        case CR_SEND_KEEP:
+        case CR_RECV:
+            // the received size is worked out from the pointers whenever it is read
+            return;
+    }
+}
+
+void W5500::open(Socket& s) {
+    close(s);
+    set16(s.reg, Sn_TX_RD, 0);
+    set16(s.reg, Sn_TX_WR, 0);
+    set16(s.reg, Sn_RX_RD, 0);
+    set16(s.reg, Sn_RX_WR, 0);
+    s.send_end = 0;
+
+    switch (s.reg[Sn_MR] & 0x0F) {
+        case MR_TCP:
+            s.reg[Sn_SR] = SOCK_INIT;
+            break;
+
+        case MR_UDP: {
+            int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = ::inet_addr(host);
+            addr.sin_port = htons(uint16_t(get16(s.reg, Sn_PORT) + port_offset));
+            if (fd < 0 or ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+                if (fd >= 0) {
+                    ::close(fd);
+                }
+                return;
+            }
+            nonblocking(fd);
+            s.fd = fd;
+            s.reg[Sn_SR] = SOCK_UDP;
+            break;
+        }
+
+        default:
+            // MACRAW has nothing to bridge to
+            break;
+    }
+}
+
+void W5500::listen(Socket& s) {
+    if (s.reg[Sn_SR] != SOCK_INIT) {
+        return;
+    }
+    if (listener(get16(s.reg, Sn_PORT)) < 0) {
+        return closed(s, IR_TIMEOUT);
+    }
+    s.reg[Sn_SR] = SOCK_LISTEN;
+}
+
+void W5500::connect(Socket& s) {
+    if (s.reg[Sn_SR] != SOCK_INIT) {
+        return;
+    }
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return closed(s, IR_TIMEOUT);
+    }
+    nonblocking(fd);
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = ::inet_addr(host);
+    addr.sin_port = htons(get16(s.reg, Sn_DPORT));
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 and errno != EINPROGRESS) {
+        ::close(fd);
+        return closed(s, IR_TIMEOUT);
+    }
+    s.fd = fd;
+    s.reg[Sn_SR] = SOCK_SYNSENT;
+}
+
+void W5500::disconnect(Socket& s) {
+    auto sr = s.reg[Sn_SR];
+    if (sr == SOCK_CLOSE_WAIT) {
+        // the peer is gone already, the FIN completes the close
+        flush(s);
+        return closed(s, IR_DISCON);
+    }
+    if (sr == SOCK_ESTABLISHED) {
+        flush(s);
+        ::shutdown(s.fd, SHUT_WR);
+        s.reg[Sn_SR] = SOCK_FIN_WAIT;
+    }
+}
+
+void W5500::close(Socket& s) {
+    if (s.fd >= 0) {
+        ::close(s.fd);
+        s.fd = -1;
+    }
+    s.sending = false;
+    s.reg[Sn_SR] = SOCK_CLOSED;
+}
+
+void W5500::send(Socket& s) {
+    auto sr = s.reg[Sn_SR];
+    if (tx_size(s) == 0) {
+        return;
+    }
+    if (sr == SOCK_UDP) {
+        // a datagram goes out whole
+        uint16_t rd = get16(s.reg, Sn_TX_RD);
+        uint16_t wr = get16(s.reg, Sn_TX_WR);
+        size_t len = uint16_t(wr - rd);
+        uint8_t buf[max_buffer];
+        for (size_t i = 0; i < len; ++i) {
+            buf[i] = s.tx[(rd + i) & (tx_size(s) - 1)];
+        }
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = ::inet_addr(host);
+        addr.sin_port = htons(get16(s.reg, Sn_DPORT));
+        ::sendto(s.fd, buf, len, 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        statistics.tx_bytes += len;
+        set16(s.reg, Sn_TX_RD, wr);
+        s.send_end = wr;
+        s.reg[Sn_IR] |= IR_SENDOK;
+        return;
+    }
+    if (sr != SOCK_ESTABLISHED and sr != SOCK_CLOSE_WAIT) {
+        return;
+    }
+    s.send_end = get16(s.reg, Sn_TX_WR);
+    s.sending = true;
+    flush(s);
+}
+
+void W5500::poll() {
+    pollfd fds[n_sockets];
+    size_t n = 0;
+    for (auto& s : sockets) {
+        auto sr = s.reg[Sn_SR];
+        int fd = sr == SOCK_LISTEN ? listener(get16(s.reg, Sn_PORT)) : s.fd;
+        if (fd < 0) {
+            continue;
+        }
+        short events = POLLIN;
+        if (sr == SOCK_SYNSENT or s.sending) {
+            events |= POLLOUT;
+        }
+        fds[n++] = {fd, events, 0};
+    }
+    if (n == 0 or ::poll(fds, n, 0) <= 0) {
+        return;
+    }
+
+    size_t i = 0;
+    for (auto& s : sockets) {
+        auto sr = s.reg[Sn_SR];
+        int fd = sr == SOCK_LISTEN ? listener(get16(s.reg, Sn_PORT)) : s.fd;
+        if (fd < 0) {
+            continue;
+        }
+        auto revents = fds[i++].revents;
+        if (revents == 0) {
+            continue;
+        }
+
+        switch (sr) {
+            case SOCK_LISTEN:
+                accept(s, fd);
+                break;
+            case SOCK_SYNSENT:
+                connected(s);
+                break;
+            case SOCK_UDP:
+                receive_udp(s);
+                break;
+            default:
+                if (revents & POLLOUT) {
+                    flush(s);
+                }
+                if (revents & (POLLIN | POLLHUP | POLLERR)) {
+                    receive(s);
+                }
+                break;
+        }
+    }
+}
+
+void W5500::flush(Socket& s) {
+    uint16_t rd = get16(s.reg, Sn_TX_RD);
+    while (s.sending and rd != s.send_end) {
+        // contiguous part of the ring up to the end of the SEND or the end of the memory
+        size_t size = tx_size(s);
+        size_t start = rd & (size - 1);
+        size_t len = uint16_t(s.send_end - rd);
+        if (len > size - start) {
+            len = size - start;
+        }
+        auto n = ::send(s.fd, s.tx + start, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            if (n < 0 and errno != EAGAIN and errno != EWOULDBLOCK) {
+                closed(s, IR_TIMEOUT);
+            }
+            break;
+        }
+        rd += n;
+        statistics.tx_bytes += n;
+    }
+    set16(s.reg, Sn_TX_RD, rd);
+    if (s.sending and rd == s.send_end) {
+        s.sending = false;
+        s.reg[Sn_IR] |= IR_SENDOK;
+    }
+}
+
+void W5500::receive(Socket& s) {
+    auto sr = s.reg[Sn_SR];
+    if (sr != SOCK_ESTABLISHED and sr != SOCK_FIN_WAIT) {
+        return;
+    }
+
+    size_t size = rx_size(s);
+    uint16_t rd = get16(s.reg, Sn_RX_RD);
+    uint16_t wr = get16(s.reg, Sn_RX_WR);
+    size_t free = size - uint16_t(wr - rd);
+    if (free == 0) {
+        return;  // the peer is held back by the full window until the firmware reads
+    }
+
+    size_t start = wr & (size - 1);
+    size_t len = free < size - start ? free : size - start;
+    auto n = ::recv(s.fd, s.rx + start, len, 0);
+    if (n > 0) {
+        set16(s.reg, Sn_RX_WR, uint16_t(wr + n));
+        s.reg[Sn_IR] |= IR_RECV;
+        statistics.rx_bytes += n;
+        return;
+    }
+    if (n < 0 and (errno == EAGAIN or errno == EWOULDBLOCK)) {
+        return;
+    }
+    if (n == 0 and sr == SOCK_ESTABLISHED) {
+        // FIN from the peer, unread data stays readable
+        s.reg[Sn_SR] = SOCK_CLOSE_WAIT;
+        s.reg[Sn_IR] |= IR_DISCON;
+        return;
+    }
+    // FIN after our own, or a reset
+    closed(s, IR_DISCON);
+}
+
+void W5500::receive_udp(Socket& s) {
+    size_t size = rx_size(s);
+    uint16_t rd = get16(s.reg, Sn_RX_RD);
+    uint16_t wr = get16(s.reg, Sn_RX_WR);
+    size_t free = size - uint16_t(wr - rd);
+
+    uint8_t buf[max_buffer];
+    sockaddr_in addr = {};
+    socklen_t addr_len = sizeof(addr);
+    auto n = ::recvfrom(s.fd, buf, sizeof(buf), MSG_PEEK, reinterpret_cast<sockaddr*>(&addr), &addr_len);
+    if (n < 0 or size_t(n) + udp_header > free) {
+        return;  // left in the host socket until the firmware makes room
+    }
+    n = ::recv(s.fd, buf, sizeof(buf), 0);
+
+    uint8_t header[udp_header];
+    ::memcpy(header, &addr.sin_addr.s_addr, 4);
+    uint16_t port = ntohs(addr.sin_port);
+    header[4] = port >> 8;
+    header[5] = port & 0xFF;
+    header[6] = uint16_t(n) >> 8;
+    header[7] = uint16_t(n) & 0xFF;
+    for (size_t i = 0; i < udp_header; ++i) {
+        s.rx[wr++ & (size - 1)] = header[i];
+    }
+    for (ssize_t i = 0; i < n; ++i) {
+        s.rx[wr++ & (size - 1)] = buf[i];
+    }
+    set16(s.reg, Sn_RX_WR, wr);
+    s.reg[Sn_IR] |= IR_RECV;
+    statistics.rx_bytes += n;
+}
+
+void W5500::accept(Socket& s, int listener) {
+    sockaddr_in addr = {};
+    socklen_t addr_len = sizeof(addr);
+    int fd = ::accept(listener, reinterpret_cast<sockaddr*>(&addr), &addr_len);
+    if (fd < 0) {
+        return;  // another listening socket on the same port took it
+    }
+    nonblocking(fd);
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    s.fd = fd;
+    ::memcpy(&s.reg[Sn_DIPR], &addr.sin_addr.s_addr, 4);
+    set16(s.reg, Sn_DPORT, ntohs(addr.sin_port));
+    set16(s.reg, Sn_MSSR, 1460);
+    s.reg[Sn_SR] = SOCK_ESTABLISHED;
+    s.reg[Sn_IR] |= IR_CON;
+    statistics.connections++;
+}
+
+void W5500::connected(Socket& s) {
+    int error = 0;
+    socklen_t len = sizeof(error);
+    ::getsockopt(s.fd, SOL_SOCKET, SO_ERROR, &error, &len);
+    if (error != 0) {
+        return closed(s, IR_TIMEOUT);
+    }
+    set16(s.reg, Sn_MSSR, 1460);
+    s.reg[Sn_SR] = SOCK_ESTABLISHED;
+    s.reg[Sn_IR] |= IR_CON;
+    statistics.connections++;
+}
+
+void W5500::closed(Socket& s, uint8_t ir) {
+    close(s);
+    s.reg[Sn_IR] |= ir;
+}
+
+int W5500::listener(uint16_t port) {
+    if (auto it = listeners.find(port); it != listeners.end()) {
+        return it->second;
+    }
+
+    // one host listener per port is shared by every W5500 socket listening on it, and stays
+    // open so connections are not refused between two LISTEN commands
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = ::inet_addr(host);
+    addr.sin_port = htons(uint16_t(port + port_offset));
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 or ::listen(fd, 16) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    nonblocking(fd);
+    listeners[port] = fd;
+    return fd;
+}
+
+uint16_t W5500::get16(const uint8_t* reg, uint16_t offset) {
+    return uint16_t(reg[offset] << 8 | reg[offset + 1]);
+}
+
+void W5500::set16(uint8_t* reg, uint16_t offset, uint16_t value) {
+    reg[offset] = value >> 8;
+    reg[offset + 1] = value & 0xFF;
+}
+
+size_t W5500::tx_size(const Socket& s) {
+    return size_t(s.reg[Sn_TXBUF_SIZE]) * 1024;
+}
+
+size_t W5500::rx_size(const Socket& s) {
+    return size_t(s.reg[Sn_RXBUF_SIZE]) * 1024;
+}
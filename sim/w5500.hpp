@@ -0,0 +1,127 @@
+#ifndef PROJECT_SIM_W5500_HPP
+#define PROJECT_SIM_W5500_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace Project::sim {
+    class W5500;
+}
+
+/// Register-level W5500 model for running the networking code on a PC.
+/// It answers the SPI frame protocol byte by byte: the 16-bit offset, the control byte with
+/// block select, read/write and variable or fixed length mode, then the data phase with an
+/// auto-incrementing offset. Behind it are the common registers, the 8 socket register blocks
+/// and the socket TX/RX buffer memories, with the same pointer arithmetic and wrap-around as
+/// the chip, so the io library and the drivers run against it unchanged.
+///
+/// Socket traffic is bridged to host sockets on loopback. A TCP socket listening on port p
+/// accepts connections on host port p + port_offset, CONNECT and UDP SEND go to the host
+/// address whatever the destination IP is. Data leaves the TX memory only as fast as the
+/// host socket takes it, so Sn_TX_FSR and SENDOK behave like on a real link.
+class Project::sim::W5500 {
+public:
+    static constexpr size_t n_sockets = 8;
+    static constexpr size_t max_buffer = 16 * 1024;
+
+    struct Config {
+        uint16_t port_offset = 0;          ///< e.g. 8000 to serve port 80 without privileges
+        const char* host = "127.0.0.1";    ///< peer of CONNECT and UDP SEND
+        bool auto_poll = true;             ///< poll() at every chip select
+    };
+
+    struct Stats {
+        uint64_t frames;       ///< SPI frames, one per chip select
+        uint64_t spi_bytes;    ///< bytes clocked on the bus, including address and control
+        uint64_t tx_bytes;     ///< bytes sent to host sockets
+        uint64_t rx_bytes;     ///< bytes received from host sockets
+        uint64_t connections;  ///< connections accepted or established
+    };
+
+    explicit W5500(Config config);
+    ~W5500();
+
+    W5500(const W5500&) = delete;
+    W5500& operator=(const W5500&) = delete;
+
+    /// chip select low, starts a frame
+    void select();
+
+    /// chip select high, ends the frame
+    void deselect();
+
+    /// clock one byte
+    /// @return the byte on MISO
+    uint8_t transfer(uint8_t mosi);
+
+    /// clock len bytes, tx or rx may be null
+    void transfer(const uint8_t* tx, uint8_t* rx, size_t len);
+
+    /// pulse the RESET pin: every register back to its reset value and every host socket closed
+    void reset();
+
+    /// move data between the host sockets and the buffer memories and raise the socket
+    /// interrupts, without blocking
+    void poll();
+
+    /// INT pin asserted, i.e. low on the chip
+    bool interrupt() const;
+
+    const Stats& stats() const { return statistics; }
+
+private:
+    struct Socket {
+        uint8_t reg[0x30];
+        uint8_t tx[max_buffer];
+        uint8_t rx[max_buffer];
+        int fd;
+        uint16_t send_end;  ///< TX pointer the pending SEND runs to
+        bool sending;
+    };
+
+    enum class Phase { Address0, Address1, Control, Data, Done };
+
+    uint8_t read(uint8_t block, uint16_t offset);
+    void write(uint8_t block, uint16_t offset, uint8_t value);
+    uint8_t read_socket(Socket& s, uint16_t offset);
+    void write_socket(Socket& s, uint16_t offset, uint8_t value);
+    void command(Socket& s, uint8_t cr);
+
+    void open(Socket& s);
+    void listen(Socket& s);
+    void connect(Socket& s);
+    void disconnect(Socket& s);
+    void close(Socket& s);
+    void send(Socket& s);
+
+    void flush(Socket& s);
+    void receive(Socket& s);
+    void receive_udp(Socket& s);
+    void accept(Socket& s, int listener);
+    void connected(Socket& s);
+    void closed(Socket& s, uint8_t ir);
+    int listener(uint16_t port);
+
+    static uint16_t get16(const uint8_t* reg, uint16_t offset);
+    static void set16(uint8_t* reg, uint16_t offset, uint16_t value);
+    static size_t tx_size(const Socket& s);
+    static size_t rx_size(const Socket& s);
+
+    uint16_t port_offset;
+    const char* host;
+    bool auto_poll;
+
+    uint8_t common[0x40] = {};
+    Socket sockets[n_sockets] = {};
+    std::map<uint16_t, int> listeners;   ///< host listening socket per W5500 port
+
+    Phase phase = Phase::Done;
+    uint16_t offset = 0;
+    uint8_t block = 0;
+    bool writing = false;
+    size_t remaining = 0;   ///< data bytes left in a fixed length frame, 0 for variable length
+    Stats statistics = {};
+};
+
+#endif // PROJECT_SIM_W5500_HPP
@@ -0,0 +1,465 @@
+// The WizchipSPI bus layer of the firmware against the W5500 model. Its polled transfers go
+// through host stand-ins of the HAL SPI calls, and its DMA transactions are played by a thread
+// that moves the bytes between memory and the model and raises the RX channel interrupt, the
+// way SPI1 and DMA1 channels 2 and 3 do. Accesses are issued like the io library issues them,
+// an address burst and then the data under one chip select, so the address segment that is
+// held back and re-armed from the interrupt runs as on the target.
+//
+// Socket TX memory is written and read back at every length around the DMA threshold and the
+// merge size, through both paths, and compared. Then a DMA error and a stalled transfer are
+// injected halfway through the data, which the bus layer has to redo polled. The summary counts
+// the bus bytes the CPU clocks itself and the ones left to DMA, and what they would cost in CPU
+// time at 18 MHz SCK, the fastest SPI1 runs from a 72 MHz APB2.
+//
+// Last, a host client has 1 KB echoed by a socket loop on the model, once with every transfer
+// polled as before the DMA path and once with it. The host can't time the target, so the echo
+// rate is the payload over the time the bus layer takes on the target, from the bytes and
+// transfers counted and the costs below; the network is not part of it.
+//
+//   wizchip_dma [rounds] [echo requests]
+
+#include "w5500.hpp"
+#include "drivers/wizchip_spi.hpp"
+#include "wizchip_conf.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace Project;
+
+static constexpr double sck = 18e6;
+static constexpr double cpu = 72e6;
+// the HAL loops keep up with SCK when only transmitting, and take about 50 cycles a byte when
+// they receive as well; a polled call costs about 100 cycles of setup, a DMA transaction about
+// 600, for arming the channels twice, the interrupt of the address segment and blocking and
+// waking the task
+static constexpr double polled_rx_cycles = 50;
+static constexpr double polled_call_cycles = 100;
+static constexpr double dma_transaction_cycles = 600;
+static constexpr uint16_t tx_memory = 2048;
+static constexpr uint8_t tx_block = 0x02;  ///< socket 0 TX memory
+static constexpr uint16_t versionr = 0x0039;
+
+static constexpr uint16_t echo_port = 5002;
+static constexpr uint16_t port_offset = 10000;
+
+static sim::W5500 chip({.port_offset=port_offset, .auto_poll=false});
+
+static SPI_TypeDef spi1;
+static DMA_TypeDef dma1;
+static DMA_Channel_TypeDef rx_channel, tx_channel;
+static DMA_HandleTypeDef hdma_rx = {&rx_channel, &dma1, 4, nullptr, nullptr, nullptr, nullptr};
+static DMA_HandleTypeDef hdma_tx = {&tx_channel, &dma1, 8, nullptr, nullptr, nullptr, nullptr};
+static SPI_HandleTypeDef hspi1 = {&spi1, &hdma_tx, &hdma_rx};
+static GPIO_TypeDef gpioa;
+
+static drivers::WizchipSPI bus({
+    .hspi=hspi1,
+    .cs_port=&gpioa,
+    .cs_pin=1u << 4,
+    .timeout=pdMS_TO_TICKS(100),
+});
+
+/// the bus layer with the DMA path out of reach, for the echo before it
+static drivers::WizchipSPI polled_bus({
+    .hspi=hspi1,
+    .cs_port=&gpioa,
+    .cs_pin=1u << 4,
+    .dma_threshold=SIZE_MAX,
+});
+
+enum class Fault { None, Error, Stall };
+
+static std::atomic<bool> running{true};
+static std::atomic<Fault> fault{Fault::None};  ///< for the next data segment, after half of it
+static std::atomic<uint64_t> polled_bytes{0};
+static std::atomic<uint64_t> polled_rx_bytes{0};
+static std::atomic<uint64_t> polled_calls{0};
+static std::atomic<uint64_t> dma_bytes{0};
+static size_t accesses = 0;
+static std::atomic<uint32_t> mismatched{0};  ///< transactions whose channels disagree on the length
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef*, uint8_t* data, uint16_t size, uint32_t) {
+    chip.transfer(data, nullptr, size);
+    polled_bytes += size;
+    polled_calls++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef*, uint8_t* data, uint16_t size, uint32_t) {
+    chip.transfer(nullptr, data, size);
+    polled_bytes += size;
+    polled_rx_bytes += size;
+    polled_calls++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef*, uint8_t* tx, uint8_t* rx, uint16_t size, uint32_t) {
+    chip.transfer(tx, rx, size);
+    polled_bytes += size;
+    polled_rx_bytes += size;
+    polled_calls++;
+    return HAL_OK;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef*, uint16_t, GPIO_PinState state) {
+    if (state == GPIO_PIN_RESET) {
+        chip.select();
+    } else {
+        chip.deselect();
+    }
+}
+
+/// callbacks the bus layer registers, what the io library keeps in WIZCHIP
+static struct {
+    void (*enter)();
+    void (*exit)();
+    void (*select)();
+    void (*deselect)();
+    uint8_t (*read_byte)();
+    void (*write_byte)(uint8_t);
+    void (*read_burst)(uint8_t*, uint16_t);
+    void (*write_burst)(uint8_t*, uint16_t);
+} io;
+
+void reg_wizchip_cris_cbfunc(void (*enter)(void), void (*exit)(void)) {
+    io.enter = enter;
+    io.exit = exit;
+}
+
+void reg_wizchip_cs_cbfunc(void (*select)(void), void (*deselect)(void)) {
+    io.select = select;
+    io.deselect = deselect;
+}
+
+void reg_wizchip_spi_cbfunc(uint8_t (*read_byte)(void), void (*write_byte)(uint8_t)) {
+    io.read_byte = read_byte;
+    io.write_byte = write_byte;
+}
+
+void reg_wizchip_spiburst_cbfunc(void (*read_burst)(uint8_t*, uint16_t), void (*write_burst)(uint8_t*, uint16_t)) {
+    io.read_burst = read_burst;
+    io.write_burst = write_burst;
+}
+
+static void address_phase(uint8_t block, uint16_t offset, bool write) {
+    uint8_t head[3] = {uint8_t(offset >> 8), uint8_t(offset), uint8_t(block << 3 | (write ? 0x04 : 0))};
+    io.write_burst(head, 3);
+}
+
+/// WIZCHIP_WRITE_BUF and WIZCHIP_READ_BUF of the io library
+static void access(uint8_t block, uint16_t offset, uint8_t* buf, uint16_t len, bool write) {
+    accesses++;
+    io.enter();
+    io.select();
+    address_phase(block, offset, write);
+    if (write) {
+        io.write_burst(buf, len);
+    } else {
+        io.read_burst(buf, len);
+    }
+    io.deselect();
+    io.exit();
+}
+
+/// WIZCHIP_READ of the io library
+static uint8_t read_register(uint8_t block, uint16_t offset) {
+    accesses++;
+    io.enter();
+    io.select();
+    address_phase(block, offset, false);
+    uint8_t value = io.read_byte();
+    io.deselect();
+    io.exit();
+    return value;
+}
+
+/// SPI1 and its DMA channels: a transaction starts once both channels and both SPI DMA
+/// requests are enabled, and the RX channel interrupt is raised from here
+static void dma_engine() {
+    constexpr uint32_t requests = SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+    while (running) {
+        if ((spi1.CR2 & requests) != requests or not (rx_channel.CCR & DMA_CCR_EN) or
+            not (tx_channel.CCR & DMA_CCR_EN) or rx_channel.CNDTR == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        size_t len = rx_channel.CNDTR;
+        if (tx_channel.CNDTR != len) {
+            mismatched++;
+        }
+        // the address segment always goes through, a fault hits the data after it
+        auto injected = len > drivers::WizchipSPI::address_size ? fault.exchange(Fault::None) : Fault::None;
+        size_t n = injected == Fault::None ? len : len / 2;
+
+        // the addresses fit 32 bits, see main
+        auto tx = reinterpret_cast<const uint8_t*>(uintptr_t(tx_channel.CMAR));
+        auto rx = reinterpret_cast<uint8_t*>(uintptr_t(rx_channel.CMAR));
+        bool tx_increment = tx_channel.CCR & DMA_CCR_MINC;
+        bool rx_increment = rx_channel.CCR & DMA_CCR_MINC;
+        for (size_t i = 0; i < n; ++i) {
+            *rx = chip.transfer(*tx);
+            tx += tx_increment;
+            rx += rx_increment;
+        }
+        dma_bytes += n;
+
+        if (injected == Fault::Stall) {
+            // no interrupt comes, the task times out and takes the channels back
+            while (rx_channel.CCR & DMA_CCR_EN) {
+                std::this_thread::yield();
+            }
+            continue;
+        }
+        tx_channel.CNDTR = 0;
+        rx_channel.CNDTR = 0;
+
+        bool failed = injected == Fault::Error;
+        if (failed and (rx_channel.CCR & DMA_CCR_TEIE) and hdma_rx.XferErrorCallback) {
+            hdma_rx.XferErrorCallback(&hdma_rx);
+        } else if (not failed and (rx_channel.CCR & DMA_CCR_TCIE) and hdma_rx.XferCpltCallback) {
+            hdma_rx.XferCpltCallback(&hdma_rx);
+        }
+    }
+}
+
+static uint8_t pattern[tx_memory];
+static uint8_t readback[tx_memory];
+
+/// write len bytes at offset, read them back in one access and in pieces of the given size
+/// @return number of wrong bytes
+static size_t round_trip(uint16_t offset, uint16_t len, uint16_t piece, uint8_t seed) {
+    for (uint16_t i = 0; i < len; ++i) {
+        pattern[i] = uint8_t(seed + i * 7);
+    }
+    access(tx_block, offset, pattern, len, true);
+
+    size_t wrong = 0;
+    ::memset(readback, 0xEE, len);
+    access(tx_block, offset, readback, len, false);
+    for (uint16_t i = 0; i < len; ++i) {
+        wrong += readback[i] != pattern[i];
+    }
+
+    ::memset(readback, 0xEE, len);
+    for (uint16_t i = 0; i < len; i += piece) {
+        uint16_t n = len - i < piece ? len - i : piece;
+        access(tx_block, uint16_t(offset + i), readback + i, n, false);
+    }
+    for (uint16_t i = 0; i < len; ++i) {
+        wrong += readback[i] != pattern[i];
+    }
+    return wrong;
+}
+
+/// socket 0 registers, through the bus layer like the io library reaches them
+static uint16_t reg16(uint16_t offset) {
+    uint8_t value[2];
+    access(0x01, offset, value, 2, false);
+    return uint16_t(value[0] << 8 | value[1]);
+}
+
+static void set_reg(uint16_t offset, uint8_t value) {
+    access(0x01, offset, &value, 1, true);
+}
+
+static void set_reg16(uint16_t offset, uint16_t value) {
+    uint8_t data[2] = {uint8_t(value >> 8), uint8_t(value)};
+    access(0x01, offset, data, 2, true);
+}
+
+/// one pass of the socket loop of the loopback program, on socket 0
+static void echo_step(uint8_t* buf, size_t size) {
+    chip.poll();
+    switch (read_register(0x01, 0x03)) {
+        case 0x00:  // CLOSED
+            set_reg(0x00, 0x01);
+            set_reg16(0x04, echo_port);
+            set_reg(0x01, 0x01);
+            return;
+        case 0x13:  // INIT
+            set_reg(0x01, 0x02);
+            return;
+        case 0x1C:  // CLOSE_WAIT
+            set_reg(0x01, 0x08);
+            return;
+        case 0x17:  // ESTABLISHED
+            break;
+        default:
+            return;
+    }
+
+    uint16_t len = std::min<uint16_t>(reg16(0x26), uint16_t(size));
+    if (len == 0) {
+        return;
+    }
+    uint16_t rd = reg16(0x28);
+    access(0x03, rd, buf, len, false);
+    set_reg16(0x28, rd + len);
+    set_reg(0x01, 0x40);
+
+    while (reg16(0x20) < len) {
+        chip.poll();
+    }
+    uint16_t wr = reg16(0x24);
+    access(0x02, wr, buf, len, true);
+    set_reg16(0x24, wr + len);
+    set_reg(0x01, 0x20);
+}
+
+/// @return false if the echo came back wrong or not at all
+static bool echo_client(int requests, size_t payload) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = ::inet_addr("127.0.0.1");
+    addr.sin_port = htons(echo_port + port_offset);
+    while (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    bool ok = true;
+    std::vector<uint8_t> out(payload), in(payload);
+    for (int i = 0; i < requests and ok; ++i) {
+        for (size_t j = 0; j < payload; ++j) {
+            out[j] = uint8_t(i + j * 13);
+        }
+        ::send(fd, out.data(), payload, 0);
+        for (size_t got = 0; got < payload and ok;) {
+            auto n = ::recv(fd, in.data() + got, payload - got, 0);
+            ok = n > 0;
+            got += ok ? size_t(n) : 0;
+        }
+        ok = ok and in == out;
+    }
+    ::close(fd);
+    return ok;
+}
+
+struct Echo {
+    bool ok;
+    double us;      ///< bus layer time on the target
+    double cpu_us;  ///< of which the CPU is busy
+};
+
+/// echo requests of payload bytes through the bus layer that the io library callbacks point at
+static Echo echo(int requests, size_t payload) {
+    uint64_t calls = polled_calls, bytes = polled_bytes, rx_bytes = polled_rx_bytes, dma = dma_bytes;
+    uint32_t transactions = bus.stats().dma;
+
+    std::atomic<bool> done{false};
+    bool ok = false;
+    std::thread client([&] {
+        ok = echo_client(requests, payload);
+        done = true;
+    });
+    static uint8_t buf[2048];
+    while (not done) {
+        echo_step(buf, sizeof(buf));
+    }
+    client.join();
+    // the connection is closed by the client, the next echo starts from a closed socket
+    while (read_register(0x01, 0x03) != 0x00) {
+        echo_step(buf, sizeof(buf));
+    }
+
+    calls = polled_calls - calls;
+    bytes = polled_bytes - bytes;
+    rx_bytes = polled_rx_bytes - rx_bytes;
+    dma = dma_bytes - dma;
+    transactions = bus.stats().dma - transactions;
+
+    double byte_us = 8 / sck * 1e6;
+    double rx_byte_us = std::max(byte_us, polled_rx_cycles / cpu * 1e6);
+    double cpu_us = calls * polled_call_cycles / cpu * 1e6 + (bytes - rx_bytes) * byte_us + rx_bytes * rx_byte_us +
+        transactions * dma_transaction_cycles / cpu * 1e6;
+    return {ok, cpu_us + dma * byte_us, cpu_us};
+}
+
+int main(int argc, char** argv) {
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 20;
+    int echo_requests = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    // CMAR holds 32 bits like on the target, buffers must lie below 4 GB, i.e. a non-PIE build
+    if (uintptr_t(&pattern[tx_memory - 1]) > UINT32_MAX or uintptr_t(&bus) > UINT32_MAX) {
+        std::printf("DMA buffers above 4 GB, build without PIE\n");
+        return 1;
+    }
+
+    bus.init();
+    std::thread engine(dma_engine);
+
+    size_t wrong = 0;
+    int bad_version = 0;
+    constexpr uint16_t lengths[] = {512, 1024, 2048};
+    for (int r = 0; r < rounds; ++r) {
+        // offsets near the end of the memory wrap around within a transfer
+        uint16_t offset = uint16_t(r * 197 % tx_memory);
+        for (uint16_t len = 1; len <= 2 * drivers::WizchipSPI::merge_size + 8; ++len) {
+            wrong += round_trip(offset, len, 1 + len % 40, uint8_t(r + len));
+        }
+        for (auto len : lengths) {
+            wrong += round_trip(offset, len, 100, uint8_t(r));
+        }
+        // a register read merges the address with the data in one polled transfer
+        bad_version += read_register(0x00, versionr) != 0x04;
+    }
+
+    // a DMA error in the write and a stall in the read, each halfway through the data: the
+    // transfer is redone polled and the data comes out right
+    auto errors = bus.stats().errors;
+    fault = Fault::Error;
+    wrong += round_trip(100, 256, 256, 1);
+    for (uint16_t i = 0; i < 256; ++i) {
+        pattern[i] = uint8_t(3 + i * 5);
+    }
+    access(tx_block, 300, pattern, 256, true);
+    fault = Fault::Stall;
+    ::memset(readback, 0xEE, 256);
+    access(tx_block, 300, readback, 256, false);
+    wrong += ::memcmp(readback, pattern, 256) != 0;
+    bool faults_redone = bus.stats().errors == errors + 2;
+
+    // every access is one transfer, a failed DMA transfer ends up polled
+    auto& stats = bus.stats();
+    bool counted = stats.dma + stats.polled == accesses;
+    uint64_t cpu_bytes = polled_bytes, dma = dma_bytes;
+    std::printf("%zu accesses in %d rounds: %u by DMA, %u polled, %u DMA errors redone polled\n",
+        accesses, rounds, unsigned(stats.dma), unsigned(stats.polled), unsigned(stats.errors));
+    std::printf("bus bytes   %llu clocked by the CPU, %llu by DMA (%.1f%%)\n",
+        (unsigned long long) cpu_bytes, (unsigned long long) dma, 100.0 * dma / (cpu_bytes + dma));
+    std::printf("cpu time    %.1f ms spinning at 18 MHz, %.1f ms if every transfer were polled\n",
+        cpu_bytes * 8 / sck * 1e3, (cpu_bytes + dma) * 8 / sck * 1e3);
+    std::printf("checks      %zu wrong bytes, %d bad version reads, %u length mismatches, faults %s, accesses %s\n",
+        wrong, bad_version, unsigned(mismatched), faults_redone ? "redone" : "NOT redone", counted ? "add up" : "DON'T add up");
+
+    constexpr size_t payload = 1024;
+    polled_bus.init();
+    auto before = echo(echo_requests, payload);
+    bus.init();
+    auto after = echo(echo_requests, payload);
+    double kb = 2.0 * echo_requests * payload / 1024;
+    std::printf("echo        %d x %zu bytes, bus layer on the target:\n", echo_requests, payload);
+    std::printf("  polled    %6.0f KB/s, CPU busy %5.1f us per KB%s\n",
+        kb / before.us * 1e6, before.cpu_us / kb, before.ok ? "" : ", WRONG ECHO");
+    std::printf("  dma       %6.0f KB/s, CPU busy %5.1f us per KB%s\n",
+        kb / after.us * 1e6, after.cpu_us / kb, after.ok ? "" : ", WRONG ECHO");
+
+    running = false;
+    engine.join();
+
+    return wrong == 0 and bad_version == 0 and mismatched == 0 and faults_redone and counted and before.ok and after.ok ? 0 : 1;
+}
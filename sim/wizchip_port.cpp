@@ -0,0 +1,18 @@
+// Connects the wizchip io library to the W5500 model instead of hspi1, so socket.c and the
+// code built on it run on a PC unchanged. Built when the io library sources are available.
+
+#include "wizchip_port.hpp"
+#include "wizchip_conf.h"
+
+using namespace Project::sim;
+
+static W5500* chip = nullptr;
+
+void Project::sim::attach(W5500& w5500) {
+    chip = &w5500;
+    reg_wizchip_cs_cbfunc([] { chip->select(); }, [] { chip->deselect(); });
+    reg_wizchip_spi_cbfunc([] { return chip->transfer(0); }, [](uint8_t byte) { chip->transfer(byte); });
+    reg_wizchip_spiburst_cbfunc(
+        [](uint8_t* buf, uint16_t len) { chip->transfer(nullptr, buf, len); },
+        [](uint8_t* buf, uint16_t len) { chip->transfer(buf, nullptr, len); });
+}
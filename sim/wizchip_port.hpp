@@ -0,0 +1,12 @@
+#ifndef PROJECT_SIM_WIZCHIP_PORT_HPP
+#define PROJECT_SIM_WIZCHIP_PORT_HPP
+
+#include "w5500.hpp"
+
+namespace Project::sim {
+    /// register the model as the SPI bus and chip select of the wizchip io library
+    /// @note the model must outlive every io library call
+    void attach(W5500& w5500);
+}
+
+#endif // PROJECT_SIM_WIZCHIP_PORT_HPP